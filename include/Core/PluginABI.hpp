@@ -0,0 +1,220 @@
+/*
+** PluginABI - Entry points exported by primitive plugins
+**
+** Version 1 plugins export getType() and createPrimitive(), which returns
+** one heap object per call. Version 2 plugins also export the symbols
+** below, so the factory can build many primitives in one call straight
+** into storage it owns. A plugin without getAbiVersion() is version 1.
+**
+** Version 2 plugins may also declare capabilities through getCapabilities()
+** and export the matching kernels: bounds put their primitives in the
+** scene BVH instead of the list tested by every ray, and batch
+** intersection lets the renderer hand them many rays at once.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include "Core/PrimitiveConfig.hpp"
+#include "RayTracer/HitInfo.hpp"
+#include "RayTracer/IPrimitive.hpp"
+#include "RayTracer/Ray.hpp"
+
+namespace Core::PluginABI {
+    constexpr unsigned Version = 2;
+
+    /**
+     * @brief Memory one primitive of the plugin needs in caller storage
+     */
+    struct Layout {
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    // extern "C" symbols, by name
+    using GetTypeFn = const char*();                                            // "getType", v1
+    using CreatePrimitiveFn = RayTracer::IPrimitive*(const PrimitiveConfig&);   // "createPrimitive", v1
+    using GetAbiVersionFn = unsigned();                                         // "getAbiVersion", v2
+    using GetLayoutFn = Layout();                                               // "getPrimitiveLayout", v2
+    using GetCapabilitiesFn = unsigned();                                       // "getCapabilities", v2, optional
+
+    /**
+     * @brief Flags returned by getCapabilities(), each requiring its symbol
+     */
+    enum Capability : unsigned {
+        Bounds = 1u << 0,           // "primitiveBounds"
+        IntersectBatch = 1u << 1    // "intersectBatch"
+    };
+
+    /**
+     * @brief "primitiveBounds": world-space box of one of the plugin's primitives
+     * @return false if the primitive is unbounded, like a plane
+     */
+    using BoundsFn = bool(const RayTracer::IPrimitive& primitive, double min[3], double max[3]);
+
+    /**
+     * @brief "intersectBatch": closest hits of n rays against count primitives
+     *
+     * All primitives are the plugin's own. hits[r] is only overwritten by
+     * a hit closer than hits[r].t, which the caller sets to the farthest
+     * distance of interest, so a batch can continue an earlier one.
+     */
+    using IntersectBatchFn = void(
+        const RayTracer::IPrimitive* const* primitives,
+        std::size_t count,
+        const RayTracer::Ray* rays,
+        std::size_t n,
+        HitInfo* hits);
+
+    /**
+     * @brief Kernels a plugin declared, null when absent
+     */
+    struct Kernels {
+        BoundsFn* bounds = nullptr;
+        IntersectBatchFn* intersectBatch = nullptr;
+    };
+
+    /**
+     * @brief "createPrimitives", v2
+     *
+     * Constructs count primitives, primitive i at storage + i * size from
+     * getPrimitiveLayout(), and stores their interface pointers in out.
+     * The caller destroys them in place through the virtual destructor.
+     * If a configuration is rejected, the primitives already built are
+     * destroyed before the exception propagates.
+     * @return Number of primitives built, count on success
+     */
+    using CreatePrimitivesFn = std::size_t(
+        const PrimitiveConfig* const* configs,
+        std::size_t count,
+        void* storage,
+        RayTracer::IPrimitive** out);
+
+    /**
+     * @brief Layout of primitive type T, for getPrimitiveLayout()
+     */
+    template <typename T>
+    constexpr Layout layoutOf()
+    {
+        return {sizeof(T), alignof(T)};
+    }
+
+    /**
+     * @brief Implements createPrimitives() for primitive type T
+     * @param make Callable constructing a T at the given storage from a configuration
+     */
+    template <typename T, typename Make>
+    std::size_t constructBatch(
+        const PrimitiveConfig* const* configs,
+        std::size_t count,
+        void* storage,
+        RayTracer::IPrimitive** out,
+        Make make)
+    {
+        T* objects = static_cast<T*>(storage);
+        std::size_t built = 0;
+        try {
+            for (; built < count; ++built)
+                out[built] = make(static_cast<void*>(objects + built), *configs[built]);
+        } catch (...) {
+            while (built > 0)
+                objects[--built].~T();
+            throw;
+        }
+        return built;
+    }
+
+    /**
+     * @brief Implements intersectBatch() with T's own hits(), called without virtual dispatch
+     */
+    template <typename T>
+    void intersectEach(
+        const RayTracer::IPrimitive* const* primitives,
+        std::size_t count,
+        const RayTracer::Ray* rays,
+        std::size_t n,
+        HitInfo* hits)
+    {
+        for (std::size_t r = 0; r < n; ++r) {
+            for (std::size_t i = 0; i < count; ++i) {
+                HitInfo hit;
+                if (static_cast<const T*>(primitives[i])->T::hits(rays[r], hit) && hit.t < hits[r].t)
+                    hits[r] = hit;
+            }
+        }
+    }
+
+    /**
+     * @brief Implements intersectBatch() from a distance-only test
+     *
+     * distance(primitive, ray) returns the t hits() would report, or
+     * infinity; only the closest primitive of each ray runs hits() to
+     * fill in the hit.
+     */
+    template <typename T, typename Distance>
+    void intersectClosest(
+        const RayTracer::IPrimitive* const* primitives,
+        std::size_t count,
+        const RayTracer::Ray* rays,
+        std::size_t n,
+        HitInfo* hits,
+        Distance distance)
+    {
+        for (std::size_t r = 0; r < n; ++r) {
+            const T* closest = nullptr;
+            double t = hits[r].t;
+            for (std::size_t i = 0; i < count; ++i) {
+                const T* primitive = static_cast<const T*>(primitives[i]);
+                double d = distance(*primitive, rays[r]);
+                if (d < t) {
+                    t = d;
+                    closest = primitive;
+                }
+            }
+            HitInfo hit;
+            if (closest && closest->T::hits(rays[r], hit))
+                hits[r] = hit;
+        }
+    }
+
+    /**
+     * @brief Grows min and max to contain p
+     */
+    inline void expand(double min[3], double max[3], const Math::Point3D& p)
+    {
+        const double xyz[3] = {p._x, p._y, p._z};
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = std::min(min[axis], xyz[axis]);
+            max[axis] = std::max(max[axis], xyz[axis]);
+        }
+    }
+
+    /**
+     * @brief Grows min and max to contain a disc of the given radius and unit normal
+     */
+    inline void expandDisc(double min[3], double max[3], const Math::Point3D& center,
+                           const Math::Vector3D& normal, double radius)
+    {
+        const double c[3] = {center._x, center._y, center._z};
+        const double n[3] = {normal._x, normal._y, normal._z};
+        for (int axis = 0; axis < 3; ++axis) {
+            double extent = radius * std::sqrt(std::max(0.0, 1.0 - n[axis] * n[axis]));
+            min[axis] = std::min(min[axis], c[axis] - extent);
+            max[axis] = std::max(max[axis], c[axis] + extent);
+        }
+    }
+
+    /**
+     * @brief Empty box, ready for expand()
+     */
+    inline void resetBounds(double min[3], double max[3])
+    {
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = std::numeric_limits<double>::infinity();
+            max[axis] = -std::numeric_limits<double>::infinity();
+        }
+    }
+}
@@ -9,10 +9,14 @@
 #include <functional>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <cstdint>
 
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
 #include "Core/PrimitiveFactoryExceptions.hpp"
+#include "Core/PluginABI.hpp"
+#include "Utils/Arena.hpp"
 #include <filesystem>
 #include <dlfcn.h>
 #include <iostream>
@@ -30,16 +34,55 @@ namespace Core {
             ~PrimitiveFactory();
 
             /**
-             * @brief Loads primitive plugins from a directory
+             * @brief Indexes the primitive plugins of a directory
+             *
+             * A plugin is only opened when a primitive of its type is
+             * first created, so the scene pays for the types it uses.
+             * The type each .so provides is cached in a manifest in the
+             * directory; only new or changed files are opened to read it.
+             * A file that cannot be read is skipped with a warning, and
+             * only fails the scenes using its type.
+             * Both plugin ABI versions are accepted, see PluginABI.
              * @param pluginsDir Directory containing the .so plugin files
-             * @throws PluginLoadException if a plugin fails to load
+             * @throws PluginLoadException if pluginsDir is not a directory
              */
             void loadPlugins(const std::string& pluginsDir);
 
+            /**
+             * @brief What reloadPlugins() reopened
+             */
+            struct PluginReload {
+                std::vector<std::string> types;     // reopened, their primitives must be created again
+                std::vector<std::string> failures;  // changed plugins that failed to open, left as they were
+            };
+
+            /**
+             * @brief Re-creates the primitives of the reopened types, see reloadPlugins()
+             */
+            using RecreateFn = std::function<void(const PluginReload&)>;
+
+            /**
+             * @brief Reopens the loaded plugins whose file changed, and indexes the directories again
+             *
+             * A changed plugin is opened from a private copy, since the
+             * loader would hand back the already loaded image of its path.
+             * The new plugins are only kept if recreate, called with them in
+             * place when some type was reopened, returns: if it throws, the
+             * previous plugins are put back and the exception propagates,
+             * so primitives and kernels of a type always come from the same
+             * image. Replaced images stay mapped until the factory goes away,
+             * as primitives they created may still be alive. Plugins not
+             * loaded yet simply open the new file on first use.
+             * Must not run while primitives are being created, except by recreate.
+             */
+            PluginReload reloadPlugins(const RecreateFn& recreate = {});
+
             /**
              * @brief Registers a new primitive type with its creation function
              * @param name Name/type identifier for the primitive
              * @param fn Function to create instances of this primitive
+             *
+             * Takes precedence over a plugin providing the same type.
              */
             void registerType(const std::string& name, CreateFn fn);
 
@@ -49,11 +92,60 @@ namespace Core {
              * @param cfg Configuration with primitive-specific data
              * @return Shared pointer to the created primitive
              * @throws UnknownPrimitiveTypeException if type is not registered
+             * @throws PluginLoadException if the plugin of type fails to load
              */
             std::shared_ptr<RayTracer::IPrimitive> create(
                 const std::string& type,
                 const PrimitiveConfig& cfg) const;
 
+            /**
+             * @brief Creates a primitive owned by an arena
+             *
+             * Plugin primitives are adopted by the arena, so the handle
+             * carries no control block of its own; types registered with
+             * registerType() keep the ownership their function gives them.
+             * @param arena Arena the primitive lives and dies with
+             * @return Non-owning handle sharing the arena's lifetime
+             * @throws UnknownPrimitiveTypeException if type is not registered
+             * @throws PluginLoadException if the plugin of type fails to load
+             */
+            std::shared_ptr<RayTracer::IPrimitive> create(
+                const std::string& type,
+                const PrimitiveConfig& cfg,
+                const std::shared_ptr<Utils::Arena>& arena) const;
+
+            /**
+             * @brief Creates primitives of one type in an arena
+             *
+             * Version 2 plugins build the whole batch in one call, into a
+             * single contiguous block of the arena; other types are
+             * created one by one.
+             * @param configs count configurations, all of the given type
+             * @param out Receives count non-owning handles sharing the arena's lifetime
+             * @throws UnknownPrimitiveTypeException if type is not registered
+             * @throws PluginLoadException if the plugin of type fails to load
+             */
+            void create(
+                const std::string& type,
+                const PrimitiveConfig* const* configs,
+                std::size_t count,
+                const std::shared_ptr<Utils::Arena>& arena,
+                std::shared_ptr<RayTracer::IPrimitive>* out) const;
+
+            /**
+             * @brief Bounds and batch intersection kernels of a plugin type
+             * @return The kernels the plugin declared, or null if it has none
+             * @throws PluginLoadException if the plugin of type fails to load
+             */
+            const PluginABI::Kernels* kernels(const std::string& type) const;
+
+            /**
+             * @brief Number of plugins opened so far
+             */
+            std::size_t loadedPluginCount() const;
+
+            static constexpr const char* ManifestName = ".manifest";   // in the plugins directory
+
             /**
              * @brief Creates a sphere primitive
              * @param center Center point of the sphere
@@ -111,8 +203,36 @@ namespace Core {
                 const Color& color);
 
         private:
-            struct PluginHandle { void* handle; };
-            std::vector<PluginHandle> _handles;
+            /**
+             * @brief Entry points of a loaded plugin
+             */
+            struct Plugin {
+                void* handle = nullptr;
+                uint64_t signature = 0;     // Utils::fileSignature() of the file when opened
+                PluginABI::CreatePrimitiveFn* create = nullptr;         // version 1, may be absent in version 2
+                PluginABI::CreatePrimitivesFn* createBatch = nullptr;   // version 2
+                PluginABI::Layout layout{0, 0};
+                PluginABI::Kernels kernels;
+            };
+
+            /**
+             * @brief Opens the plugin of an indexed type on first use
+             * @return The plugin, or null if no indexed plugin provides type
+             */
+            const Plugin* plugin(const std::string& type) const;
+
+            void index(const std::string& pluginsDir);
+            static Plugin open(const std::string& path, const std::string& type, bool privateCopy = false);
+            static std::shared_ptr<RayTracer::IPrimitive> createOwned(
+                const Plugin& plugin,
+                const PrimitiveConfig& cfg);
+
             std::map<std::string, CreateFn> _creators;
+            std::vector<std::string> _dirs;                 // indexed directories
+            mutable std::mutex _mutex;                      // guards the members below
+            std::map<std::string, std::string> _index;      // plugin type -> .so path
+            mutable std::map<std::string, Plugin> _plugins; // opened plugins
+            mutable std::map<std::string, PluginLoadException> _failed;
+            std::vector<void*> _retired;                    // images replaced by reloadPlugins()
     };
 }
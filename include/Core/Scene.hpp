@@ -10,11 +10,19 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <cstdint>
 #include "RayTracer/Camera.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "RayTracer/ILight.hpp"
+#include "RayTracer/MeshCache.hpp"
+#include "RayTracer/PrimitiveBVH.hpp"
 #include "Core/PrimitiveFactory.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Utils/Arena.hpp"
+
+namespace Parser {
+    struct ObjFile;
+}
 
 /**
  * @brief Central container and manager for all scene elements
@@ -24,17 +32,256 @@ class Scene {
         Scene(Core::PrimitiveFactory& fac);
         ~Scene();
 
+        /**
+         * @brief Wall time of the phases of the last loadFromFile(), in seconds
+         */
+        struct LoadTimings {
+            double parse = 0;   // libconfig and the Parser
+            double build = 0;   // everything after parsing, primitives and meshes built concurrently
+            double obj = 0;     // obj_files bounds scans and meshes loaded up front, summed over tasks
+            double accel = 0;   // scene BVH, plus BVH builds of the meshes loaded up front summed over tasks
+        };
+
         void loadFromFile(const std::string& path);
 
+        const LoadTimings& loadTimings() const { return _loadTimings; }
+
+        /**
+         * @brief What reload() kept, rebuilt and dropped
+         */
+        struct ReloadStats {
+            std::size_t kept = 0;           // cameras, primitives, meshes and lights left as they were
+            std::size_t changed = 0;        // cameras updated in place
+            std::size_t added = 0;
+            std::size_t removed = 0;
+            std::size_t meshesReused = 0;   // of kept, with their loaded geometry
+        };
+
+        /**
+         * @brief Parses the scene file again and applies only the differences
+         *
+         * Cameras are matched by name and updated in place, so pointers to
+         * them stay valid. Primitives, meshes and lights are matched by their
+         * full description: unchanged ones are kept as they are, loaded mesh
+         * geometry included, and only the others are built. A mesh whose file
+         * changed on disk counts as changed. If the file cannot be parsed or a
+         * primitive cannot be built, the scene is left untouched.
+         * Must not run while a render is using the scene.
+         * @throw std::runtime_error if the scene was not loaded from a file or cannot be rebuilt
+         */
+        ReloadStats reload();
+
+        /**
+         * @brief What reloadPlugins() did
+         */
+        struct PluginReloadStats {
+            Core::PrimitiveFactory::PluginReload plugins;
+            std::size_t recreated = 0;      // primitives of the reopened types
+        };
+
+        /**
+         * @brief Reopens the changed primitive plugins and re-creates their primitives
+         *
+         * Only primitives of the reopened types are created again, from
+         * their stored configuration, then the scene BVH is rebuilt;
+         * cameras, lights, meshes and other primitives stay as they are.
+         * If a primitive fails to build, the previous plugins are put back
+         * and the scene keeps the primitives they made.
+         * Must not run while a render is using the scene.
+         * @throw std::runtime_error if a primitive cannot be re-created, or
+         * primitives were added by hand, which have no configuration to re-create them from
+         */
+        PluginReloadStats reloadPlugins();
+
+        /**
+         * @brief Scene file last loaded, empty before any load
+         */
+        const std::string& sourcePath() const { return _sourcePath; }
+
         std::vector<std::shared_ptr<RayTracer::Camera>> cameras;
         std::map<std::string, std::shared_ptr<RayTracer::Camera>> cameraMap;
-        std::vector<std::shared_ptr<RayTracer::IPrimitive>> primitives;
         std::vector<std::shared_ptr<RayTracer::ILight>> lights;
 
+        /**
+         * @brief Primitives of the scene, plugin ones then meshes when loaded from a file
+         */
+        const std::vector<std::shared_ptr<RayTracer::IPrimitive>>& getPrimitives() const { return _primitives; }
+
+        /**
+         * @brief Adds a primitive built by hand
+         *
+         * Queries scan every primitive until buildAccel() indexes it.
+         */
+        void addPrimitive(std::shared_ptr<RayTracer::IPrimitive> primitive);
+
+        /**
+         * @brief Closest hit of a ray among the primitives
+         *
+         * Goes through the scene BVH, or scans every primitive when
+         * primitives were added since the last buildAccel().
+         */
+        bool intersect(const RayTracer::Ray& ray, HitInfo& hit) const;
+
+        /**
+         * @brief Closest hits of up to PrimitiveBVH::MaxBatch rays traced together
+         * @return Bit r set when rays[r] hit something, hits[r] then filled
+         */
+        uint64_t intersect(const RayTracer::Ray* rays, std::size_t n, HitInfo* hits) const;
+
+        /**
+         * @brief True if a primitive lies along the ray closer than maxDist
+         */
+        bool occluded(const RayTracer::Ray& ray, double maxDist) const;
+
+        /**
+         * @brief Indexes primitives in the scene BVH
+         *
+         * Loading and reloading call it; call it again after adding
+         * primitives by hand. Meshes and plugin types exporting bounds
+         * are placed in the hierarchy, plugin types exporting a batch
+         * kernel are intersected through it.
+         */
+        void buildAccel();
+
+        const RayTracer::PrimitiveBVH& accel() const { return _accel; }
+
         // Camera and object access
         std::shared_ptr<RayTracer::Camera> getCameraByName(const std::string& name) const;
         bool moveObject(const std::string& name, const Math::Vector3D& offset);
 
+        /**
+         * @brief Hash of the scene file last loaded, 0 before any load
+         */
+        uint64_t sourceHash() const { return _sourceHash; }
+
+        /**
+         * @brief Signature of the scene file and of every mesh file it uses
+         *
+         * Changes when any of them is edited, unlike sourceHash().
+         * 0 before any load.
+         */
+        uint64_t contentSignature() const;
+
+        /**
+         * @brief Meshes of the obj_files entries, loaded on first hit
+         */
+        RayTracer::MeshCache& meshCache() { return *_meshCache; }
+
+        /**
+         * @brief Keeps the meshes rays reach from being freed until the pass ends
+         *
+         * Held by every render pass, see MeshCache::Pass.
+         */
+        RayTracer::MeshCache::Pass beginPass() const { return _meshCache->beginPass(); }
+
+        /**
+         * @brief Storage of the plugin primitives, freed with the scene
+         *
+         * Plugin primitives are handles into it. Primitives dropped by
+         * reload() keep their storage until the scene itself goes away.
+         */
+        const Utils::Arena& arena() const { return *_arena; }
+
+        /**
+         * @brief Writes the compiled scene to a single binary file
+         *
+         * Cameras, primitive configurations, lights and every mesh with
+         * its BVH are stored along with signatures of the source files,
+         * so that loadSnapshot() needs neither libconfig nor the OBJ parser.
+         * @throw std::runtime_error if the scene was not loaded from a file
+         * or the snapshot cannot be written
+         */
+        void saveSnapshot(const std::string& path);
+
+        /**
+         * @brief Loads a snapshot, or its source scene if the snapshot is stale
+         *
+         * The snapshot is mapped; meshes point into the mapping and are
+         * faulted in by the first rays that reach them. When the scene
+         * file or a mesh file changed since the snapshot was written, the
+         * scene file it names is loaded instead.
+         * @return true if the snapshot was used, false if the scene was rebuilt
+         * @throw std::runtime_error if the file is not a valid snapshot
+         */
+        bool loadSnapshot(const std::string& path);
+
     private:
+        /**
+         * @brief File a scene was compiled from, with its signature
+         */
+        struct Source {
+            enum Kind : uint8_t {
+                Content,    // hash of the bytes, for the small scene file
+                Stat        // size and modification time, for meshes
+            };
+            std::string path;
+            Kind kind;
+            uint64_t signature;
+        };
+
+        /**
+         * @brief Mesh of an obj_files entry
+         */
+        struct MeshRecord {
+            std::string entry;                          // path as written in the scene file
+            std::string path;                           // file the geometry comes from
+            uint64_t signature = 0;                     // statSignature() of path
+            Color color;
+            double scale = 1.0;
+            Math::Point3D position;
+            RayTracer::Mesh::Shading shading = RayTracer::Mesh::Shading::Auto;
+            std::size_t slot = 0;                       // in _meshCache, unless resident
+            std::shared_ptr<RayTracer::Mesh> resident;  // meshes without known bounds
+            std::shared_ptr<RayTracer::IPrimitive> primitive;
+            double min[3] = {0, 0, 0};
+            double max[3] = {0, 0, 0};
+        };
+
+        /**
+         * @brief How an entry of primitives was made
+         */
+        struct Build {
+            PrimitiveConfig config;     // plugin primitive, when mesh < 0
+            int mesh = -1;              // index in _meshes otherwise
+        };
+
+        /**
+         * @brief One construction pass; results land at their input index
+         */
+        struct Construction {
+            std::vector<const PrimitiveConfig*> configs;
+            std::vector<const Parser::ObjFile*> objFiles;
+            std::vector<std::shared_ptr<RayTracer::IPrimitive>> primitives;    // one per config
+            std::vector<MeshRecord> meshes;                                     // one per obj file
+            double objSeconds = 0;      // summed over the obj_files tasks
+            double accelSeconds = 0;    // BVH builds within those tasks
+        };
+
+        /**
+         * @brief Creates plugin primitives and prepares meshes on the worker pool
+         *
+         * Every obj_files entry and every batch of primitives is a task.
+         * Outputs are indexed by input, cache slots are assigned in input
+         * order afterwards and the first failure in scene order is the one
+         * rethrown, so the result never depends on completion order.
+         */
+        void construct(Construction& work);
+        MeshRecord prepareMesh(const Parser::ObjFile& parsedObj) const;
+        void registerMesh(MeshRecord& record);
+        void addMesh(MeshRecord record);
+        static RayTracer::MeshCache::Loader meshLoader(const MeshRecord& record);
+        static uint64_t statSignature(const std::string& path);
+
         Core::PrimitiveFactory& _factory;
+        uint64_t _sourceHash = 0;
+        std::shared_ptr<RayTracer::MeshCache> _meshCache;
+        std::shared_ptr<Utils::Arena> _arena;
+        std::string _sourcePath;
+        std::vector<Source> _sources;
+        std::vector<MeshRecord> _meshes;
+        std::vector<std::shared_ptr<RayTracer::IPrimitive>> _primitives;
+        std::vector<Build> _builds;                 // how each of _primitives was made
+        LoadTimings _loadTimings;
+        RayTracer::PrimitiveBVH _accel;
+        bool _accelBuilt = false;
 };
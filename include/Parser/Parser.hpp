@@ -117,18 +117,41 @@ namespace Parser {
         Vector3D position;
         double scale;
         Color color;
+        std::string shading;    // "auto", "flat" or "smooth"
     };
 
     /**
      * @brief Light sources definition
      */
     struct Lights {
-        double ambient;
-        double diffuse;
+        double ambient = 0.0;
+        double diffuse = 0.0;
         std::vector<Vector3D> point;
         std::vector<Vector3D> directional;
     };
 
+    /**
+     * @brief Primitive lists of a scene file
+     */
+    struct Primitives {
+        std::vector<Sphere> spheres;
+        std::vector<Plane> planes;
+        std::vector<Cone> cones;
+        std::vector<Cylinder> cylinders;
+        std::vector<Triangle> triangles;
+        std::vector<Rectangle> rectangles;
+        std::vector<ObjFile> objFiles;
+    };
+
+    /**
+     * @brief Everything a scene file describes, as laid out in it
+     */
+    struct Document {
+        std::vector<Camera> cameras;
+        Primitives primitives;
+        Lights lights;
+    };
+
     /**
      * @brief Handles reading and parsing scene configuration files
      */
@@ -211,15 +234,7 @@ namespace Parser {
         std::string getErrorMessage() const;
 
     private:
-        std::vector<Camera> m_cameras;
-        std::vector<Sphere> m_spheres;
-        std::vector<Plane> m_planes;
-        std::vector<Cone> m_cones;
-        std::vector<Triangle> m_triangles;
-        std::vector<Rectangle> m_rectangles;
-        std::vector<Cylinder> m_cylinders;
-        std::vector<ObjFile> m_objFiles;
-        Lights m_lights;
+        Document m_document;
         // Error handling
         bool m_hasError;
         std::string m_errorMessage;
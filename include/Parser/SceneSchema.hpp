@@ -0,0 +1,162 @@
+/*
+** SceneSchema - Settings of a scene file, their nesting and their defaults
+**
+** Every setting Parser reads is listed here; adding one is a line in
+** the table of its struct.
+*/
+#pragma once
+
+#include <string>
+#include "Parser/Parser.hpp"
+#include "Parser/Schema.hpp"
+
+namespace Parser::Schema {
+    constexpr Color White = {255, 255, 255};
+
+    template <>
+    struct Describe<Vector3D> {
+        static constexpr auto fields = std::tuple{
+            field("x", &Vector3D::x),
+            field("y", &Vector3D::y),
+            field("z", &Vector3D::z)};
+    };
+
+    template <>
+    struct Describe<Color> {
+        static constexpr auto fields = std::tuple{
+            field("r", &Color::r),
+            field("g", &Color::g),
+            field("b", &Color::b)};
+    };
+
+    template <>
+    struct Describe<Resolution> {
+        static constexpr auto fields = std::tuple{
+            field("width", &Resolution::width),
+            field("height", &Resolution::height)};
+    };
+
+    template <>
+    struct Describe<Camera> {
+        static constexpr auto fields = std::tuple{
+            field("name", &Camera::name),
+            field("resolution", &Camera::resolution),
+            field("position", &Camera::position),
+            field("rotation", &Camera::rotation),
+            field("fieldOfView", &Camera::fieldOfView)};
+
+        static Camera defaults(int index)
+        {
+            return {"camera_" + std::to_string(index), {800, 600}, {0, 0, 0}, {0, 0, 0}, 60.0};
+        }
+    };
+
+    template <>
+    struct Describe<Sphere> {
+        static constexpr auto fields = std::tuple{
+            field("x", &Sphere::position, &Vector3D::x),
+            field("y", &Sphere::position, &Vector3D::y),
+            field("z", &Sphere::position, &Vector3D::z),
+            field("r", &Sphere::radius),
+            field("color", &Sphere::color)};
+
+        static constexpr Sphere defaults() { return {{0, 0, 0}, 1.0, White}; }
+    };
+
+    template <>
+    struct Describe<Plane> {
+        static constexpr auto fields = std::tuple{
+            field("axis", &Plane::axis),
+            field("position", &Plane::position),
+            field("color", &Plane::color)};
+
+        static Plane defaults() { return {"Z", 0.0, White}; }
+    };
+
+    template <>
+    struct Describe<Cone> {
+        static constexpr auto fields = std::tuple{
+            field("apex", &Cone::apex),
+            field("axis", &Cone::axis),
+            field("radius", &Cone::radius),
+            field("height", &Cone::height),
+            field("color", &Cone::color)};
+
+        static constexpr Cone defaults() { return {{0, 0, 0}, {0, 1, 0}, 1.0, 1.0, White}; }
+    };
+
+    template <>
+    struct Describe<Cylinder> {
+        static constexpr auto fields = std::tuple{
+            field("baseCenter", &Cylinder::baseCenter),
+            field("axis", &Cylinder::axis),
+            field("radius", &Cylinder::radius),
+            field("height", &Cylinder::height),
+            field("color", &Cylinder::color)};
+
+        static constexpr Cylinder defaults() { return {{0, 0, 0}, {0, 1, 0}, 1.0, 1.0, White}; }
+    };
+
+    template <>
+    struct Describe<Triangle> {
+        static constexpr auto fields = std::tuple{
+            field("a", &Triangle::a),
+            field("b", &Triangle::b),
+            field("c", &Triangle::c),
+            field("color", &Triangle::color)};
+
+        static constexpr Triangle defaults() { return {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, White}; }
+    };
+
+    template <>
+    struct Describe<Rectangle> {
+        static constexpr auto fields = std::tuple{
+            field("origin", &Rectangle::origin),
+            field("bottom", &Rectangle::bottom),
+            field("left", &Rectangle::left),
+            field("color", &Rectangle::color)};
+
+        static constexpr Rectangle defaults() { return {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, White}; }
+    };
+
+    template <>
+    struct Describe<ObjFile> {
+        static constexpr auto fields = std::tuple{
+            field("path", &ObjFile::path),
+            field("position", &ObjFile::position),
+            field("scale", &ObjFile::scale),
+            field("color", &ObjFile::color),
+            field("shading", &ObjFile::shading)};
+
+        static ObjFile defaults() { return {"", {0, 0, 0}, 1.0, White, "auto"}; }
+    };
+
+    template <>
+    struct Describe<Lights> {
+        static constexpr auto fields = std::tuple{
+            field("ambient", &Lights::ambient),
+            field("diffuse", &Lights::diffuse),
+            field("point", &Lights::point),
+            field("directional", &Lights::directional)};
+    };
+
+    template <>
+    struct Describe<Primitives> {
+        static constexpr auto fields = std::tuple{
+            field("spheres", &Primitives::spheres),
+            field("planes", &Primitives::planes),
+            field("cones", &Primitives::cones),
+            field("cylinders", &Primitives::cylinders),
+            field("triangles", &Primitives::triangles),
+            field("rectangles", &Primitives::rectangles),
+            field("obj_files", &Primitives::objFiles)};
+    };
+
+    template <>
+    struct Describe<Document> {
+        static constexpr auto fields = std::tuple{
+            field("cameras", &Document::cameras),
+            field("primitives", &Document::primitives),
+            field("lights", &Document::lights)};
+    };
+}
@@ -0,0 +1,189 @@
+/*
+** Schema - Declarative description of how a struct is read from libconfig
+**
+** Each struct read from a group specializes Describe with a constexpr
+** table of its fields, member pointers keyed by setting name, and
+** optionally its defaults. read() then walks the children of a group
+** once, by index, and stores each one through the field of that name:
+** numbers, strings, nested groups and lists of groups alike. Unknown
+** settings are ignored and mistyped ones keep their default, with a
+** warning, as the hand-written blocks did.
+*/
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <libconfig.h++>
+#include "Utils/Log.hpp"
+
+namespace Parser::Schema {
+    /**
+     * @brief A setting name bound to the member it is stored in
+     */
+    template <typename Owner, typename Member>
+    struct Field {
+        const char* name;
+        Member Owner::* member;
+    };
+
+    /**
+     * @brief A setting name bound to a member of a member, for settings flattened into their owner
+     */
+    template <typename Owner, typename Outer, typename Member>
+    struct NestedField {
+        const char* name;
+        Outer Owner::* outer;
+        Member Outer::* member;
+    };
+
+    template <typename Owner, typename Member>
+    constexpr Field<Owner, Member> field(const char* name, Member Owner::* member)
+    {
+        return {name, member};
+    }
+
+    template <typename Owner, typename Outer, typename Member>
+    constexpr NestedField<Owner, Outer, Member> field(const char* name, Outer Owner::* outer, Member Outer::* member)
+    {
+        return {name, outer, member};
+    }
+
+    template <typename Owner, typename Member>
+    constexpr Member& target(Owner& owner, const Field<Owner, Member>& f)
+    {
+        return owner.*f.member;
+    }
+
+    template <typename Owner, typename Outer, typename Member>
+    constexpr Member& target(Owner& owner, const NestedField<Owner, Outer, Member>& f)
+    {
+        return owner.*f.outer.*f.member;
+    }
+
+    /**
+     * @brief Specialized for every struct read from a group
+     *
+     * Provides `static constexpr auto fields`, a tuple of field(), and
+     * optionally `defaults()` or `defaults(int index)` for list elements
+     * whose default depends on their position. Structs without defaults
+     * start value-initialized.
+     */
+    template <typename T>
+    struct Describe;
+
+    template <typename T>
+    concept Described = requires { Describe<T>::fields; };
+
+    template <typename T>
+    struct IsList : std::false_type {};
+
+    template <typename T>
+    struct IsList<std::vector<T>> : std::true_type {};
+
+    /**
+     * @brief Compile-time check that no two fields of a table share a name
+     */
+    template <typename Fields>
+    consteval bool distinctNames(const Fields& fields)
+    {
+        return std::apply([](const auto&... f) {
+            const char* names[] = {f.name...};
+            constexpr std::size_t count = sizeof...(f);
+            for (std::size_t i = 0; i < count; ++i)
+                for (std::size_t j = i + 1; j < count; ++j)
+                    if (std::string_view(names[i]) == names[j])
+                        return false;
+            return true;
+        }, fields);
+    }
+
+    /**
+     * @brief Initial value of a T, before its settings are read
+     * @param index Position in its list, for defaults(int index)
+     */
+    template <typename T>
+    T initial(int index)
+    {
+        if constexpr (requires { Describe<T>::defaults(index); })
+            return Describe<T>::defaults(index);
+        else if constexpr (requires { Describe<T>::defaults(); })
+            return Describe<T>::defaults();
+        else
+            return T{};
+    }
+
+    template <typename T>
+    bool read(const libconfig::Setting& setting, T& value);
+
+    /**
+     * @brief Stores one child of a group through the field of its name
+     * @return false if no field has that name
+     */
+    template <typename T>
+    bool assign(const libconfig::Setting& child, const char* name, T& value)
+    {
+        return std::apply([&](const auto&... f) {
+            return ((std::strcmp(name, f.name) == 0 && (read(child, target(value, f)), true)) || ...);
+        }, Describe<T>::fields);
+    }
+
+    /**
+     * @brief Reads a setting into value, which keeps its current content if the setting does not fit
+     * @return false if the setting has the wrong type
+     */
+    template <typename T>
+    bool read(const libconfig::Setting& setting, T& value)
+    {
+        if constexpr (std::is_arithmetic_v<T>) {
+            switch (setting.getType()) {
+                case libconfig::Setting::TypeInt:
+                    value = static_cast<T>(static_cast<int>(setting));
+                    return true;
+                case libconfig::Setting::TypeInt64:
+                    value = static_cast<T>(static_cast<long long>(setting));
+                    return true;
+                case libconfig::Setting::TypeFloat:
+                    value = static_cast<T>(static_cast<double>(setting));
+                    return true;
+                default:
+                    Utils::Log::warn("Key '", setting.getName() ? setting.getName() : "", "' is not a number (type ",
+                                     setting.getType(), ")");
+                    return false;
+            }
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            if (setting.getType() != libconfig::Setting::TypeString) {
+                Utils::Log::warn("Key '", setting.getName() ? setting.getName() : "", "' is not a string");
+                return false;
+            }
+            value = static_cast<const char*>(setting);
+            return true;
+        } else if constexpr (IsList<T>::value) {
+            // Elements that are not groups keep their defaults, like missing settings
+            using Element = typename T::value_type;
+            const int length = setting.getLength();
+            value.reserve(value.size() + static_cast<std::size_t>(length));
+            for (int i = 0; i < length; ++i) {
+                value.push_back(initial<Element>(i));
+                read(setting[i], value.back());
+            }
+            return true;
+        } else {
+            static_assert(Described<T>, "Parser::Schema::Describe is not specialized for this type");
+            static_assert(distinctNames(Describe<T>::fields), "Two fields share a setting name");
+            if (!setting.isGroup())
+                return false;
+            const int length = setting.getLength();
+            for (int i = 0; i < length; ++i) {
+                const libconfig::Setting& child = setting[i];
+                const char* name = child.getName();
+                if (name && !assign(child, name, value))
+                    Utils::Log::debug("Unknown key '", name, "' ignored");
+            }
+            return true;
+        }
+    }
+}
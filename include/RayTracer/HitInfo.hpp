@@ -17,4 +17,8 @@ struct HitInfo {
     Math::Point3D p;     // point d’impact
     Math::Vector3D n;    // normale (unitaire)
     const Color* color; // couleur de la primitive touchée
+    double u = 0.0;     // coordonnées barycentriques dans le triangle touché
+    double v = 0.0;     // (0 pour les autres primitives)
+    double texU = 0.0;  // coordonnées de texture interpolées, si le maillage en a
+    double texV = 0.0;
 };
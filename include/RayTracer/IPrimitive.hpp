@@ -12,7 +12,7 @@ namespace RayTracer {
             /**
              * @brief Virtual destructor
              */
-            ~IPrimitive() = default;
+            virtual ~IPrimitive() = default;
 
             /**
              * @brief Tests if a ray intersects this primitive
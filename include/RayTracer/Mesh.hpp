@@ -0,0 +1,197 @@
+/*
+** Mesh - Indexed triangle mesh with its own bounding volume hierarchy
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Math/Point3D.hpp"
+#include "RayTracer/IPrimitive.hpp"
+#include "Utils/Color.hpp"
+
+namespace RayTracer {
+    /**
+     * @brief Triangles sharing one vertex buffer
+     *
+     * Vertices are stored once as packed floats and triangles as three
+     * 32-bit indices, instead of one Triangle object (three Point3D copies
+     * and a shared_ptr) per face. A BVH over the triangles is built at
+     * construction, so a ray only tests the few triangles near its path.
+     *
+     * The buffers are either owned by the mesh or borrowed from a storage
+     * object kept alive alongside it, such as a mapped .rtmesh file.
+     */
+    class Mesh : public IPrimitive {
+        public:
+            /**
+             * @brief BVH node; leaves have count > 0
+             *
+             * An inner node's first child directly follows it, the second
+             * one is at index start. A leaf covers triangles
+             * [start, start + count) of the reordered index buffer.
+             * The layout is also the on-disk one of .rtmesh files.
+             */
+            struct Node {
+                float min[3];
+                float max[3];
+                uint32_t start;
+                uint32_t count;
+            };
+
+            /**
+             * @brief Takes ownership of the buffers and builds the BVH
+             * @param vertices x, y, z per vertex
+             * @param indices Three vertex indices per triangle, all in range
+             * @param color Color of the whole mesh
+             */
+            Mesh(std::vector<float> vertices, std::vector<uint32_t> indices,
+                 const Color& color = Color(255, 255, 255));
+
+            /**
+             * @brief Buffers of a mesh stored elsewhere, in BVH leaf order
+             */
+            struct View {
+                const float* vertices = nullptr;    // x, y, z per vertex
+                std::size_t vertexCount = 0;
+                const uint32_t* indices = nullptr;  // three per triangle
+                std::size_t triangleCount = 0;
+                const Node* nodes = nullptr;        // root first, at least one if there are triangles
+                std::size_t nodeCount = 0;
+                const float* normals = nullptr;     // x, y, z per vertex, optional
+                const float* uvs = nullptr;         // u, v per vertex, optional
+            };
+
+            /**
+             * @brief Where shading normals come from
+             */
+            enum class Shading {
+                Auto,       // vertex normals when the source has them, else flat
+                Flat,       // face normals only
+                Smooth      // vertex normals, computed when the source has none
+            };
+
+            /**
+             * @brief Uses prebuilt buffers in place, without copying them
+             * @param storage Owner of the buffers, kept alive by the mesh
+             * @param view The buffers
+             * @param color Color of the whole mesh
+             */
+            Mesh(std::shared_ptr<const void> storage, const View& view,
+                 const Color& color = Color(255, 255, 255));
+
+            /**
+             * @brief Checks that borrowed buffers are safe to traverse
+             *
+             * Every index names a vertex, every leaf lies within the
+             * triangles, every child follows its parent (so traversal
+             * cannot loop) and the tree is shallow enough for the
+             * traversal stack. Reads the whole index buffer.
+             */
+            static bool isValid(const View& view);
+            ~Mesh() = default;
+
+            /**
+             * @brief Takes per-vertex normals to interpolate at hit points
+             * @param normals x, y, z per vertex, or empty to shade flat
+             */
+            void setNormals(std::vector<float> normals);
+
+            /**
+             * @brief Takes per-vertex texture coordinates
+             * @param uvs u, v per vertex, or empty
+             */
+            void setUVs(std::vector<float> uvs);
+
+            /**
+             * @brief Replaces the normals with area-independent, angle-weighted ones
+             *
+             * Each face adds its unit normal to its three vertices, weighted
+             * by the angle of its corner there.
+             */
+            void computeSmoothNormals();
+
+            /**
+             * @brief Drops or computes normals as the shading mode asks
+             */
+            void applyShading(Shading shading);
+
+            /**
+             * @brief Places the mesh in the world without touching its vertices
+             *
+             * A world point is model * scale + offset. Rays are brought to
+             * model space instead, so borrowed buffers stay read-only.
+             * @param scale Uniform scale factor, must be positive
+             * @param offset Translation applied after scaling
+             */
+            void setPlacement(double scale, const Math::Point3D& offset);
+            double scale() const { return _scale; }
+            const Math::Point3D& offset() const { return _offset; }
+
+            /**
+             * @brief Closest intersection with any triangle of the mesh
+             * @param ray The ray to test for intersection
+             * @param info Output parameter for hit information
+             * @return True if hit
+             */
+            bool hits(const Ray& ray, HitInfo& info) const override;
+            const Color& getColor() const override;
+
+            std::size_t vertexCount() const { return _vertexCount; }
+            std::size_t triangleCount() const { return _triangleCount; }
+            std::size_t nodeCount() const { return _nodeCount; }
+            const float* vertices() const { return _vertices; }
+            const uint32_t* indices() const { return _indices; }
+            const Node* nodes() const { return _nodes; }
+            const float* normals() const { return _normals; }
+            const float* uvs() const { return _uvs; }
+
+            /**
+             * @brief Bytes of the vertex, index and BVH buffers, owned or borrowed
+             */
+            std::size_t geometryBytes() const
+            {
+                return _vertexCount * ((_normals ? 6 : 3) + (_uvs ? 2 : 0)) * sizeof(float)
+                     + _triangleCount * 3 * sizeof(uint32_t) + _nodeCount * sizeof(Node);
+            }
+
+            /**
+             * @brief Bytes of the vertex, index and BVH buffers owned by the mesh
+             *
+             * Borrowed buffers are not counted: they live in the page cache.
+             */
+            std::size_t memoryUsage() const;
+
+            /**
+             * @brief Seconds spent building the BVH, 0 when it came with the buffers
+             */
+            double buildSeconds() const { return _buildSeconds; }
+
+        private:
+            uint32_t build(std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                           const std::vector<float>& centroids);
+            bool hitsTriangle(const Math::Vector3D& origin, const Math::Vector3D& direction,
+                              uint32_t triangle, double& t, double& det, double& u, double& v) const;
+
+            std::vector<float> _ownedVertices;
+            std::vector<uint32_t> _ownedIndices;
+            std::vector<Node> _ownedNodes;
+            std::vector<float> _ownedNormals;
+            std::vector<float> _ownedUVs;
+            std::shared_ptr<const void> _storage;
+
+            const float* _vertices = nullptr;
+            const uint32_t* _indices = nullptr;
+            const Node* _nodes = nullptr;
+            const float* _normals = nullptr;
+            const float* _uvs = nullptr;
+            std::size_t _vertexCount = 0;
+            std::size_t _triangleCount = 0;
+            std::size_t _nodeCount = 0;
+
+            double _scale = 1.0;
+            Math::Point3D _offset;
+            Color _color;
+            double _buildSeconds = 0;
+    };
+}
@@ -0,0 +1,156 @@
+/*
+** MeshCache - Loads meshes on demand and keeps them under a memory budget
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "RayTracer/Mesh.hpp"
+
+namespace RayTracer {
+    /**
+     * @brief Owns the resident meshes of a scene and evicts the coldest ones
+     *
+     * Each slot knows how to load its mesh. A slot is loaded the first
+     * time it is acquired; when the resident geometry exceeds the budget,
+     * the meshes least recently acquired are dropped and reloaded on their
+     * next use. Resident meshes are read without locking: a dropped mesh
+     * is only freed once every Pass that may still see it has ended, so
+     * eviction never invalidates a ray in flight.
+     */
+    class MeshCache {
+        public:
+            using Loader = std::function<std::shared_ptr<Mesh>()>;
+
+            /**
+             * @param budget Bytes of geometry allowed to stay resident, 0 for no limit
+             */
+            explicit MeshCache(std::size_t budget = 0);
+            ~MeshCache() = default;
+
+            MeshCache(const MeshCache&) = delete;
+            MeshCache& operator=(const MeshCache&) = delete;
+
+            /**
+             * @brief Keeps the meshes acquired while it lives from being freed
+             *
+             * Held by everything tracing rays concurrently, typically one
+             * per render pass. Must not outlive its cache.
+             */
+            class Pass {
+                public:
+                    Pass() = default;
+                    Pass(Pass&& other) noexcept;
+                    Pass& operator=(Pass&& other) noexcept;
+                    ~Pass();
+
+                private:
+                    friend class MeshCache;
+                    Pass(MeshCache* cache, uint64_t epoch) : _cache(cache), _epoch(epoch) {}
+
+                    MeshCache* _cache = nullptr;
+                    uint64_t _epoch = 0;
+            };
+
+            /**
+             * @brief Opens a new epoch and pins it until the pass ends
+             */
+            Pass beginPass();
+
+            /**
+             * @brief Registers a mesh without loading it
+             *
+             * Slots are added while the scene is built or reloaded, never
+             * concurrently with acquire().
+             * @return Slot to pass to acquire()
+             */
+            std::size_t add(Loader loader);
+
+            /**
+             * @brief Drops the mesh and loader of a slot no longer in the scene
+             *
+             * Like add(), never called concurrently with acquire(). The slot
+             * number is not reused; acquiring it afterwards returns nullptr.
+             */
+            void release(std::size_t slot);
+
+            /**
+             * @brief Returns the mesh of a slot, loading it if needed
+             *
+             * Thread-safe; a resident mesh is returned without locking and
+             * concurrent callers on a cold slot wait for a single load. A
+             * loader that throws leaves the slot empty for good and the
+             * error is reported once.
+             * @return The mesh, valid until the caller's Pass ends, or with
+             *         no pass running, until the next acquire(); nullptr if it
+             *         could not be loaded
+             */
+            const Mesh* acquire(std::size_t slot);
+
+            /**
+             * @brief Changes the budget, evicting right away if it shrank
+             */
+            void setBudget(std::size_t budget);
+            std::size_t budget() const;
+
+            /**
+             * @brief Slots added and not released, loaded or not
+             */
+            std::size_t size() const;
+            std::size_t residentCount() const;
+            std::size_t residentBytes() const;
+            std::size_t loads() const { return _loads.load(std::memory_order_relaxed); }
+            std::size_t evictions() const { return _evictions.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Total time spent in loaders, and in BVH builds within them
+             */
+            double loadSeconds() const { return _loadNanos.load(std::memory_order_relaxed) * 1e-9; }
+            double buildSeconds() const { return _buildNanos.load(std::memory_order_relaxed) * 1e-9; }
+
+        private:
+            struct Entry {
+                Loader loader;
+                std::mutex mutex;               // guards mesh, serializes loads
+                std::shared_ptr<Mesh> mesh;
+                std::atomic<const Mesh*> published{nullptr};   // mesh, for readers
+                std::atomic<bool> failed{false};
+                std::size_t bytes = 0;          // accounted under _mutex
+                std::atomic<uint64_t> lastUse{0};
+            };
+
+            /**
+             * @brief A dropped mesh, freed once no pass of epoch <= epoch runs
+             */
+            struct Retired {
+                std::shared_ptr<Mesh> mesh;
+                uint64_t epoch;
+            };
+
+            const Mesh* load(Entry& entry, std::size_t slot);
+            void enforceBudget(std::size_t keep);
+            void drop(Entry& entry);
+            void endPass(uint64_t epoch);
+
+            std::vector<std::unique_ptr<Entry>> _entries;
+            mutable std::mutex _mutex;          // guards the accounting and epochs below
+            std::size_t _budget;
+            std::size_t _resident = 0;
+            uint64_t _epoch = 0;                        // of the last pass begun
+            std::map<uint64_t, std::size_t> _passes;    // epoch -> passes of it still running
+            std::vector<Retired> _retired;
+
+            // Advanced on every load, so uses are ordered between loads
+            // without a write per ray to a shared counter
+            std::atomic<uint64_t> _clock{1};
+            std::atomic<std::size_t> _loads{0};
+            std::atomic<std::size_t> _evictions{0};
+            std::atomic<uint64_t> _loadNanos{0};
+            std::atomic<uint64_t> _buildNanos{0};
+    };
+}
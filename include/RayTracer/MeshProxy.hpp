@@ -0,0 +1,47 @@
+/*
+** MeshProxy - Stand-in for a mesh that is loaded the first time a ray reaches it
+*/
+#pragma once
+#include <cstddef>
+#include <memory>
+#include "RayTracer/IPrimitive.hpp"
+#include "RayTracer/MeshCache.hpp"
+#include "Utils/Color.hpp"
+
+namespace RayTracer {
+    /**
+     * @brief World-space box standing for a mesh slot of a MeshCache
+     *
+     * Rays missing the box never touch the mesh, so meshes outside the
+     * view are never loaded, and evicted ones come back only when needed.
+     */
+    class MeshProxy : public IPrimitive {
+        public:
+            /**
+             * @param cache Cache holding the mesh
+             * @param slot Slot of the mesh in the cache
+             * @param min Lower corner of the mesh bounds, in world space
+             * @param max Upper corner of the mesh bounds, in world space
+             * @param color Color of the whole mesh
+             */
+            MeshProxy(std::shared_ptr<MeshCache> cache, std::size_t slot,
+                      const double min[3], const double max[3], const Color& color);
+            ~MeshProxy() = default;
+
+            /**
+             * @brief Tests the bounds, then the mesh, loading it if needed
+             * @param ray The ray to test for intersection
+             * @param info Output parameter for hit information
+             * @return True if hit
+             */
+            bool hits(const Ray& ray, HitInfo& info) const override;
+            const Color& getColor() const override;
+
+        private:
+            std::shared_ptr<MeshCache> _cache;
+            std::size_t _slot;
+            double _min[3];
+            double _max[3];
+            Color _color;
+    };
+}
@@ -0,0 +1,91 @@
+/*
+** PrimitiveBVH - Bounding volume hierarchy over the primitives of a scene
+**
+** Primitives with known bounds (plugin types declaring them, and meshes)
+** are sorted into a BVH; the others are tested by every ray. Leaves hand
+** their primitives to the batch kernel of their plugin when it has one.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Core/PluginABI.hpp"
+#include "RayTracer/HitInfo.hpp"
+#include "RayTracer/IPrimitive.hpp"
+#include "RayTracer/Ray.hpp"
+
+namespace RayTracer {
+    /**
+     * @brief Closest-hit and occlusion queries over a fixed set of primitives
+     *
+     * The primitives are not owned and must outlive the hierarchy.
+     */
+    class PrimitiveBVH {
+        public:
+            /**
+             * @brief One primitive to index
+             */
+            struct Entry {
+                const IPrimitive* primitive = nullptr;
+                Core::PluginABI::IntersectBatchFn* kernel = nullptr;    // batch intersection, if any
+                bool bounded = false;
+                double min[3] = {0, 0, 0};
+                double max[3] = {0, 0, 0};
+            };
+
+            static constexpr std::size_t MaxBatch = 64;     // rays per intersect() call
+
+            PrimitiveBVH() = default;
+
+            /**
+             * @brief Builds the hierarchy
+             */
+            explicit PrimitiveBVH(std::vector<Entry> entries);
+
+            /**
+             * @brief Closest hit along a ray
+             */
+            bool intersect(const Ray& ray, HitInfo& hit) const;
+
+            /**
+             * @brief Closest hits of up to MaxBatch rays, traversed together
+             * @return Bit r set when rays[r] hit something, hits[r] then filled
+             */
+            uint64_t intersect(const Ray* rays, std::size_t n, HitInfo* hits) const;
+
+            /**
+             * @brief True if anything lies along the ray closer than maxDist
+             */
+            bool occluded(const Ray& ray, double maxDist) const;
+
+            std::size_t size() const { return _bounded.size() + _unbounded.size(); }
+            std::size_t boundedCount() const { return _bounded.size(); }
+            std::size_t nodeCount() const { return _nodes.size(); }
+
+        private:
+            struct Node {
+                double min[3];
+                double max[3];
+                uint32_t start;     // first entry of a leaf, right child otherwise
+                uint32_t count;     // entries of a leaf, 0 for an inner node (left child follows)
+            };
+
+            static constexpr uint32_t LeafSize = 8;
+            static constexpr int StackSize = 64;
+
+            uint32_t build(std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                           const std::vector<double>& centroids);
+            static void intersectEntries(const Entry* entries, const IPrimitive* const* primitives,
+                                         std::size_t count, const Ray* rays, std::size_t n,
+                                         HitInfo* hits, uint64_t mask);
+            static bool occludedBy(const Entry* entries, const IPrimitive* const* primitives,
+                                   std::size_t count, const Ray& ray, double maxDist);
+
+            std::vector<Node> _nodes;
+            std::vector<Entry> _bounded;                        // in leaf order, kernels grouped per leaf
+            std::vector<const IPrimitive*> _boundedPrimitives;  // the same, as kernels take them
+            std::vector<Entry> _unbounded;                      // kernels grouped
+            std::vector<const IPrimitive*> _unboundedPrimitives;
+    };
+}
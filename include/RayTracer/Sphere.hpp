@@ -26,6 +26,12 @@ namespace RayTracer {
 
             bool hits(const Ray&, HitInfo &info) const override;
 
+            /**
+             * @brief Distance along the ray to the closest intersection in front of its origin
+             * @return The ray parameter t, or infinity if the ray misses
+             */
+            double distance(const Ray& r) const;
+
             const Math::Point3D& getCenter() const;
             double getRadius() const;
             const Color& getColor() const override;
@@ -34,6 +34,13 @@ namespace RayTracer {
             */
             bool hits(const Ray& ray, HitInfo& info) const override;
 
+            /**
+            * @brief Distance along the ray to the triangle, without building the hit
+            * @param ray is ray
+            * @return The ray parameter t, or infinity if the ray misses
+            */
+            double distance(const Ray& ray) const;
+
             // Moves the triangle by the given offset vector
             void translate(const Math::Vector3D& offset) override;
             const Color& getColor() const;
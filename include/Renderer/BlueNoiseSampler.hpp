@@ -0,0 +1,29 @@
+/*
+** BlueNoiseSampler - R2 sequence offset by a tiled blue-noise mask
+*/
+#pragma once
+#include <vector>
+#include "Renderer/ISampler.hpp"
+
+/**
+ * @brief Low-discrepancy R2 points rotated by a blue-noise tile
+ *
+ * The per-pixel rotation comes from a small blue-noise mask repeated over
+ * the frame, which pushes the remaining error to high frequencies where
+ * it is much less visible than white noise at low spp.
+ */
+class BlueNoiseSampler : public ISampler {
+    public:
+        static constexpr int TileSize = 32;
+
+        BlueNoiseSampler();
+        ~BlueNoiseSampler() override = default;
+
+        void prepare(int samplesPerPixel) override;
+        SamplePoint sample(int x, int y, int index) const override;
+
+    private:
+        double maskAt(int x, int y) const;
+
+        std::vector<double> _mask;  // TileSize x TileSize values in [0, 1)
+};
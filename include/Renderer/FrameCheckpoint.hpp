@@ -0,0 +1,66 @@
+/*
+** FrameCheckpoint - Memory-mapped frame-buffer surviving a crashed render
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Renderer/Image.hpp"
+
+/**
+ * @brief File holding a tile-completion bitmap followed by the HDR pixels
+ *
+ * The pixels are mapped shared, so whatever the renderer wrote is in the
+ * page cache even if the process is killed. A tile's bit is only set once
+ * all of its pixels are final; a restarted render opening the same file
+ * with the same key skips those tiles.
+ */
+class FrameCheckpoint {
+    public:
+        /**
+         * @brief Opens path, or resets it if it belongs to another render
+         * @param key Fingerprint of everything that affects the pixels
+         * @throw RendererException if the file cannot be created or mapped
+         */
+        FrameCheckpoint(const std::string& path, int width, int height,
+                        int tileSize, uint64_t key);
+        ~FrameCheckpoint();
+
+        FrameCheckpoint(const FrameCheckpoint&) = delete;
+        FrameCheckpoint& operator=(const FrameCheckpoint&) = delete;
+
+        /** @brief True when progress from an earlier run was found */
+        bool resumed() const { return _resumed; }
+
+        bool isTileDone(int tile) const;
+        /** @brief Thread-safe; call only after the tile's pixels are written */
+        void markTileDone(int tile);
+        int completedTiles() const;
+
+        /** @brief width * height cells, image rows top to bottom */
+        AccumPixel* pixels() { return _pixels; }
+
+        /** @brief Deletes the file, e.g. once the final image is saved */
+        void remove();
+
+        const std::string& path() const { return _path; }
+
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            int32_t width;
+            int32_t height;
+            int32_t tileSize;
+            uint64_t key;
+        };
+
+        std::string _path;
+        int _fd = -1;
+        void* _map = nullptr;
+        std::size_t _size = 0;
+        int _tiles = 0;
+        bool _resumed = false;
+        uint64_t* _bitmap = nullptr;
+        AccumPixel* _pixels = nullptr;
+};
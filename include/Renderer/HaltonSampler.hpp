@@ -0,0 +1,23 @@
+/*
+** HaltonSampler - Low-discrepancy sampling with the Halton sequence
+*/
+#pragma once
+#include "Renderer/ISampler.hpp"
+
+/**
+ * @brief Halton points in bases 2 and 3, rotated per pixel
+ *
+ * The Cranley-Patterson rotation keeps neighbouring pixels from sharing
+ * the exact same pattern, which would show as structured aliasing.
+ */
+class HaltonSampler : public ISampler {
+    public:
+        HaltonSampler() = default;
+        ~HaltonSampler() override = default;
+
+        void prepare(int samplesPerPixel) override;
+        SamplePoint sample(int x, int y, int index) const override;
+
+    private:
+        static double radicalInverse(int base, int index);
+};
@@ -0,0 +1,34 @@
+/*
+** IImageSink - Interface for outputs fed band by band during a render
+*/
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Receives the finished frame as bands of 8-bit RGB rows
+ *
+ * Lets Renderer::renderStreaming write images far larger than memory:
+ * rows are handed over as soon as they are final and never kept.
+ */
+class IImageSink {
+    public:
+        virtual ~IImageSink() = default;
+
+        /**
+         * @brief Called once before the first band
+         * @param width Image width in pixels
+         * @param height Image height in pixels
+         */
+        virtual void begin(int width, int height) = 0;
+
+        /**
+         * @brief Stores rows [firstRow, firstRow + rows) of the image
+         * @param rgb Packed RGB, 3 bytes per pixel, row 0 at the top
+         */
+        virtual void writeRows(int firstRow, int rows, const uint8_t* rgb) = 0;
+
+        /**
+         * @brief Called once after the last band
+         */
+        virtual void end() = 0;
+};
@@ -0,0 +1,72 @@
+/*
+** ISampler - Interface for the per-pixel antialiasing sample patterns
+*/
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Position of a sample inside its pixel, both coordinates in [0, 1)
+ */
+struct SamplePoint {
+    double u;
+    double v;
+};
+
+/**
+ * @brief Produces the sub-pixel positions traced for every pixel
+ *
+ * Any prefix of a pixel's sequence must be well spread over the pixel:
+ * adaptive sampling and progressive passes stop or resume anywhere.
+ */
+class ISampler {
+    public:
+        virtual ~ISampler() = default;
+
+        /**
+         * @brief Called by the renderer before use with the maximum spp
+         * @param samplesPerPixel Number of samples each pixel may receive
+         */
+        virtual void prepare(int samplesPerPixel) = 0;
+
+        /**
+         * @brief Returns sample index of pixel (x, y)
+         * @param x Pixel column
+         * @param y Pixel row
+         * @param index Sample index, in [0, samplesPerPixel)
+         */
+        virtual SamplePoint sample(int x, int y, int index) const = 0;
+};
+
+namespace Sampling {
+    /**
+     * @brief Decorrelates pixels: well mixed 32-bit hash of (x, y, seed)
+     */
+    inline uint32_t hashPixel(int x, int y, uint32_t seed)
+    {
+        uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u
+                   ^ static_cast<uint32_t>(y) * 0xd8163841u
+                   ^ seed * 0xcb1ab31fu;
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    /**
+     * @brief Maps a 32-bit integer to [0, 1)
+     */
+    inline double toUnit(uint32_t bits)
+    {
+        return bits * (1.0 / 4294967296.0);
+    }
+
+    /**
+     * @brief Wraps a value into [0, 1)
+     */
+    inline double wrap(double value)
+    {
+        return value - static_cast<int64_t>(value) + (value < 0.0 ? 1.0 : 0.0);
+    }
+}
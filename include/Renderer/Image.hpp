@@ -17,29 +17,124 @@
 #include "Utils/Color.hpp"
 
 /**
- * \brief Simple 8-bit RGB frame-buffer.
+ * \brief Linear HDR accumulation cell.
+ *
+ * Holds the running sum of the samples that landed in the pixel and their
+ * total weight; the pixel value is sum / weight. Components may exceed 1.
+ */
+struct AccumPixel {
+    Color::Float sum;
+    float weight = 0.f;
+};
+
+/**
+ * \brief Operator mapping HDR values to the displayable [0, 1] range.
+ */
+enum class ToneMap {
+    Clamp,      ///< Values above 1 are clipped (matches the legacy 8-bit output)
+    Reinhard,   ///< x / (1 + x), never clips
+    Aces        ///< Narkowicz fit of the ACES filmic curve
+};
+
+/**
+ * \brief Float HDR frame-buffer, quantized to 8-bit only on output.
  */
 class Image {
 public:
     Image(int width, int height);
+    /**
+     * \brief Wrap width * height cells owned by the caller (e.g. a mapped file).
+     *
+     * The buffer must outlive the image. Copies of the image always own
+     * their pixels; moves keep referring to the caller's buffer.
+     */
+    Image(int width, int height, AccumPixel* buffer);
     ~Image() = default;
 
+    Image(const Image& other);
+    Image(Image&& other) noexcept;
+    Image& operator=(const Image& other);
+    Image& operator=(Image&& other) noexcept;
+
+    /** \brief Overwrite a pixel with a single sample (8-bit or HDR). */
     void  setPixel(int x, int y, const Color& c);
+    void  setPixel(int x, int y, const Color::Float& c);
+    /** \brief Tone-mapped and quantized pixel. */
     Color getPixel(int x, int y) const;
+    /** \brief Linear HDR pixel value (sum / weight). */
+    Color::Float getPixelHDR(int x, int y) const;
+
+    /**
+     * \brief Direct access to the accumulation cell, for the renderer.
+     *
+     * No bounds check: callers iterate within [0, width) x [0, height).
+     */
+    AccumPixel& at(int x, int y) { return _data[y * _width + x]; }
+    const AccumPixel& at(int x, int y) const { return _data[y * _width + x]; }
+
+    /** \brief Select the tone mapping applied on output, with a linear pre-scale. */
+    void setToneMap(ToneMap op, float exposure = 1.f);
+    ToneMap toneMap() const { return _toneMap; }
+    float exposure() const { return _exposure; }
 
     /**
-     * \brief Write the buffer in ASCII-PPM (P3) format.
+     * \brief Write the tone-mapped frame in binary PPM (P6) format.
      * \param path  Destination file path (e.g. "screenshots/out.ppm")
+     * \return      Number of bytes written
      */
-    void writePPM(const std::string& path) const;
+    size_t writePPM(const std::string& path) const;
+
+    /**
+     * \brief Write the tone-mapped frame as an 8-bit RGB PNG.
+     * \return Number of bytes written
+     */
+    size_t writePNG(const std::string& path) const;
+
+    /**
+     * \brief Write the linear HDR frame as an uncompressed 32-bit float
+     *        OpenEXR scanline image; tone mapping is not applied.
+     * \return Number of bytes written
+     */
+    size_t writeEXR(const std::string& path) const;
+
+    /**
+     * \brief Write the frame in the format given by the path extension
+     *        (.ppm, .png or .exr, case-insensitive).
+     * \throw  std::invalid_argument on any other extension
+     * \return Number of bytes written
+     */
+    size_t save(const std::string& path) const;
+
+    /** \brief Whether save() knows the extension of path. */
+    static bool isSupportedFormat(const std::string& path);
+    /** \brief Lower-case extension of path, without the dot. */
+    static std::string extension(const std::string& path);
 
     int width()  const { return _width; }
     int height() const { return _height; }
 
+    /**
+     * \brief Tone map and quantize the whole frame in one pass.
+     * \return Packed 8-bit RGB, row-major, 3 bytes per pixel
+     */
+    std::vector<uint8_t> toRGB8() const;
+    /** \brief Same as toRGB8 for rows [firstRow, firstRow + rows), into out. */
+    void toRGB8(uint8_t* out, int firstRow, int rows) const;
+
     std::vector<uint8_t> toRGBA() const;
+    /** \brief RGBA copy of the w x h region whose top-left corner is (x, y). */
+    std::vector<uint8_t> toRGBA(int x, int y, int w, int h) const;
 
 private:
+    /** \brief Tone map one linear value and convert it to a byte. */
+    uint8_t quantize(float linear) const;
+
     int _width;
     int _height;
-    std::vector<Color> _pixels;   // row-major (y * width + x)
+    ToneMap _toneMap = ToneMap::Clamp;
+    float _exposure = 1.f;
+    size_t pixelCount() const { return static_cast<size_t>(_width) * _height; }
+
+    std::vector<AccumPixel> _storage;  // empty when wrapping a caller buffer
+    AccumPixel* _data;                 // row-major (y * width + x)
 };
@@ -0,0 +1,71 @@
+/*
+** PNGStreamSink - PNG compressed in parallel while the render goes on
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Renderer/IImageSink.hpp"
+#include "Utils/PNG.hpp"
+
+/**
+ * @brief Compresses every band as an independent strip on the worker pool
+ *
+ * Bands are queued for compression as soon as they arrive and written out
+ * as IDAT chunks in order, so by the time the last band is rendered only
+ * that band is left to compress. Bands must arrive top to bottom.
+ */
+class PNGStreamSink : public IImageSink {
+    public:
+        explicit PNGStreamSink(const std::string& path);
+        ~PNGStreamSink() override = default;
+
+        PNGStreamSink(const PNGStreamSink&) = delete;
+        PNGStreamSink& operator=(const PNGStreamSink&) = delete;
+
+        void begin(int width, int height) override;
+        /** @throw std::runtime_error if the band is not the next one down */
+        void writeRows(int firstRow, int rows, const uint8_t* rgb) override;
+        void end() override;
+
+        /** @brief Bytes written so far */
+        std::size_t size() const { return _written; }
+
+    private:
+        /**
+         * @brief Band waiting for, or done with, compression
+         *
+         * Whoever claims it first compresses it: a pool worker, or the
+         * sink itself when it needs the result.
+         */
+        struct Strip {
+            std::vector<uint8_t> rgb;
+            int rows = 0;
+            bool last = false;
+            Utils::PNG::Strip result;
+            std::atomic<bool> claimed{false};
+            std::promise<void> promise;
+            std::shared_future<void> done = promise.get_future().share();
+
+            void run(int width);
+        };
+
+        /** @brief Writes finished strips in order; waits for them if asked */
+        void flush(bool wait);
+        void write(const std::vector<uint8_t>& bytes);
+
+        std::string _path;
+        std::ofstream _out;
+        int _width = 0;
+        int _height = 0;
+        int _nextRow = 0;
+        bool _first = true;
+        uint32_t _adler = 1;
+        std::size_t _written = 0;
+        std::deque<std::shared_ptr<Strip>> _pending;
+};
@@ -0,0 +1,37 @@
+/*
+** PPMStreamSink - Binary PPM written in place, band by band
+*/
+#pragma once
+#include <cstddef>
+#include <string>
+#include "Renderer/IImageSink.hpp"
+
+/**
+ * @brief Preallocates a P6 file and pwrites every band at its final offset
+ *
+ * Bands may arrive in any order; nothing but the file descriptor is kept.
+ */
+class PPMStreamSink : public IImageSink {
+    public:
+        explicit PPMStreamSink(const std::string& path);
+        ~PPMStreamSink() override;
+
+        PPMStreamSink(const PPMStreamSink&) = delete;
+        PPMStreamSink& operator=(const PPMStreamSink&) = delete;
+
+        void begin(int width, int height) override;
+        void writeRows(int firstRow, int rows, const uint8_t* rgb) override;
+        void end() override;
+
+        /** @brief Total file size, valid after begin() */
+        std::size_t size() const { return _dataOffset + _rowBytes * _height; }
+
+    private:
+        void writeAt(const void* data, std::size_t size, std::size_t offset);
+
+        std::string _path;
+        int _fd = -1;
+        int _height = 0;
+        std::size_t _rowBytes = 0;
+        std::size_t _dataOffset = 0;
+};
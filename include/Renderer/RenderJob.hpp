@@ -0,0 +1,173 @@
+/*
+** RenderJob - Handle on an asynchronous render in flight
+**
+** Returned by Renderer::renderAsync. Gives access to the resulting frame
+** through a future, lets the caller cancel the render cooperatively and
+** reports the completion of every tile through an optional callback.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Renderer/Image.hpp"
+#include "Renderer/ISampler.hpp"
+#include "Renderer/FrameCheckpoint.hpp"
+#include "RayTracer/MeshCache.hpp"
+#include "Utils/Color.hpp"
+
+/**
+ * \brief Region of the frame that has just been finished.
+ *
+ * Coordinates are expressed in image space (row 0 is the top of the frame),
+ * over the whole render even when the job only covers a band of it.
+ */
+struct TileProgress {
+    int x;              ///< Left column of the tile
+    int y;              ///< Top row of the tile
+    int width;          ///< Tile width in pixels
+    int height;         ///< Tile height in pixels
+    int pass;           ///< Index of the pass the tile belongs to
+    int completed;      ///< Tiles finished so far over all passes, this one included
+    int total;          ///< Tiles in the whole job, all passes included
+    std::vector<uint8_t> rgba;  ///< Tile pixels as finished, RGBA rows from the top
+};
+
+/**
+ * \brief One sweep over the frame.
+ *
+ * A pass with scale > 1 traces a single ray per scale x scale block and
+ * fills the block with it; its samples are not accumulated. Other passes
+ * add samples [firstSample, endSample) to every pixel.
+ */
+struct RenderPass {
+    int index;          ///< Position of the pass in the job
+    int count;          ///< Number of passes in the job
+    int scale;          ///< Pixel block edge traced with a single ray
+    int firstSample;    ///< First sample index traced by this pass
+    int endSample;      ///< Samples per pixel accumulated once the pass is done
+};
+
+class RenderJob {
+public:
+    /**
+     * \brief Called once per finished tile.
+     *
+     * Calls are serialized, but they happen on the render workers: keep the
+     * callback short and do not call back into the job from it.
+     */
+    using ProgressCallback = std::function<void(const TileProgress&)>;
+
+    /**
+     * \brief Called once per finished pass with the whole frame.
+     *
+     * Runs on the worker that finished the pass, before the next pass starts.
+     */
+    using PassCallback = std::function<void(const RenderPass&, const Image&)>;
+
+    /**
+     * \param frame Frame to fill, possibly wrapping an external buffer
+     */
+    RenderJob(Image frame, int tileSize, std::vector<RenderPass> passes,
+              std::shared_ptr<const ISampler> sampler,
+              ProgressCallback progress, PassCallback onPass = nullptr);
+    ~RenderJob() = default;
+
+    RenderJob(const RenderJob&) = delete;
+    RenderJob& operator=(const RenderJob&) = delete;
+
+    /**
+     * \brief Future fulfilled with the finished frame.
+     *
+     * Holds a RenderCancelledException if the job was cancelled before every
+     * tile was rendered.
+     */
+    std::future<Image>& future();
+
+    /**
+     * \brief Blocks until the job ends and returns the frame (single use).
+     * \throws RenderCancelledException if the job was cancelled
+     */
+    Image get();
+
+    /** \brief Blocks until every worker has left the job. */
+    void wait() const;
+
+    /** \brief True once the future is ready (finished, failed or cancelled). */
+    bool isDone() const;
+
+    /**
+     * \brief Requests the workers to stop after their current tile.
+     *
+     * Returns immediately; use wait() to know when the scene is released.
+     */
+    void cancel();
+    bool isCancelled() const;
+
+    int completedTiles() const;
+    int totalTiles() const;
+    const std::vector<RenderPass>& passes() const;
+
+    /**
+     * \brief Samples actually accumulated per pixel, averaged over the frame.
+     *
+     * Lower than the target spp when adaptive sampling stopped early on
+     * converged pixels. Preview passes and tiles restored from a
+     * checkpoint are not counted.
+     */
+    double averageSamplesPerPixel() const;
+
+    /**
+     * \brief Frame being filled by the workers.
+     *
+     * Must not be read while the job is running, since later passes
+     * rewrite finished tiles in place: use the pixels handed to the
+     * progress and pass callbacks instead. Safe once wait() returned.
+     */
+    const Image& frame() const;
+
+private:
+    friend class Renderer;
+
+    int  tilesPerPass() const { return _tilesX * _tilesY; }
+    int  tileCount() const { return tilesPerPass() * static_cast<int>(_passes.size()); }
+    const RenderPass& currentPass() const { return _passes[_pass]; }
+    void tileDone(int x, int y, int width, int height, int frameY);   // frameY: top row of the tile in _frame
+    void fail(std::exception_ptr error);
+    bool workerFinished();
+
+    Image _frame;                       // HDR accumulation target, rows flipped
+    int _originY = 0;                   // first render-space row covered by the job
+    std::shared_ptr<FrameCheckpoint> _checkpoint;  // backs _frame when resumable
+    std::vector<float> _lumaSq;         // running sum of squared sample luminance
+    std::vector<uint16_t> _samples;     // samples accumulated in each pixel
+    std::vector<uint8_t> _converged;    // set once adaptive sampling stopped a pixel
+    int _tileSize;
+    int _tilesX;
+    int _tilesY;
+    std::vector<RenderPass> _passes;
+    std::shared_ptr<const ISampler> _sampler;  // kept alive even if the renderer switches
+    RayTracer::MeshCache::Pass _meshPass;      // of the pass being rendered
+    ProgressCallback _progress;
+    PassCallback _onPass;
+
+    std::atomic<bool> _cancelled{false};
+    std::atomic<int>  _pass{0};
+    std::atomic<int>  _nextTile{0};
+    std::atomic<int>  _completed{0};
+    std::atomic<int>  _activeWorkers{0};
+    std::atomic<long long> _samplesTraced{0};
+
+    std::mutex _progressMutex;
+    std::mutex _errorMutex;
+    std::exception_ptr _error;
+
+    std::promise<Image> _promise;
+    std::future<Image>  _future;
+};
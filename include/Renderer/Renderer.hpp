@@ -11,6 +11,9 @@
 #include <limits>
 #include <cmath>
 #include "Renderer/Image.hpp"
+#include "Renderer/RenderJob.hpp"
+#include "Renderer/ISampler.hpp"
+#include "Renderer/IImageSink.hpp"
 #include "Core/Scene.hpp"
 #include "RayTracer/HitInfo.hpp"
 #include "RayTracer/Camera.hpp"
@@ -24,6 +27,34 @@ class Renderer {
         Renderer(int width, int height, int samplesPerPixel = 1);
         ~Renderer() = default;
 
+        /**
+         * \brief Stop sampling pixels whose estimate has converged.
+         *
+         * Every pixel receives at least minSamples samples; after that it is
+         * left alone once the standard error of its mean luminance (0-1
+         * scale) drops to threshold. The test runs each time the sample count
+         * doubles, so rays keep being traced in batches.
+         * samplesPerPixel stays the maximum.
+         * \param minSamples Samples traced before the first check, 0 disables
+         * \param threshold  Standard error under which a pixel is converged
+         */
+        void setAdaptiveSampling(int minSamples, double threshold = 0.005);
+
+        /**
+         * \brief Replace the sub-pixel sample pattern (Sobol by default).
+         *
+         * Jobs already running keep the sampler they were started with.
+         */
+        void setSampler(std::shared_ptr<ISampler> sampler);
+
+        /**
+         * \brief Tone mapping attached to the frames of later jobs.
+         *
+         * Frames stay linear HDR; the operator only runs when they are
+         * quantized for display or output.
+         */
+        void setToneMap(ToneMap op, float exposure = 1.f);
+
         /**
          * \brief Render the scene from a given camera.
          * \param scene  Parsed scene holding cameras / primitives / lights
@@ -33,20 +64,103 @@ class Renderer {
         Image render(const Scene& scene,
         const std::shared_ptr<RayTracer::Camera>& camera) const;
 
+        /**
+         * \brief Start rendering on the shared worker pool and return at once.
+         * \param scene    Scene to render; must outlive the job and stay unchanged
+         * \param camera   Active camera; must not be moved while the job runs
+         * \param progress Optional callback invoked after every finished tile
+         * \return         Handle exposing the future frame and cancellation
+         *
+         * The renderer itself must also outlive the returned job.
+         */
+        std::shared_ptr<RenderJob> renderAsync(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            RenderJob::ProgressCallback progress = nullptr) const;
+
+        /**
+         * \brief Start a progressive render publishing every intermediate pass.
+         *
+         * The first pass traces one ray per 8x8 block, the second one sample
+         * per pixel at full resolution, then each pass doubles the number of
+         * accumulated samples until samplesPerPixel is reached.
+         * Same lifetime rules as renderAsync.
+         * \param onPass   Called with the whole frame after every pass
+         * \param progress Optional callback invoked after every finished tile
+         */
+        std::shared_ptr<RenderJob> renderProgressive(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            RenderJob::PassCallback onPass,
+            RenderJob::ProgressCallback progress = nullptr) const;
+
+        /**
+         * \brief Like renderAsync, with the frame-buffer mapped from a file.
+         *
+         * Finished tiles are recorded in the file as they complete. If it
+         * already holds progress for the same scene, camera and renderer
+         * settings, those tiles are not traced again. Delete the file once
+         * the result is saved (FrameCheckpoint::remove or plain unlink).
+         * \param checkpointPath File created or resumed
+         * \throws RendererException if the file cannot be mapped
+         */
+        std::shared_ptr<RenderJob> renderResumable(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            const std::string& checkpointPath,
+            RenderJob::ProgressCallback progress = nullptr) const;
+
+        /**
+         * \brief Render the frame band by band into a sink, without ever
+         *        holding the whole frame.
+         *
+         * Bands are rows of tiles, rendered from the top of the image down;
+         * the next band is queued before waiting on the current one, so the
+         * workers go on tracing while a band finishes and is written, and
+         * at most two bands are resident whatever the image height.
+         * \param sink     Output receiving every band once, top to bottom
+         * \param progress Optional callback, tile counts cover the whole image
+         * \return         Samples per pixel averaged over the image
+         */
+        double renderStreaming(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            IImageSink& sink,
+            RenderJob::ProgressCallback progress = nullptr) const;
+
     private:
+        static constexpr int BlockSize = 32;    // tile edge, in pixels
+        static constexpr int RayBatch = 16;     // samples of a pixel traced together
+
         int _w;
         int _h;
         int _samplesPerPixel;
+        int _minSamples = 0;            // 0 when adaptive sampling is off
+        double _varianceThreshold = 0.005;
+        std::shared_ptr<ISampler> _sampler;
+        ToneMap _toneMap = ToneMap::Clamp;
+        float _exposure = 1.f;
 
         bool tracePrimaryRay(const Scene& scene,
                          const RayTracer::Ray& ray,
                          HitInfo& outHit) const;
-        Color shadePixel(const Scene& scene, const HitInfo& hit) const;
+        Color::Float shadePixel(const Scene& scene, const HitInfo& hit) const;
         bool isShadowed(const Scene& scene,
             const Math::Point3D& P,
             const Math::Vector3D& L,
             double maxDist = std::numeric_limits<double>::infinity()
         )const;
-        static Color writeBackground();
-        static void processBlocks(const Renderer* renderer, const struct ThreadData& data);
+        static Color::Float writeBackground();
+        bool isConverged(const Color::Float& sum, float lumaSq, int n) const;
+        std::shared_ptr<RenderJob> startJob(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            std::vector<RenderPass> passes,
+            RenderJob::ProgressCallback progress,
+            RenderJob::PassCallback onPass,
+            int originY = 0, int rows = -1,
+            std::shared_ptr<FrameCheckpoint> checkpoint = nullptr) const;
+        void schedulePass(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            const std::shared_ptr<RenderJob>& job) const;
+        void renderTiles(const Scene& scene,
+            const std::shared_ptr<RayTracer::Camera>& camera,
+            const std::shared_ptr<RenderJob>& job) const;
+        void renderTile(const Scene& scene,
+            const RayTracer::Camera& camera, RenderJob& job, int tile) const;
 };
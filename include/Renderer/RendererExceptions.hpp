@@ -0,0 +1,22 @@
+/*
+**
+**
+**
+**
+*/
+
+#pragma once
+#include <stdexcept>
+#include <string>
+
+class RendererException : public std::runtime_error {
+    public:
+        explicit RendererException(const std::string& msg)
+        : std::runtime_error("Renderer error: " + msg) {}
+};
+
+class RenderCancelledException : public RendererException {
+    public:
+        RenderCancelledException()
+        : RendererException("render job was cancelled") {}
+};
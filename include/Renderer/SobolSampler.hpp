@@ -0,0 +1,26 @@
+/*
+** SobolSampler - Low-discrepancy sampling with the Sobol (0,2)-sequence
+*/
+#pragma once
+#include "Renderer/ISampler.hpp"
+
+/**
+ * @brief First two Sobol dimensions, Owen-scrambled per pixel
+ *
+ * Every power-of-two prefix is perfectly stratified in both directions;
+ * the nested uniform scrambling keeps that property while decorrelating
+ * neighbouring pixels.
+ */
+class SobolSampler : public ISampler {
+    public:
+        SobolSampler() = default;
+        ~SobolSampler() override = default;
+
+        void prepare(int samplesPerPixel) override;
+        SamplePoint sample(int x, int y, int index) const override;
+
+    private:
+        static uint32_t vanDerCorput(uint32_t index);
+        static uint32_t sobol2(uint32_t index);
+        static uint32_t owenScramble(uint32_t value, uint32_t seed);
+};
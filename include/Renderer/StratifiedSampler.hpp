@@ -0,0 +1,24 @@
+/*
+** StratifiedSampler - Jittered N-rooks sampling
+*/
+#pragma once
+#include <vector>
+#include "Renderer/ISampler.hpp"
+
+/**
+ * @brief Splits the pixel in N rows and N columns, one jittered sample each
+ *
+ * Works for any N, square or not. Samples are visited in bit-reversed
+ * column order so that every prefix already covers the whole pixel.
+ */
+class StratifiedSampler : public ISampler {
+    public:
+        StratifiedSampler() = default;
+        ~StratifiedSampler() override = default;
+
+        void prepare(int samplesPerPixel) override;
+        SamplePoint sample(int x, int y, int index) const override;
+
+    private:
+        std::vector<int> _order;    // column stratum visited by each sample index
+};
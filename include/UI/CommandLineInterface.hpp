@@ -10,7 +10,11 @@
 #include <string>
 #include "Core/Scene.hpp"
 #include "Renderer/Renderer.hpp"
+#include "Utils/FileWatcher.hpp"
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 /// @class CommandLineInterface
 /// @brief Handles user interaction with the raytracer through a command-line interface.
@@ -25,6 +29,7 @@ private:
     Scene& _scene;
     Renderer& _renderer; ///< Reference to the renderer used to generate images.
     std::shared_ptr<RayTracer::Camera> _activeCamera; /// Currently active camera in the scene.
+    std::shared_ptr<RenderJob> _job; ///< Last render started, possibly still in flight.
 
     /// @brief Parses and executes a command line input.
     /// @param line The command entered by the user.
@@ -36,9 +41,33 @@ private:
     /// @brief Initializes the available commands in the CLI.
     void initCommands();
 
+    /// @brief Cancels the in-flight render, if any, and waits for its workers.
+    /// Must be called before the scene or a camera is modified.
+    void cancelRender();
+
     // Handle the differents commands
     void cmd_cam(std::istringstream&);
     void cmd_render(std::istringstream&);
     void cmd_move(std::istringstream&);
     void cmd_preview(std::istringstream&);
+    void cmd_sampler(std::istringstream&);
+    void cmd_tonemap(std::istringstream&);
+    void cmd_stream(std::istringstream&);
+    void cmd_meshes(std::istringstream&);
+    void cmd_snapshot(std::istringstream&);
+    void cmd_log(std::istringstream&);
+    void cmd_reload(std::istringstream&);
+    void cmd_watch(std::istringstream&);
+    void cmd_plugins(std::istringstream&);
+    void renderStreamed(const std::string& filename);
+
+    /// @brief Applies the scene file's changes to the live scene; called with _mutex held.
+    void reloadScene();
+    /// @brief Runs the pending reloads unless _mutex is taken, whose holder then runs them.
+    /// Called without _mutex, by the watcher and after every command.
+    void runPendingReloads();
+
+    std::mutex _mutex; ///< Serializes commands with reloads from the file watcher.
+    std::atomic<bool> _reloadPending{false}; ///< Set by the watcher, cleared by the reload.
+    std::unique_ptr<Utils::FileWatcher> _watcher; ///< Declared last: stopped before the rest goes.
 };
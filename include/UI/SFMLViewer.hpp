@@ -8,21 +8,45 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Math/Vector3D.hpp"
 #include "Renderer/Image.hpp"
+#include "Renderer/RenderJob.hpp"
 
 /// @class SFMLViewer
 /// @brief A viewer class that uses SFML to display a rendered image.
 class SFMLViewer {
 public:
+    /// @brief Starts a render forwarding the given callbacks, returns its job.
+    using RenderStarter = std::function<std::shared_ptr<RenderJob>(
+        RenderJob::ProgressCallback, RenderJob::PassCallback)>;
+    /// @brief Moves the active camera by the given offset.
+    using CameraMover = std::function<void(const Math::Vector3D&)>;
+
     /// @brief Constructs an SFMLViewer with the given dimensions.
     SFMLViewer(unsigned width, unsigned height);
     /// @brief Displays the given image in the SFML window.
     void show(const Image& image);
+    /// @brief Displays a render tile by tile while it is in flight.
+    /// Arrow keys and PageUp/PageDown move the camera: the running job is
+    /// cancelled at once and a new one is started from the new viewpoint.
+    void show(const RenderStarter& startRender, const CameraMover& moveCamera);
 
 private:
+    /// @brief Copies the pixels of the finished tiles into the texture.
+    void uploadPendingTiles();
+    /// @brief Maps a key to a camera offset, returns false for other keys.
+    static bool cameraOffset(sf::Keyboard::Key key, Math::Vector3D& offset);
 
     unsigned _width, _height;
     sf::RenderWindow _window;
     sf::Texture _texture;
     sf::Sprite _sprite;
+    std::mutex _tilesMutex;
+    std::vector<TileProgress> _pendingTiles; ///< Filled by the render workers.
+    std::string _pendingTitle; ///< Set by the render workers after each pass.
 };
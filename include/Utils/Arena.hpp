@@ -0,0 +1,118 @@
+/*
+** Arena - Monotonic bump allocator releasing everything at once
+**
+** Objects that live exactly as long as their owner (the primitives of a
+** scene) are carved out of large blocks instead of one heap allocation
+** each, and their destructors run together when the arena goes away.
+*/
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Utils {
+    /**
+     * @brief Thread-safe bump allocator with deferred destruction
+     */
+    class Arena {
+        public:
+            static constexpr std::size_t DefaultBlockSize = 64 * 1024;
+            static constexpr std::size_t MaxBlockSize = 4 * 1024 * 1024;
+
+            /**
+             * @param blockSize Size of the first block; later blocks double up to MaxBlockSize
+             */
+            explicit Arena(std::size_t blockSize = DefaultBlockSize);
+
+            /**
+             * @brief Destroys every object and frees every block
+             */
+            ~Arena();
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            /**
+             * @brief Returns size bytes aligned to alignment (a power of two)
+             */
+            void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+            /**
+             * @brief Constructs a T in the arena; its destructor runs on release()
+             */
+            template <typename T, typename... Args>
+            T* create(Args&&... args)
+            {
+                void* storage = allocate(sizeof(T), alignof(T));
+                T* object = ::new (storage) T(std::forward<Args>(args)...);
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                    onRelease([](void* p) { static_cast<T*>(p)->~T(); }, object);
+                return object;
+            }
+
+            /**
+             * @brief Takes ownership of a heap object, deleted on release()
+             *
+             * For objects made by code that cannot construct in place, such
+             * as plugins: they keep their own allocation but share the
+             * arena's lifetime instead of carrying a control block each.
+             */
+            template <typename T>
+            T* adopt(T* object)
+            {
+                if (object)
+                    onRelease([](void* p) { delete static_cast<T*>(p); }, object);
+                return object;
+            }
+
+            /**
+             * @brief Registers destroy(object) to run on release(), latest first
+             */
+            void onRelease(void (*destroy)(void*), void* object);
+
+            /**
+             * @brief Runs the pending destructors and frees every block
+             */
+            void release();
+
+            /**
+             * @brief Non-owning shared handle to an object of the arena
+             *
+             * The handle shares the arena's reference count, so the arena
+             * outlives every handle without a control block per object.
+             */
+            template <typename T>
+            static std::shared_ptr<T> handle(const std::shared_ptr<Arena>& arena, T* object)
+            {
+                return std::shared_ptr<T>(arena, object);
+            }
+
+            std::size_t bytesUsed() const;
+            std::size_t bytesReserved() const;
+            std::size_t objectCount() const;
+
+        private:
+            struct Cleanup {
+                void (*destroy)(void*);
+                void* object;
+                Cleanup* next;
+            };
+
+            void* allocateLocked(std::size_t size, std::size_t alignment);
+
+            mutable std::mutex _mutex;
+            std::vector<std::unique_ptr<std::byte[]>> _blocks;
+            std::byte* _cursor = nullptr;
+            std::byte* _end = nullptr;
+            std::size_t _nextBlockSize;
+            std::size_t _used = 0;
+            std::size_t _reserved = 0;
+            std::size_t _objects = 0;
+            Cleanup* _cleanups = nullptr;
+    };
+}
@@ -0,0 +1,92 @@
+/*
+** ByteStream - Native-endian serialization of plain values
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Utils {
+    /**
+     * @brief Appends trivially copyable values and strings to a buffer
+     */
+    class ByteWriter {
+        public:
+            template <typename T>
+            void put(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                const char* bytes = reinterpret_cast<const char*>(&value);
+                _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+            }
+
+            void putString(const std::string& value)
+            {
+                put<uint32_t>(static_cast<uint32_t>(value.size()));
+                _buffer.insert(_buffer.end(), value.begin(), value.end());
+            }
+
+            void putBytes(const void* data, std::size_t size)
+            {
+                const char* bytes = static_cast<const char*>(data);
+                _buffer.insert(_buffer.end(), bytes, bytes + size);
+            }
+
+            /**
+             * @brief Pads with zeros up to a multiple of alignment
+             */
+            void align(std::size_t alignment)
+            {
+                _buffer.resize((_buffer.size() + alignment - 1) / alignment * alignment, 0);
+            }
+
+            std::size_t size() const { return _buffer.size(); }
+            std::vector<char>& buffer() { return _buffer; }
+
+        private:
+            std::vector<char> _buffer;
+    };
+
+    /**
+     * @brief Reads back what a ByteWriter wrote, checking every bound
+     * @throw std::runtime_error when reading past the end
+     */
+    class ByteReader {
+        public:
+            ByteReader(const char* data, std::size_t size) : _p(data), _end(data + size) {}
+
+            template <typename T>
+            T get()
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                T value;
+                std::memcpy(&value, take(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            std::string getString()
+            {
+                uint32_t size = get<uint32_t>();
+                const char* bytes = take(size);
+                return std::string(bytes, size);
+            }
+
+        private:
+            const char* take(std::size_t size)
+            {
+                if (static_cast<std::size_t>(_end - _p) < size)
+                    throw std::runtime_error("Unexpected end of binary data");
+                const char* bytes = _p;
+                _p += size;
+                return bytes;
+            }
+
+            const char* _p;
+            const char* _end;
+    };
+}
@@ -61,7 +61,16 @@ class Color {
     
             // Float operations
             Float& operator+=(const Float& other);
+            Float operator+(const Float& other) const;
             Float operator*(float factor) const;
+            /**
+             * @brief Component-wise product, used to filter a light by a surface color
+             */
+            Float operator*(const Float& other) const;
+            /**
+             * @brief Relative luminance (Rec. 709 weights) of the color
+             */
+            float luminance() const;
                 /**
                  * @brief Converts a float color (0.0–1.0) to an integer-based Color (0–255)
                  */
@@ -0,0 +1,44 @@
+/*
+** Deflate - Minimal zlib-compatible compressor
+**
+** LZ77 with hash chains and the fixed Huffman tables of RFC 1951,
+** enough for PNG output without an external zlib dependency.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utils {
+    /**
+     * @brief CRC-32 (ISO-HDLC, as used by PNG chunks)
+     * @param crc Running value of a previous call, 0 to start
+     */
+    uint32_t crc32(const uint8_t* data, std::size_t size, uint32_t crc = 0);
+
+    /**
+     * @brief Adler-32 checksum (zlib trailer)
+     * @param adler Running value of a previous call, 1 to start
+     */
+    uint32_t adler32(const uint8_t* data, std::size_t size, uint32_t adler = 1);
+
+    /**
+     * @brief Adler-32 of the concatenation A + B from the checksums of A and B
+     * @param sizeB Length of B in bytes
+     */
+    uint32_t adler32Combine(uint32_t adlerA, uint32_t adlerB, std::size_t sizeB);
+
+    /**
+     * @brief Compresses data into raw deflate blocks
+     * @param last True to mark the final block; otherwise the output ends
+     *             with an empty stored block so that it is byte aligned and
+     *             can be followed by another deflate stream
+     */
+    std::vector<uint8_t> deflate(const uint8_t* data, std::size_t size, bool last = true);
+
+    /**
+     * @brief Compresses data into a complete zlib stream (header + deflate + adler)
+     */
+    std::vector<uint8_t> zlibCompress(const uint8_t* data, std::size_t size);
+}
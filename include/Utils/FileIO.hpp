@@ -0,0 +1,24 @@
+/*
+** FileIO - Whole-buffer file output and change detection
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Utils {
+    /**
+     * @brief Creates or truncates a file and writes a buffer in one system call
+     *
+     * Short writes are resumed until the whole buffer is out.
+     * @throw std::runtime_error if the file cannot be opened or written
+     */
+    void writeFile(const std::string& path, const void* data, std::size_t size);
+
+    /**
+     * @brief Cheap change signature of a file, from its size and modification time
+     * @return 0 if the file cannot be stat'ed
+     */
+    uint64_t fileSignature(const std::string& path);
+}
@@ -0,0 +1,48 @@
+/*
+** FileWatcher - Notifies when a file is rewritten, through inotify
+*/
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace Utils {
+    /**
+     * @brief Calls back on a background thread whenever a file changes
+     *
+     * The parent directory is watched rather than the file itself, so
+     * editors that save by writing a temporary file and renaming it over
+     * the original are seen too. Bursts of events are coalesced into one
+     * call once the file has been quiet for a short while.
+     */
+    class FileWatcher {
+        public:
+            using Callback = std::function<void()>;
+
+            /**
+             * @brief Starts watching path
+             * @param callback Runs on the watcher thread; must not destroy the watcher
+             * @throw std::runtime_error if the directory cannot be watched
+             */
+            FileWatcher(const std::string& path, Callback callback);
+
+            /**
+             * @brief Stops the watcher thread and waits for it
+             */
+            ~FileWatcher();
+
+            FileWatcher(const FileWatcher&) = delete;
+            FileWatcher& operator=(const FileWatcher&) = delete;
+
+        private:
+            void run();
+
+            std::string _name;          // file name inside the watched directory
+            Callback _callback;
+            int _fd = -1;
+            std::atomic<bool> _stop{false};
+            std::thread _thread;
+    };
+}
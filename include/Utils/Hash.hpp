@@ -0,0 +1,36 @@
+/*
+** Hash - Small non-cryptographic hashing helpers
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Utils {
+    constexpr uint64_t FnvOffsetBasis = 14695981039346656037ull;
+
+    /**
+     * @brief 64-bit FNV-1a of a byte range
+     * @param hash Running value of a previous call, FnvOffsetBasis to start
+     */
+    inline uint64_t fnv1a(const void* data, std::size_t size, uint64_t hash = FnvOffsetBasis)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Folds the object representation of a trivially copyable value
+     */
+    template <typename T>
+    uint64_t hashValue(const T& value, uint64_t hash = FnvOffsetBasis)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return fnv1a(&value, sizeof(T), hash);
+    }
+}
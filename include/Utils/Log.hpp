@@ -0,0 +1,58 @@
+/*
+** Log - Leveled diagnostics on stderr, errors only by default
+*/
+#pragma once
+
+#include <sstream>
+#include <string>
+
+namespace Utils::Log {
+    enum class Level { Off, Error, Warn, Info, Debug };
+
+    void setLevel(Level level);
+    Level level();
+
+    /**
+     * @brief Reads "off", "error", "warn", "info" or "debug"
+     * @return false, leaving level untouched, for any other name
+     */
+    bool parseLevel(const std::string& name, Level& level);
+
+    inline bool enabled(Level messageLevel)
+    {
+        return messageLevel != Level::Off && messageLevel <= level();
+    }
+
+    /**
+     * @brief Writes one whole line, so lines from several threads never interleave
+     */
+    void emit(Level messageLevel, const std::string& line);
+
+    /**
+     * @brief Formats and writes a line if its level is enabled
+     *
+     * Nothing is formatted for a disabled level, which keeps per-element
+     * debug messages cheap on large scenes.
+     */
+    template <typename... Args>
+    void write(Level messageLevel, const Args&... args)
+    {
+        if (!enabled(messageLevel))
+            return;
+        std::ostringstream line;
+        (line << ... << args);
+        emit(messageLevel, line.str());
+    }
+
+    template <typename... Args>
+    void error(const Args&... args) { write(Level::Error, args...); }
+
+    template <typename... Args>
+    void warn(const Args&... args) { write(Level::Warn, args...); }
+
+    template <typename... Args>
+    void info(const Args&... args) { write(Level::Info, args...); }
+
+    template <typename... Args>
+    void debug(const Args&... args) { write(Level::Debug, args...); }
+}
@@ -0,0 +1,45 @@
+/*
+** MappedFile - Read-only memory mapping of a whole file
+*/
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Utils {
+    /**
+     * @brief Maps a file read-only for the lifetime of the object
+     *
+     * Lets parsers scan the page cache directly instead of copying the
+     * file into std::string lines.
+     */
+    class MappedFile {
+        public:
+            /**
+             * @brief How the mapping will be read, passed on to madvise
+             */
+            enum class Access {
+                Sequential,     // one front-to-back scan, aggressive read-ahead
+                Random          // scattered lookups, no read-ahead
+            };
+
+            /**
+             * @brief Maps path; check isOpen() before use
+             */
+            explicit MappedFile(const std::string& path, Access access = Access::Sequential);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            bool isOpen() const { return _open; }
+            const char* data() const { return _data; }
+            const char* end() const { return _data + _size; }
+            std::size_t size() const { return _size; }
+
+        private:
+            bool _open = false;
+            const char* _data = nullptr;
+            std::size_t _size = 0;
+    };
+}
@@ -0,0 +1,123 @@
+/*
+** MeshFile - Binary .rtmesh mesh files, loaded by memory mapping
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Math/Point3D.hpp"
+#include "RayTracer/Mesh.hpp"
+#include "Utils/Color.hpp"
+#include "Utils/MappedFile.hpp"
+
+namespace Utils {
+    /**
+     * @brief Versioned binary mesh format laid out for direct mmap
+     *
+     * A 128-byte header is followed by the vertex (3 floats), index
+     * (3 uint32 per triangle), normal (3 floats), BVH node and texture
+     * coordinate (2 floats) arrays, each starting on a 64-byte boundary. Geometry is in model space and
+     * native byte order; placement is applied when the mesh is loaded.
+     * The BVH is optional and rebuilt at load time when absent.
+     */
+    class MeshFile {
+    public:
+        static constexpr const char* Extension = ".rtmesh";
+        static constexpr uint32_t Version = 1;
+        static constexpr uint32_t ByteOrderMark = 0x01020304;
+        static constexpr std::size_t SectionAlignment = 64;
+
+        struct Header {
+            char magic[8];              // "RTMESH\0\0"
+            uint32_t version;
+            uint32_t byteOrder;         // ByteOrderMark as written by the producer
+            uint64_t vertexCount;
+            uint64_t triangleCount;
+            uint64_t normalCount;       // 0 or vertexCount
+            uint64_t nodeCount;         // 0 when no BVH was stored
+            uint64_t vertexOffset;
+            uint64_t indexOffset;
+            uint64_t normalOffset;
+            uint64_t nodeOffset;
+            float boundsMin[3];
+            float boundsMax[3];
+            uint64_t uvCount;           // 0 or vertexCount
+            uint64_t uvOffset;
+            uint8_t reserved[8];
+        };
+
+        /**
+         * @brief True if path names a .rtmesh file
+         */
+        static bool isMeshFile(const std::string& path);
+
+        /**
+         * @brief Path of an up-to-date .rtmesh next to an OBJ file
+         *
+         * model.obj is served by model.rtmesh when the latter exists and is
+         * not older, which lets scenes keep listing the OBJ.
+         * @return The .rtmesh path, or an empty string
+         */
+        static std::string companionOf(const std::string& objPath);
+
+        /**
+         * @brief Reads the model-space bounds stored in the header
+         *
+         * Reads 128 bytes, without mapping the geometry.
+         * @return false if the file cannot be read or is not a .rtmesh
+         */
+        static bool bounds(const std::string& path, double min[3], double max[3]);
+
+        /**
+         * @brief Writes a mesh in model space, with its normals and texture coordinates
+         * @param withBVH Store the mesh BVH; the indices are in its leaf order either way
+         * @return Number of bytes written
+         * @throw std::runtime_error if the file cannot be written
+         */
+        static std::size_t write(const std::string& path, const RayTracer::Mesh& mesh, bool withBVH = true);
+
+        /**
+         * @brief Lays a mesh out as the bytes of a .rtmesh file
+         */
+        static std::vector<char> serialize(const RayTracer::Mesh& mesh, bool withBVH = true);
+
+        /**
+         * @brief Maps a .rtmesh file and wraps its arrays in a mesh
+         *
+         * The header, indices and BVH nodes are read to validate them;
+         * the vertex pages are faulted in by the first rays that reach them.
+         * @return The mesh, empty if the file cannot be opened
+         * @throw std::runtime_error if the file is not a valid .rtmesh
+         */
+        static std::shared_ptr<RayTracer::Mesh> load(
+            const std::string& path,
+            double scale = 1.0,
+            const Math::Point3D& position = Math::Point3D(0, 0, 0),
+            const Color& color = Color(255, 255, 255),
+            RayTracer::Mesh::Shading shading = RayTracer::Mesh::Shading::Auto
+        );
+
+        /**
+         * @brief Wraps a .rtmesh image stored inside a larger mapping
+         *
+         * @param file Mapping kept alive by the mesh
+         * @param offset Start of the image, a multiple of SectionAlignment
+         * @param size Bytes of the image
+         * @param path Name used in error messages
+         * @throw std::runtime_error if the image is not a valid .rtmesh
+         */
+        static std::shared_ptr<RayTracer::Mesh> load(
+            std::shared_ptr<const MappedFile> file,
+            std::size_t offset,
+            std::size_t size,
+            const std::string& path,
+            double scale,
+            const Math::Point3D& position,
+            const Color& color,
+            RayTracer::Mesh::Shading shading
+        );
+    };
+}
@@ -6,63 +6,217 @@
 */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 #include <memory>
 #include "Math/Point3D.hpp"
 #include "Math/Vector3D.hpp"
 #include "RayTracer/IPrimitive.hpp"
-#include "RayTracer/CompositePrimitive.hpp"
+#include "RayTracer/Mesh.hpp"
 #include "Utils/Color.hpp"
 
 namespace Utils {
+    /**
+     * @brief Geometry read from an OBJ file, before any primitive is built
+     */
+    struct ObjMeshData {
+        std::vector<float> positions;   // x, y, z per vertex, scaled and offset
+        std::vector<uint32_t> triangles; // 3 valid 0-based vertex indices per triangle
+        std::vector<float> normals;     // x, y, z per vertex from vn records, empty if none
+        std::vector<float> uvs;         // u, v per vertex from vt records, empty if none
+        std::size_t faces = 0;          // polygons read, before triangulation
+    };
+
     class ObjLoader {
     public:
         /**
-         * @brief Loads an OBJ file and converts it to a composite primitive
+         * @brief Loads an OBJ file and converts it to an indexed mesh
          *
          * @param objPath Path to the OBJ file
          * @param scale Scale factor to apply to the model
          * @param position Position offset to apply to the model
          * @param color Color to apply to the model
-         * @return std::shared_ptr<RayTracer::CompositePrimitive> Composite containing all triangles
+         * @param shading Source of the shading normals
+         * @return std::shared_ptr<RayTracer::Mesh> Mesh of all the faces, empty if the file cannot be read
          */
-        static std::shared_ptr<RayTracer::CompositePrimitive> load(
+        static std::shared_ptr<RayTracer::Mesh> load(
             const std::string& objPath,
             double scale = 1.0,
             const Math::Point3D& position = Math::Point3D(0, 0, 0),
-            const Color& color = Color(255, 255, 255)
+            const Color& color = Color(255, 255, 255),
+            RayTracer::Mesh::Shading shading = RayTracer::Mesh::Shading::Auto
+        );
+
+        /**
+         * @brief Reads the geometry of an OBJ file through a memory mapping
+         *
+         * @param objPath Path to the OBJ file
+         * @param out Receives the vertices and triangulated faces
+         * @param scale Scale factor to apply to the model
+         * @param position Position offset to apply to the model
+         * @return false if the file cannot be opened
+         */
+        static bool parse(
+            const std::string& objPath,
+            ObjMeshData& out,
+            double scale = 1.0,
+            const Math::Point3D& position = Math::Point3D(0, 0, 0)
+        );
+
+        /**
+         * @brief Bounds of the vertices of an OBJ file, without keeping them
+         *
+         * @param objPath Path to the OBJ file
+         * @param min Receives the lower corner, after scale and position
+         * @param max Receives the upper corner, after scale and position
+         * @return false if the file cannot be opened or has no vertex
+         */
+        static bool bounds(
+            const std::string& objPath,
+            double scale,
+            const Math::Point3D& position,
+            double min[3],
+            double max[3]
+        );
+
+        /**
+         * @brief Parses OBJ text held in memory
+         *
+         * Large inputs are cut at line boundaries into chunks parsed in
+         * parallel on the worker pool, then merged in file order.
+         * Negative (relative) face indices are supported. A position used
+         * with several vn/vt pairs is duplicated once per pair, so that
+         * normals and texture coordinates end up per vertex.
+         *
+         * @param begin First character of the text
+         * @param end One past the last character
+         * @param out Replaced by the vertices and triangulated faces
+         */
+        static void parse(
+            const char* begin,
+            const char* end,
+            ObjMeshData& out,
+            double scale,
+            const Math::Point3D& position
         );
 
     private:
+        static constexpr int NoAttribute = std::numeric_limits<int>::min();
+
+        /**
+         * @brief Result of parsing one slice of the file
+         *
+         * Indices are stored as if the slice started at vertex 0; the ones
+         * written relative (negative) are listed in relative so that the
+         * number of vertices before the slice can be added at merge time.
+         * Normal and texture indices of each corner follow the same rule;
+         * their arrays are only filled once the slice meets one.
+         */
+        struct Chunk {
+            std::vector<float> positions;
+            std::vector<float> normals;
+            std::vector<float> uvs;
+            std::vector<int> triangles;
+            std::vector<int> cornerNormals;     // per triangle corner, or NoAttribute
+            std::vector<int> cornerUVs;
+            std::vector<std::size_t> relative;  // slots of triangles to rebase
+            std::vector<std::size_t> relativeNormals;
+            std::vector<std::size_t> relativeUVs;
+            bool hasNormals = false;            // cornerNormals covers every triangle
+            bool hasUVs = false;
+            std::size_t faces = 0;
+        };
+
+        /**
+         * @brief One v/vt/vn reference of a face
+         */
+        struct Corner {
+            int position;
+            int uv;
+            int normal;
+            bool relativePosition;
+            bool relativeUV;
+            bool relativeNormal;
+        };
+
+        /**
+         * @brief Parse the lines of [begin, end), which holds whole lines
+         */
+        static void parseChunk(
+            const char* begin,
+            const char* end,
+            Chunk& out,
+            double scale,
+            const Math::Point3D& position
+        );
+
         /**
-         * @brief Parse vertex data from an OBJ file
+         * @brief Parse the coordinates following a 'v' tag
          *
-         * @param line Line from OBJ file starting with 'v'
-         * @param vertices Output vector of vertices
+         * @param p First character after the tag
+         * @param end End of the line
+         * @param out Chunk receiving the vertex
          * @param scale Scale factor to apply to the model
          * @param position Position offset to apply to the model
          */
         static void parseVertex(
-            const std::string& line,
-            std::vector<Math::Point3D>& vertices,
+            const char* p,
+            const char* end,
+            Chunk& out,
             double scale,
             const Math::Point3D& position
         );
 
         /**
-         * @brief Parse face data from an OBJ file
+         * @brief Parse the floats following a 'vn' or 'vt' tag
          *
-         * @param line Line from OBJ file starting with 'f'
-         * @param vertices Vector of parsed vertices
-         * @param composite Composite to add triangle faces to
-         * @param color Color to apply to faces
+         * @param p First character after the tag
+         * @param end End of the line
+         * @param out Receives the values
+         * @param required Values that must be present
+         * @param count Values stored, missing optional ones as 0
+         */
+        static void parseAttribute(
+            const char* p,
+            const char* end,
+            std::vector<float>& out,
+            int required,
+            int count
+        );
+
+        /**
+         * @brief Parse the vertex references following an 'f' tag
+         *
+         * @param p First character after the tag
+         * @param end End of the line
+         * @param out Chunk receiving the triangles of the face
+         * @param polygon Scratch buffer reused from face to face
          */
         static void parseFace(
-            const std::string& line,
-            const std::vector<Math::Point3D>& vertices,
-            std::shared_ptr<RayTracer::CompositePrimitive>& composite,
-            const Color& color
+            const char* p,
+            const char* end,
+            Chunk& out,
+            std::vector<Corner>& polygon
+        );
+
+        /**
+         * @brief Gives each position a single normal and texture coordinate
+         *
+         * @param out Mesh whose triangles index positions
+         * @param normals vn records, indexed by cornerNormals
+         * @param uvs vt records, indexed by cornerUVs
+         * @param cornerNormals Per triangle corner, or NoAttribute
+         * @param cornerUVs Per triangle corner, or NoAttribute
+         */
+        static void weldAttributes(
+            ObjMeshData& out,
+            const std::vector<float>& normals,
+            const std::vector<float>& uvs,
+            const std::vector<int>& cornerNormals,
+            const std::vector<int>& cornerUVs
         );
     };
 }
@@ -0,0 +1,55 @@
+/*
+** PNG - Building blocks of the PNG encoder
+**
+** Frames are encoded as independent strips of rows: each strip is
+** filtered without looking at the rows above it and deflated on its own,
+** so strips can be compressed concurrently and simply concatenated.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utils::PNG {
+    /**
+     * @brief Rows per strip when a whole frame is split for compression
+     */
+    constexpr int StripRows = 32;
+
+    /**
+     * @brief Filtered and deflated rows, ready to be concatenated
+     */
+    struct Strip {
+        std::vector<uint8_t> data;      ///< Raw deflate blocks, byte aligned
+        uint32_t adler = 1;             ///< Adler-32 of the filtered rows
+        std::size_t rawSize = 0;        ///< Length of the filtered rows
+    };
+
+    /**
+     * @brief Signature followed by the IHDR of an 8-bit RGB image
+     */
+    std::vector<uint8_t> header(int width, int height);
+
+    /**
+     * @brief Appends a length-prefixed, CRC-terminated chunk
+     */
+    void appendChunk(std::vector<uint8_t>& out, const char type[4],
+                     const uint8_t* data, std::size_t size);
+
+    /**
+     * @brief Filters then deflates rows of packed 8-bit RGB
+     * @param last True for the bottom strip, which closes the deflate stream
+     */
+    Strip compressStrip(const uint8_t* rgb, int width, int rows, bool last);
+
+    /**
+     * @brief zlib stream header preceding the first strip
+     */
+    constexpr uint8_t ZlibHeader[2] = {0x78, 0x01};
+
+    /**
+     * @brief Appends the big-endian zlib trailer for the combined checksum
+     */
+    void appendAdler(std::vector<uint8_t>& out, uint32_t adler);
+}
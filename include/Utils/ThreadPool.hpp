@@ -0,0 +1,73 @@
+/*
+** ThreadPool - Fixed-size pool of worker threads
+**
+** Long-lived workers shared by the renderer and the loaders so that
+** asynchronous jobs do not pay thread creation on every call.
+*/
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+    /**
+     * @brief Fixed-size pool running submitted tasks in FIFO order
+     */
+    class ThreadPool {
+        public:
+            using Task = std::function<void()>;
+
+            /**
+             * @brief Starts the worker threads
+             * @param threads Number of workers (0 means hardware concurrency)
+             */
+            explicit ThreadPool(std::size_t threads = 0);
+
+            /**
+             * @brief Drains the queue and joins every worker
+             */
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /**
+             * @brief Queues a task for execution on a worker
+             * @param task Callable to run; exceptions must be handled by the task
+             */
+            void submit(Task task);
+
+            /**
+             * @brief Runs body(i) for every i in [0, count) and waits for all
+             *
+             * The calling thread takes indices too, so this never waits on
+             * tasks queued behind it and is safe to call from a worker.
+             * The first exception thrown by body is rethrown at the end.
+             */
+            void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+            /**
+             * @brief Returns the number of worker threads
+             */
+            std::size_t size() const;
+
+            /**
+             * @brief Process-wide pool sized to the hardware concurrency
+             */
+            static ThreadPool& global();
+
+        private:
+            void workerLoop();
+
+            std::vector<std::thread> _workers;
+            std::queue<Task> _tasks;
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            bool _stopping = false;
+    };
+}
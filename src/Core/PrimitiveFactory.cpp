@@ -8,6 +8,16 @@
 #include "RayTracer/Plane.hpp"
 #include "RayTracer/Cone.hpp"
 #include "RayTracer/Cylinder.hpp"
+#include "Utils/FileIO.hpp"
+#include "Utils/Log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <utility>
+#include <unistd.h>
 
 Core::PrimitiveFactory::PrimitiveFactory()
 {
@@ -15,9 +25,87 @@ Core::PrimitiveFactory::PrimitiveFactory()
 
 Core::PrimitiveFactory::~PrimitiveFactory()
 {
-    for (auto& ph : _handles) {
-        if (ph.handle)
-            dlclose(ph.handle);
+    for (auto& [type, plugin] : _plugins)
+        dlclose(plugin.handle);
+    for (void* handle : _retired)
+        dlclose(handle);
+}
+
+namespace {
+    constexpr const char* ManifestHeader = "rtplugins 1";
+
+    /**
+     * @brief What a plugin file provides, as cached in the manifest
+     */
+    struct ManifestEntry {
+        uint64_t signature = 0;     // Utils::fileSignature() of the file
+        std::string type;           // empty if the file is not a usable plugin
+        std::string error;          // why, in that case
+    };
+
+    /**
+     * @brief Reads a manifest, keyed by file name; empty if missing or unreadable
+     */
+    std::map<std::string, ManifestEntry> readManifest(const std::string& path)
+    {
+        std::map<std::string, ManifestEntry> entries;
+        std::ifstream in(path);
+        std::string line;
+        if (!std::getline(in, line) || line != ManifestHeader)
+            return entries;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string signature;
+            std::string file;
+            ManifestEntry entry;
+            if (!std::getline(fields, signature, '\t') || !std::getline(fields, file, '\t')
+                || !std::getline(fields, entry.type, '\t'))
+                continue;
+            std::getline(fields, entry.error);
+            const char* end = signature.data() + signature.size();
+            if (std::from_chars(signature.data(), end, entry.signature, 16).ptr != end)
+                continue;
+            entries[file] = std::move(entry);
+        }
+        return entries;
+    }
+
+    void writeManifest(const std::string& path, const std::map<std::string, ManifestEntry>& entries)
+    {
+        std::ostringstream out;
+        out << ManifestHeader << '\n';
+        for (const auto& [file, entry] : entries) {
+            std::string error = entry.error;
+            std::replace_if(error.begin(), error.end(), [](char c) { return c == '\t' || c == '\n'; }, ' ');
+            out << std::hex << entry.signature << '\t' << file << '\t' << entry.type << '\t' << error << '\n';
+        }
+        // Written aside and renamed, so a concurrent start never reads half of it
+        const std::string text = out.str();
+        const std::string temporary = path + ".tmp";
+        Utils::writeFile(temporary, text.data(), text.size());
+        std::filesystem::rename(temporary, path);
+    }
+
+    /**
+     * @brief Opens a plugin just long enough to read its type
+     */
+    ManifestEntry probe(const std::string& path, uint64_t signature)
+    {
+        ManifestEntry entry;
+        entry.signature = signature;
+        void* h = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+        if (!h) {
+            entry.error = dlerror();
+            return entry;
+        }
+        auto getName = reinterpret_cast<Core::PluginABI::GetTypeFn*>(dlsym(h, "getType"));
+        const char* name = getName ? getName() : nullptr;
+        if (name && *name)
+            entry.type = name;
+        else
+            entry.error = getName ? "getType returned no name" : "missing symbol getType";
+        dlclose(h);
+        return entry;
     }
 }
 
@@ -28,34 +116,221 @@ void Core::PrimitiveFactory::loadPlugins(const std::string& pluginsDir)
         throw PluginLoadException(pluginsDir, "not or no a directory");
     }
 
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (std::find(_dirs.begin(), _dirs.end(), pluginsDir) == _dirs.end())
+        _dirs.push_back(pluginsDir);
+    index(pluginsDir);
+}
+
+void Core::PrimitiveFactory::index(const std::string& pluginsDir)
+{
+    std::vector<std::filesystem::path> files;
     for (auto& entry : std::filesystem::directory_iterator(pluginsDir)) {
-        if (entry.path().extension() != ".so") continue;
+        if (entry.path().extension() == ".so")
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
 
-        std::string path = entry.path().string();
-        void* h = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
-        if (!h) {
-            throw PluginLoadException(path, dlerror());
+    const std::string manifestPath = (std::filesystem::path(pluginsDir) / ManifestName).string();
+    const auto cached = readManifest(manifestPath);
+    std::map<std::string, ManifestEntry> manifest;
+    std::size_t probed = 0;
+    for (const auto& file : files) {
+        const std::string path = file.string();
+        const std::string name = file.filename().string();
+        const uint64_t signature = Utils::fileSignature(path);
+        auto it = cached.find(name);
+        ManifestEntry entry;
+        if (it != cached.end() && signature != 0 && it->second.signature == signature) {
+            entry = it->second;
+        } else {
+            entry = probe(path, signature);
+            ++probed;
         }
 
-        using NameFn   = const char*();
-        using CreateFnC= RayTracer::IPrimitive*(const PrimitiveConfig&);
-        auto getName = reinterpret_cast<NameFn*>(dlsym(h, "getType"));
-        auto create  = reinterpret_cast<CreateFnC*>(dlsym(h, "createPrimitive"));
-        if (!getName || !create) {
+        if (entry.type.empty())
+            Utils::Log::warn("[Plugin] Skipping ", path, ": ", entry.error);
+        else if (auto [indexed, added] = _index.emplace(entry.type, path); !added && indexed->second != path)
+            Utils::Log::warn("[Plugin] Skipping ", path, ": \"", entry.type, "\" is already provided by ", indexed->second);
+        manifest.emplace(name, std::move(entry));
+    }
+
+    if (probed > 0 || manifest.size() != cached.size()) {
+        try {
+            writeManifest(manifestPath, manifest);
+        } catch (const std::exception& e) {
+            Utils::Log::debug("[Plugin] Cannot cache the plugin index: ", e.what());
+        }
+    }
+    Utils::Log::info("[Plugin] Indexed ", manifest.size(), " plugins from ", pluginsDir, " (", probed, " opened)");
+}
+
+Core::PrimitiveFactory::Plugin Core::PrimitiveFactory::open(
+        const std::string& path,
+        const std::string& type,
+        bool privateCopy)
+{
+    const uint64_t signature = Utils::fileSignature(path);
+    void* h = nullptr;
+    if (privateCopy) {
+        // A name the loader has never seen; unlinked once mapped
+        static std::atomic<unsigned> copies{0};
+        const auto copy = std::filesystem::temp_directory_path() / ("raytracer-" + std::to_string(::getpid())
+            + "-" + std::to_string(++copies) + "-" + std::filesystem::path(path).filename().string());
+        std::error_code error;
+        if (!std::filesystem::copy_file(path, copy, std::filesystem::copy_options::overwrite_existing, error))
+            throw PluginLoadException(path, "cannot copy to " + copy.string() + ": " + error.message());
+        h = dlopen(copy.c_str(), RTLD_LAZY | RTLD_LOCAL);
+        std::filesystem::remove(copy, error);
+    } else {
+        h = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+    }
+    if (!h) {
+        throw PluginLoadException(path, dlerror());
+    }
+
+    auto getName = reinterpret_cast<PluginABI::GetTypeFn*>(dlsym(h, "getType"));
+    auto getVersion = reinterpret_cast<PluginABI::GetAbiVersionFn*>(dlsym(h, "getAbiVersion"));
+    const unsigned version = getVersion ? getVersion() : 1;
+    if (!getName || version == 0 || version > PluginABI::Version) {
+        dlclose(h);
+        throw PluginLoadException(path, getName
+            ? "unsupported plugin ABI version " + std::to_string(version)
+            : "missing symbol getType");
+    }
+    if (const char* name = getName(); !name || type != name) {
+        dlclose(h);
+        throw PluginLoadException(path, "no longer provides \"" + type + "\"");
+    }
+
+    Plugin plugin;
+    plugin.handle = h;
+    plugin.signature = signature;
+    plugin.create = reinterpret_cast<PluginABI::CreatePrimitiveFn*>(dlsym(h, "createPrimitive"));
+    if (version >= 2) {
+        auto getLayout = reinterpret_cast<PluginABI::GetLayoutFn*>(dlsym(h, "getPrimitiveLayout"));
+        plugin.createBatch = reinterpret_cast<PluginABI::CreatePrimitivesFn*>(dlsym(h, "createPrimitives"));
+        if (getLayout)
+            plugin.layout = getLayout();
+        const std::size_t align = plugin.layout.alignment;
+        if (!getLayout || !plugin.createBatch || plugin.layout.size == 0
+            || align == 0 || (align & (align - 1)) != 0) {
             dlclose(h);
-            throw PluginLoadException(
-                path,
-                "missing symbol getPrimitiveName or createPrimitive"
-            );
+            throw PluginLoadException(path, "missing or invalid getPrimitiveLayout or createPrimitives");
+        }
+        auto getCapabilities = reinterpret_cast<PluginABI::GetCapabilitiesFn*>(dlsym(h, "getCapabilities"));
+        const unsigned capabilities = getCapabilities ? getCapabilities() : 0;
+        if (capabilities & PluginABI::Bounds)
+            plugin.kernels.bounds = reinterpret_cast<PluginABI::BoundsFn*>(dlsym(h, "primitiveBounds"));
+        if (capabilities & PluginABI::IntersectBatch)
+            plugin.kernels.intersectBatch = reinterpret_cast<PluginABI::IntersectBatchFn*>(dlsym(h, "intersectBatch"));
+        if (((capabilities & PluginABI::Bounds) && !plugin.kernels.bounds)
+            || ((capabilities & PluginABI::IntersectBatch) && !plugin.kernels.intersectBatch)) {
+            dlclose(h);
+            throw PluginLoadException(path, "missing primitiveBounds or intersectBatch for a declared capability");
+        }
+    } else if (!plugin.create) {
+        dlclose(h);
+        throw PluginLoadException(path, "missing symbol createPrimitive");
+    }
+
+    Utils::Log::info("[Plugin] Loaded \"", type, "\" (ABI v", version, ") from ", path);
+    return plugin;
+}
+
+const Core::PrimitiveFactory::Plugin* Core::PrimitiveFactory::plugin(const std::string& type) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto loaded = _plugins.find(type); loaded != _plugins.end())
+        return &loaded->second;
+    auto indexed = _index.find(type);
+    if (indexed == _index.end())
+        return nullptr;
+    if (auto failed = _failed.find(type); failed != _failed.end())
+        throw failed->second;
+    try {
+        return &_plugins.emplace(type, open(indexed->second, type)).first->second;
+    } catch (const PluginLoadException& e) {
+        _failed.emplace(type, e);
+        throw;
+    }
+}
+
+Core::PrimitiveFactory::PluginReload Core::PrimitiveFactory::reloadPlugins(const RecreateFn& recreate)
+{
+    PluginReload reload;
+    std::vector<std::pair<Plugin*, Plugin>> replaced;   // installed plugin, the one it replaced
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _index.clear();
+        _failed.clear();
+        for (const auto& dir : _dirs)
+            index(dir);
+
+        for (auto& [type, plugin] : _plugins) {
+            auto indexed = _index.find(type);
+            if (indexed == _index.end() || Utils::fileSignature(indexed->second) == plugin.signature)
+                continue;
+            try {
+                Plugin fresh = open(indexed->second, type, true);
+                replaced.emplace_back(&plugin, plugin);
+                plugin = fresh;
+                reload.types.push_back(type);
+            } catch (const PluginLoadException& e) {
+                Utils::Log::error("[Plugin] Keeping the loaded \"", type, "\": ", e.what());
+                reload.failures.push_back(e.what());
+            }
         }
+    }
 
-        std::string name = getName();
-        _creators[name] = [create](const PrimitiveConfig& cfg){
-            return std::shared_ptr<RayTracer::IPrimitive>( create(cfg) );
-        };
-        _handles.push_back({h});
-        std::cout << "[Plugin] Loaded \"" << name << "\" from " << path << "\n";
+    // Unlocked, recreate goes through create()
+    try {
+        if (recreate && !reload.types.empty())
+            recreate(reload);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& [plugin, previous] : replaced) {
+            // Primitives may have been created before the failure
+            _retired.push_back(plugin->handle);
+            *plugin = previous;
+        }
+        Utils::Log::error("[Plugin] Primitives could not be re-created, previous plugins restored");
+        throw;
     }
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& [plugin, previous] : replaced)
+        _retired.push_back(previous.handle);
+    return reload;
+}
+
+std::size_t Core::PrimitiveFactory::loadedPluginCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _plugins.size();
+}
+
+std::shared_ptr<RayTracer::IPrimitive> Core::PrimitiveFactory::createOwned(
+        const Plugin& plugin,
+        const PrimitiveConfig& cfg)
+{
+    if (plugin.create)
+        return std::shared_ptr<RayTracer::IPrimitive>(plugin.create(cfg));
+
+    // Version 2 only: a batch of one in its own aligned allocation
+    const auto align = static_cast<std::align_val_t>(plugin.layout.alignment);
+    void* storage = ::operator new(plugin.layout.size, align);
+    const PrimitiveConfig* configs[] = {&cfg};
+    RayTracer::IPrimitive* object = nullptr;
+    try {
+        plugin.createBatch(configs, 1, storage, &object);
+    } catch (...) {
+        ::operator delete(storage, align);
+        throw;
+    }
+    return std::shared_ptr<RayTracer::IPrimitive>(object, [storage, align](RayTracer::IPrimitive* p) {
+        p->~IPrimitive();
+        ::operator delete(storage, align);
+    });
 }
 
 void Core::PrimitiveFactory::registerType(const std::string& name, CreateFn fn)
@@ -68,7 +343,82 @@ std::shared_ptr<RayTracer::IPrimitive> Core::PrimitiveFactory::create(
         const PrimitiveConfig& cfg) const
 {
     auto it = _creators.find(type);
-    if (it == _creators.end())
+    if (it != _creators.end())
+        return it->second(cfg);
+    const Plugin* loaded = plugin(type);
+    if (!loaded)
+        throw UnknownPrimitiveTypeException(type);
+    return createOwned(*loaded, cfg);
+}
+
+std::shared_ptr<RayTracer::IPrimitive> Core::PrimitiveFactory::create(
+        const std::string& type,
+        const PrimitiveConfig& cfg,
+        const std::shared_ptr<Utils::Arena>& arena) const
+{
+    if (_creators.count(type))
+        return create(type, cfg);
+    const Plugin* loaded = plugin(type);
+    if (!loaded)
         throw UnknownPrimitiveTypeException(type);
-    return it->second(cfg);
+    if (loaded->createBatch) {
+        std::shared_ptr<RayTracer::IPrimitive> handle;
+        const PrimitiveConfig* configs[] = {&cfg};
+        create(type, configs, 1, arena, &handle);
+        return handle;
+    }
+    return Utils::Arena::handle(arena, arena->adopt(loaded->create(cfg)));
+}
+
+namespace {
+    /**
+     * @brief Primitives of one batch, destroyed in place with the arena
+     */
+    struct PlacedBatch {
+        RayTracer::IPrimitive** objects;
+        std::size_t count;
+
+        static void destroy(void* p)
+        {
+            auto* batch = static_cast<PlacedBatch*>(p);
+            for (std::size_t i = batch->count; i-- > 0;)
+                batch->objects[i]->~IPrimitive();
+        }
+    };
+}
+
+void Core::PrimitiveFactory::create(
+        const std::string& type,
+        const PrimitiveConfig* const* configs,
+        std::size_t count,
+        const std::shared_ptr<Utils::Arena>& arena,
+        std::shared_ptr<RayTracer::IPrimitive>* out) const
+{
+    if (count == 0)
+        return;
+    const Plugin* loaded = _creators.count(type) ? nullptr : plugin(type);
+    if (!loaded || !loaded->createBatch) {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = create(type, *configs[i], arena);
+        return;
+    }
+
+    const Plugin& plugin = *loaded;
+    void* storage = arena->allocate(plugin.layout.size * count, plugin.layout.alignment);
+    auto** objects = static_cast<RayTracer::IPrimitive**>(
+        arena->allocate(count * sizeof(RayTracer::IPrimitive*), alignof(RayTracer::IPrimitive*)));
+    plugin.createBatch(configs, count, storage, objects);
+    arena->onRelease(&PlacedBatch::destroy, arena->create<PlacedBatch>(PlacedBatch{objects, count}));
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = Utils::Arena::handle(arena, objects[i]);
+}
+
+const Core::PluginABI::Kernels* Core::PrimitiveFactory::kernels(const std::string& type) const
+{
+    if (_creators.count(type))
+        return nullptr;
+    const Plugin* loaded = plugin(type);
+    if (!loaded || (!loaded->kernels.bounds && !loaded->kernels.intersectBatch))
+        return nullptr;
+    return &loaded->kernels;
 }
@@ -10,29 +10,59 @@
 #include "Utils/Color.hpp"
 #include "Core/PrimitiveConfig.hpp"
 #include "RayTracer/PointLight.hpp"
+#include "RayTracer/MeshProxy.hpp"
+#include "Utils/MeshFile.hpp"
 #include "Utils/ObjLoader.hpp"
+#include "Utils/Hash.hpp"
+#include "Utils/ByteStream.hpp"
+#include "Utils/MappedFile.hpp"
+#include "Utils/FileIO.hpp"
+#include "Utils/Log.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <unordered_map>
 #include <iostream>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <cmath>
 
-Scene::Scene(Core::PrimitiveFactory &fac) : _factory(fac)
+Scene::Scene(Core::PrimitiveFactory &fac)
+    : _factory(fac), _meshCache(std::make_shared<RayTracer::MeshCache>()),
+      _arena(std::make_shared<Utils::Arena>())
 {}
 
 Scene::~Scene() {}
 
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Plugin primitives are cheap to create: batch them per pool task
+    constexpr std::size_t ConfigsPerTask = 256;
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    uint64_t hashFileContent(const std::string& path)
+    {
+        std::ifstream source(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+        return Utils::fnv1a(bytes.data(), bytes.size());
+    }
+}
+
 double deg2rad (double d)
 {
     return d*M_PI/180.0;
 }
 
-void Scene::loadFromFile(const std::string& path) {
-    Parser::Parser parser;
-
-    if (!parser.loadFromFile(path)) {
-        throw std::runtime_error(parser.getErrorMessage());
-    }
-
-    const auto& parsedCameras = parser.getCameras();
-    for (const auto& parsedCam : parsedCameras) {
+namespace {
+    std::shared_ptr<RayTracer::Camera> makeCamera(const Parser::Camera& parsedCam)
+    {
         auto camera = std::make_shared<RayTracer::Camera>();
 
         double aspect = double(parsedCam.resolution.width)
@@ -81,175 +111,224 @@ void Scene::loadFromFile(const std::string& path) {
         camera->_width  = parsedCam.resolution.width;
         camera->_height = parsedCam.resolution.height;
         camera->_screen = Math::Rectangle3D(origin3D, bottomSide, leftSide);
-
-        cameras.push_back(camera);
-        cameraMap[parsedCam.name] = camera;
+        return camera;
     }
 
-    const auto& parsedSpheres = parser.getSpheres();
-    for (const auto& ps : parsedSpheres) {
-        PrimitiveConfig cfg;
-        cfg.type  = "sphere";
-        cfg.color = Color(ps.color.r, ps.color.g, ps.color.b);
-        cfg.data.emplace<SphereData_t>(SphereData_t{
-        Math::Point3D{ps.position.x, ps.position.y, ps.position.z},
-        ps.radius});
-        auto sphere = _factory.create(cfg.type, cfg);
-        primitives.push_back(std::move(sphere));
-    }
+    /**
+     * @brief Plugin primitive configurations of a parsed scene, in scene order
+     */
+    std::vector<PrimitiveConfig> primitiveConfigs(const Parser::Parser& parser)
+    {
+        std::vector<PrimitiveConfig> configs;
+        const auto& parsedSpheres = parser.getSpheres();
+        for (const auto& ps : parsedSpheres) {
+            PrimitiveConfig cfg;
+            cfg.type  = "sphere";
+            cfg.color = Color(ps.color.r, ps.color.g, ps.color.b);
+            cfg.data.emplace<SphereData_t>(SphereData_t{
+            Math::Point3D{ps.position.x, ps.position.y, ps.position.z},
+            ps.radius});
+            configs.push_back(cfg);
+        }
 
-    const auto& parsedPlanes = parser.getPlanes();
-    for (const auto& pp : parsedPlanes) {
-        PrimitiveConfig cfg;
-        cfg.type  = "plane";
-        cfg.color = Color(pp.color.r, pp.color.g, pp.color.b);
+        const auto& parsedPlanes = parser.getPlanes();
+        for (const auto& pp : parsedPlanes) {
+            PrimitiveConfig cfg;
+            cfg.type  = "plane";
+            cfg.color = Color(pp.color.r, pp.color.g, pp.color.b);
 
-        PlaneData_t pd;
-        if (pp.axis == "X") {
-            pd.norm   = Math::Vector3D(1, 0, 0);
-            pd.pos = Math::Point3D(pp.position, 0, 0);
+            PlaneData_t pd;
+            if (pp.axis == "X") {
+                pd.norm   = Math::Vector3D(1, 0, 0);
+                pd.pos = Math::Point3D(pp.position, 0, 0);
+            }
+            else if (pp.axis == "Y") {
+                pd.norm   = Math::Vector3D(0, 1, 0);
+                pd.pos = Math::Point3D(0, pp.position, 0);
+            }
+            else {
+                pd.norm   = Math::Vector3D(0, 0, 1);
+                pd.pos= Math::Point3D(0, 0, pp.position);
+            }
+            cfg.data.emplace<PlaneData_t>(pd);
+            configs.push_back(cfg);
         }
-        else if (pp.axis == "Y") {
-            pd.norm   = Math::Vector3D(0, 1, 0);
-            pd.pos = Math::Point3D(0, pp.position, 0);
+
+        const auto& parsedCones = parser.getCones();
+        for (const auto& pc : parsedCones) {
+            PrimitiveConfig cfg;
+            cfg.type  = "cone";
+            cfg.color = Color(pc.color.r, pc.color.g, pc.color.b);
+
+            cfg.data.emplace<ConeData_t>(ConeData_t{
+                Math::Point3D{ pc.apex.x, pc.apex.y, pc.apex.z },
+                Math::Vector3D{ pc.axis.x, pc.axis.y, pc.axis.z },
+                pc.radius,
+                pc.height
+            });
+            configs.push_back(cfg);
         }
-        else {
-            pd.norm   = Math::Vector3D(0, 0, 1);
-            pd.pos= Math::Point3D(0, 0, pp.position);
+
+        const auto& parsedCylinders = parser.getCylinders();
+        for (const auto& cyl : parsedCylinders) {
+            PrimitiveConfig cfg;
+            cfg.type  = "cylinder";
+            cfg.color = Color(cyl.color.r, cyl.color.g, cyl.color.b);
+
+            cfg.data.emplace<CylinderData_t>(CylinderData_t{
+                Math::Point3D{ cyl.baseCenter.x, cyl.baseCenter.y, cyl.baseCenter.z },
+                Math::Vector3D{ cyl.axis.x, cyl.axis.y, cyl.axis.z },
+                cyl.radius,
+                cyl.height
+            });
+            configs.push_back(cfg);
         }
-        cfg.data.emplace<PlaneData_t>(pd);
-        auto plane = _factory.create(cfg.type, cfg);
-        primitives.push_back(std::move(plane));
-    }
 
-    const auto& parsedCones = parser.getCones();
-    for (const auto& pc : parsedCones) {
-        PrimitiveConfig cfg;
-        cfg.type  = "cone";
-        cfg.color = Color(pc.color.r, pc.color.g, pc.color.b);
+        const auto& parsedTriangles = parser.getTriangles();
+        Utils::Log::debug("Building ", parsedTriangles.size(), " triangles");
+        for (const auto& pt : parsedTriangles) {
+            PrimitiveConfig cfg;
+            cfg.type  = "triangle";
+            cfg.color = Color(pt.color.r, pt.color.g, pt.color.b);
 
-        cfg.data.emplace<ConeData_t>(ConeData_t{
-            Math::Point3D{ pc.apex.x, pc.apex.y, pc.apex.z },
-            Math::Vector3D{ pc.axis.x, pc.axis.y, pc.axis.z },
-            pc.radius,
-            pc.height
-        });
-        auto cone = _factory.create(cfg.type, cfg);
-        primitives.push_back(std::move(cone));
-    }
+            cfg.data.emplace<TriangleData_t>(TriangleData_t{
+                // sommets a, b, c
+                Math::Point3D{ pt.a.x, pt.a.y, pt.a.z },
+                Math::Point3D{ pt.b.x, pt.b.y, pt.b.z },
+                Math::Point3D{ pt.c.x, pt.c.y, pt.c.z }
+            });
 
-    const auto& parsedCylinders = parser.getCylinders();
-    for (const auto& cyl : parsedCylinders) {
-        PrimitiveConfig cfg;
-        cfg.type  = "cylinder";
-        cfg.color = Color(cyl.color.r, cyl.color.g, cyl.color.b);
-
-        cfg.data.emplace<CylinderData_t>(CylinderData_t{
-            Math::Point3D{ cyl.baseCenter.x, cyl.baseCenter.y, cyl.baseCenter.z },
-            Math::Vector3D{ cyl.axis.x, cyl.axis.y, cyl.axis.z },
-            cyl.radius,
-            cyl.height
-        });
-        auto cylinder = _factory.create(cfg.type, cfg);
-        primitives.push_back(std::move(cylinder));
-    }
-
-    std::cout << "les triangles c'est ici" << std::endl;
-    const auto& parsedTriangles = parser.getTriangles();
-    for (const auto& pt : parsedTriangles) {
-        PrimitiveConfig cfg;
-        cfg.type  = "triangle";
-        cfg.color = Color(pt.color.r, pt.color.g, pt.color.b);
+            configs.push_back(cfg);
+        }
+
+        const auto& parsedRectangles = parser.getRectangles();
+        for (const auto& pr : parsedRectangles) {
+            PrimitiveConfig cfg;
+            cfg.type  = "rectangle";
+            cfg.color = Color(pr.color.r, pr.color.g, pr.color.b);
 
-        cfg.data.emplace<TriangleData_t>(TriangleData_t{
-            // sommets a, b, c
-            Math::Point3D{ pt.a.x, pt.a.y, pt.a.z },
-            Math::Point3D{ pt.b.x, pt.b.y, pt.b.z },
-            Math::Point3D{ pt.c.x, pt.c.y, pt.c.z }
-        });
+            cfg.data.emplace<RectangleData_t>(RectangleData_t{
+                // origine
+                Math::Point3D{ pr.origin.x, pr.origin.y, pr.origin.z },
+                // bottom
+                Math::Vector3D{ pr.bottom.x, pr.bottom.y, pr.bottom.z },
+                // left
+                Math::Vector3D{ pr.left.x,   pr.left.y,   pr.left.z }
+            });
 
-        auto triangle = _factory.create(cfg.type, cfg);
-        primitives.push_back(std::move(triangle));
-        std::cout << "triangles build" << std::endl;
+            configs.push_back(cfg);
+        }
+        return configs;
     }
 
-    const auto& parsedRectangles = parser.getRectangles();
-    for (const auto& pr : parsedRectangles) {
-        PrimitiveConfig cfg;
-        cfg.type  = "rectangle";
-        cfg.color = Color(pr.color.r, pr.color.g, pr.color.b);
-
-        cfg.data.emplace<RectangleData_t>(RectangleData_t{
-            // origine
-            Math::Point3D{ pr.origin.x, pr.origin.y, pr.origin.z },
-            // bottom
-            Math::Vector3D{ pr.bottom.x, pr.bottom.y, pr.bottom.z },
-            // left
-            Math::Vector3D{ pr.left.x,   pr.left.y,   pr.left.z }
-        });
-
-        auto rect = _factory.create(cfg.type, cfg);
-        primitives.push_back(std::move(rect));
-    }
-
-    const auto& parsedObjFiles = parser.getObjFiles();
-    for (const auto& parsedObj : parsedObjFiles) {
-        Color objColor(parsedObj.color.r, parsedObj.color.g, parsedObj.color.b);
-        Math::Point3D objPosition(parsedObj.position.x, parsedObj.position.y, parsedObj.position.z);
-
-        auto objModel = Utils::ObjLoader::load(
-            parsedObj.path,
-            parsedObj.scale,
-            objPosition,
-            objColor
-        );
+    std::vector<std::shared_ptr<RayTracer::ILight>> makeLights(const Parser::Lights& parsedLights)
+    {
+        std::vector<std::shared_ptr<RayTracer::ILight>> lights;
+        if (parsedLights.ambient > 0) {
+            auto ambientLight = std::make_shared<RayTracer::AmbientLight>(
+                parsedLights.ambient
+            );
+            lights.push_back(ambientLight);
+        }
+
+        for (const auto& dir : parsedLights.directional) {
+            auto dirLight = std::make_shared<RayTracer::DirectionalLight>(
+                Math::Vector3D(dir.x, dir.y, dir.z)
+                //,
+                //parsedLights.diffuse
+            );
+            lights.push_back(dirLight);
+        }
 
-        primitives.push_back(objModel);
+        for (const auto& point : parsedLights.point) {
+            auto pointLight = std::make_shared<RayTracer::PointLight>(
+                Math::Point3D(point.x, point.y, point.z),
+                Color(255,255,255), 1.0
+            );
+            lights.push_back(pointLight);
+        }
+        return lights;
     }
 
-    const auto& parsedLights = parser.getLights();
+    RayTracer::Mesh::Shading parseShading(const std::string& name, const std::string& objPath)
+    {
+        if (name == "auto")
+            return RayTracer::Mesh::Shading::Auto;
+        if (name == "flat")
+            return RayTracer::Mesh::Shading::Flat;
+        if (name == "smooth")
+            return RayTracer::Mesh::Shading::Smooth;
+        throw std::runtime_error("Unknown shading \"" + name + "\" for " + objPath);
+    }
 
-    if (parsedLights.ambient > 0) {
-        auto ambientLight = std::make_shared<RayTracer::AmbientLight>(
-            parsedLights.ambient
-        );
-        lights.push_back(ambientLight);
+    // Binary meshes, listed directly or cached next to the OBJ, skip parsing
+    std::string meshSource(const std::string& entry)
+    {
+        if (Utils::MeshFile::isMeshFile(entry))
+            return entry;
+        std::string companion = Utils::MeshFile::companionOf(entry);
+        return companion.empty() ? entry : companion;
     }
+}
 
-    for (const auto& dir : parsedLights.directional) {
-        auto dirLight = std::make_shared<RayTracer::DirectionalLight>(
-            Math::Vector3D(dir.x, dir.y, dir.z)
-            //,
-            //parsedLights.diffuse
-        );
-        lights.push_back(dirLight);
+void Scene::loadFromFile(const std::string& path) {
+    Parser::Parser parser;
+    _loadTimings = LoadTimings();
+
+    auto phase = Clock::now();
+    if (!parser.loadFromFile(path)) {
+        throw std::runtime_error(parser.getErrorMessage());
     }
+    _loadTimings.parse = secondsSince(phase);
+    phase = Clock::now();
 
-    for (const auto& point : parsedLights.point) {
-        auto pointLight = std::make_shared<RayTracer::PointLight>(
-            Math::Point3D(point.x, point.y, point.z),
-            Color(255,255,255), 1.0
-        );
-        lights.push_back(pointLight);
+    _sourceHash = hashFileContent(path);
+    _sourcePath = path;
+    _sources.push_back({path, Source::Content, _sourceHash});
+
+    for (const auto& parsedCam : parser.getCameras()) {
+        auto camera = makeCamera(parsedCam);
+        cameras.push_back(camera);
+        cameraMap[parsedCam.name] = camera;
     }
 
-    std::cout << "Scene loaded successfully:" << std::endl;
-    std::cout << "  - " << cameras.size() << " cameras" << std::endl;
-    std::cout << "  - " << primitives.size() << " primitives" << std::endl;
+    const std::vector<PrimitiveConfig> configs = primitiveConfigs(parser);
+    Construction work;
+    for (const auto& cfg : configs)
+        work.configs.push_back(&cfg);
+    for (const auto& parsedObj : parser.getObjFiles())
+        work.objFiles.push_back(&parsedObj);
+    construct(work);
 
-    int sphereCount = parser.getSpheres().size();
-    int planeCount = parser.getPlanes().size();
-    int coneCount = parser.getCones().size();
-    int cylinderCount = parser.getCylinders().size();
-    int objCount = parser.getObjFiles().size();
+    for (std::size_t i = 0; i < configs.size(); ++i) {
+        _primitives.push_back(work.primitives[i]);
+        _builds.push_back({configs[i], -1});
+    }
+    for (auto& record : work.meshes)
+        addMesh(std::move(record));
+
+    auto parsedLights = makeLights(parser.getLights());
+    lights.insert(lights.end(), parsedLights.begin(), parsedLights.end());
 
-    std::cout << " (" << sphereCount << " spheres, "
-              << planeCount << " planes, "
-              << coneCount << " cones, "
-              << cylinderCount << " cylinders, "
-              << objCount << " obj models)" << std::endl;
+    auto accelStart = Clock::now();
+    buildAccel();
+    _loadTimings.build = secondsSince(phase);
+    _loadTimings.obj = work.objSeconds - work.accelSeconds;
+    _loadTimings.accel = work.accelSeconds + secondsSince(accelStart);
 
-    std::cout << "  - " << lights.size() << " lights" << std::endl;
+    Utils::Log::info("Scene loaded: ", cameras.size(), " cameras, ",
+                     _primitives.size(), " primitives (",
+                     parser.getSpheres().size(), " spheres, ",
+                     parser.getPlanes().size(), " planes, ",
+                     parser.getCones().size(), " cones, ",
+                     parser.getCylinders().size(), " cylinders, ",
+                     parser.getObjFiles().size(), " obj models), ",
+                     lights.size(), " lights");
+    Utils::Log::debug("Primitive arena: ", _arena->objectCount(), " objects, ",
+                      _arena->bytesReserved() / 1024, " KiB reserved");
+    Utils::Log::info("Load phases: parse ", _loadTimings.parse * 1e3, " ms, build ",
+                     _loadTimings.build * 1e3, " ms, OBJ ", _loadTimings.obj * 1e3, " ms, accel ",
+                     _loadTimings.accel * 1e3, " ms (deferred meshes are timed by the mesh cache)");
 }
 
 std::shared_ptr<RayTracer::Camera> Scene::getCameraByName(const std::string& name) const {
@@ -261,6 +340,12 @@ std::shared_ptr<RayTracer::Camera> Scene::getCameraByName(const std::string& nam
     return nullptr;
 }
 
+void Scene::addPrimitive(std::shared_ptr<RayTracer::IPrimitive> primitive)
+{
+    _primitives.push_back(std::move(primitive));
+    _accelBuilt = false;
+}
+
 bool Scene::moveObject(const std::string& name, const Math::Vector3D& offset) {
     auto it = cameraMap.find(name);
     if (it == cameraMap.end())
@@ -269,3 +354,838 @@ bool Scene::moveObject(const std::string& name, const Math::Vector3D& offset) {
     it->second->translate(offset);
     return true;
 }
+
+void Scene::buildAccel()
+{
+    _accelBuilt = false;
+    std::vector<RayTracer::PrimitiveBVH::Entry> entries(_primitives.size());
+    for (std::size_t i = 0; i < _primitives.size(); ++i) {
+        auto& entry = entries[i];
+        entry.primitive = _primitives[i].get();
+        // addPrimitive() appends: only primitives added by hand have no build
+        if (i >= _builds.size())
+            continue;
+        if (_builds[i].mesh >= 0) {
+            const MeshRecord& record = _meshes[_builds[i].mesh];
+            entry.bounded = !record.resident;
+            std::copy_n(record.min, 3, entry.min);
+            std::copy_n(record.max, 3, entry.max);
+        } else if (const auto* kernels = _factory.kernels(_builds[i].config.type)) {
+            entry.kernel = kernels->intersectBatch;
+            entry.bounded = kernels->bounds && kernels->bounds(*entry.primitive, entry.min, entry.max);
+        }
+    }
+    _accel = RayTracer::PrimitiveBVH(std::move(entries));
+    _accelBuilt = true;
+    Utils::Log::debug("Scene BVH: ", _accel.boundedCount(), " of ", _accel.size(),
+                      " primitives bounded, ", _accel.nodeCount(), " nodes");
+}
+
+bool Scene::intersect(const RayTracer::Ray& ray, HitInfo& hit) const
+{
+    return intersect(&ray, 1, &hit) != 0;
+}
+
+uint64_t Scene::intersect(const RayTracer::Ray* rays, std::size_t n, HitInfo* hits) const
+{
+    if (_accelBuilt)
+        return _accel.intersect(rays, n, hits);
+
+    uint64_t found = 0;
+    for (std::size_t r = 0; r < std::min(n, RayTracer::PrimitiveBVH::MaxBatch); ++r) {
+        hits[r].t = std::numeric_limits<double>::max();
+        for (const auto& prim : _primitives) {
+            HitInfo tmp;
+            if (prim->hits(rays[r], tmp) && tmp.t < hits[r].t) {
+                hits[r] = tmp;
+                found |= uint64_t(1) << r;
+            }
+        }
+    }
+    return found;
+}
+
+bool Scene::occluded(const RayTracer::Ray& ray, double maxDist) const
+{
+    if (_accelBuilt)
+        return _accel.occluded(ray, maxDist);
+
+    for (const auto& prim : _primitives) {
+        HitInfo tmp;
+        if (prim->hits(ray, tmp) && tmp.t < maxDist)
+            return true;
+    }
+    return false;
+}
+
+void Scene::construct(Construction& work)
+{
+    const std::size_t meshTasks = work.objFiles.size();
+    const std::size_t configTasks = (work.configs.size() + ConfigsPerTask - 1) / ConfigsPerTask;
+    work.primitives.assign(work.configs.size(), nullptr);
+    work.meshes.assign(meshTasks, MeshRecord());
+    std::vector<double> objSeconds(meshTasks, 0);
+    std::vector<std::exception_ptr> errors(meshTasks + configTasks);
+
+    // Meshes come first since they are the longest tasks. A mesh read
+    // without bounds is loaded, BVH included, within its own task.
+    Utils::ThreadPool::global().parallelFor(meshTasks + configTasks, [&](std::size_t task) {
+        try {
+            if (task < meshTasks) {
+                auto start = Clock::now();
+                work.meshes[task] = prepareMesh(*work.objFiles[task]);
+                objSeconds[task] = secondsSince(start);
+                return;
+            }
+            std::size_t begin = (task - meshTasks) * ConfigsPerTask;
+            std::size_t end = std::min(begin + ConfigsPerTask, work.configs.size());
+            // Consecutive configurations of one type make one factory batch
+            for (std::size_t i = begin, run; i < end; i = run) {
+                const std::string& type = work.configs[i]->type;
+                for (run = i + 1; run < end && work.configs[run]->type == type; ++run) {}
+                _factory.create(type, &work.configs[i], run - i, _arena, &work.primitives[i]);
+            }
+        } catch (...) {
+            errors[task] = std::current_exception();
+        }
+    });
+
+    // Report the failure a sequential build would have hit first:
+    // primitives precede obj_files in the scene
+    for (std::size_t task = meshTasks; task < errors.size(); ++task)
+        if (errors[task])
+            std::rethrow_exception(errors[task]);
+    for (std::size_t task = 0; task < meshTasks; ++task)
+        if (errors[task])
+            std::rethrow_exception(errors[task]);
+
+    // Cache slots are handed out in scene order, whatever the completion order
+    for (std::size_t i = 0; i < meshTasks; ++i) {
+        registerMesh(work.meshes[i]);
+        work.objSeconds += objSeconds[i];
+        if (work.meshes[i].resident)
+            work.accelSeconds += work.meshes[i].resident->buildSeconds();
+    }
+}
+
+RayTracer::MeshCache::Loader Scene::meshLoader(const MeshRecord& record)
+{
+    const std::string path = record.path;
+    const double scale = record.scale;
+    const Math::Point3D position = record.position;
+    const Color color = record.color;
+    const RayTracer::Mesh::Shading shading = record.shading;
+    return [=]() -> std::shared_ptr<RayTracer::Mesh> {
+        if (Utils::MeshFile::isMeshFile(path))
+            return Utils::MeshFile::load(path, scale, position, color, shading);
+        return Utils::ObjLoader::load(path, scale, position, color, shading);
+    };
+}
+
+void Scene::registerMesh(MeshRecord& record)
+{
+    if (record.resident)
+        return;
+    record.slot = _meshCache->add(meshLoader(record));
+    record.primitive = std::make_shared<RayTracer::MeshProxy>(
+        _meshCache, record.slot, record.min, record.max, record.color);
+}
+
+Scene::MeshRecord Scene::prepareMesh(const Parser::ObjFile& parsedObj) const
+{
+    MeshRecord record;
+    record.entry = parsedObj.path;
+    record.path = meshSource(parsedObj.path);
+    record.signature = statSignature(record.path);
+    record.color = Color(parsedObj.color.r, parsedObj.color.g, parsedObj.color.b);
+    record.scale = parsedObj.scale;
+    record.position = Math::Point3D(parsedObj.position.x, parsedObj.position.y, parsedObj.position.z);
+    record.shading = parseShading(parsedObj.shading, parsedObj.path);
+
+    const std::string& path = record.path;
+    const double scale = record.scale;
+    const Math::Point3D& position = record.position;
+
+    // Only the bounds are read now; the geometry waits for the first ray
+    double min[3], max[3];
+    bool bounded = false;
+    if (Utils::MeshFile::isMeshFile(path)) {
+        double modelMin[3], modelMax[3];
+        bounded = Utils::MeshFile::bounds(path, modelMin, modelMax);
+        const double offset[3] = {position._x, position._y, position._z};
+        for (int axis = 0; bounded && axis < 3; ++axis) {
+            min[axis] = std::min(modelMin[axis] * scale, modelMax[axis] * scale) + offset[axis];
+            max[axis] = std::max(modelMin[axis] * scale, modelMax[axis] * scale) + offset[axis];
+        }
+    } else {
+        bounded = Utils::ObjLoader::bounds(path, scale, position, min, max);
+    }
+
+    if (bounded) {
+        std::copy_n(min, 3, record.min);
+        std::copy_n(max, 3, record.max);
+    } else {
+        record.resident = meshLoader(record)();     // reports the unreadable file right away
+        record.primitive = record.resident;
+    }
+    return record;
+}
+
+void Scene::addMesh(MeshRecord record)
+{
+    _sources.push_back({record.path, Source::Stat, record.signature});
+    _primitives.push_back(record.primitive);
+    _meshes.push_back(std::move(record));
+    _builds.push_back({PrimitiveConfig(), static_cast<int>(_meshes.size() - 1)});
+}
+
+uint64_t Scene::contentSignature() const
+{
+    if (_sources.empty())
+        return 0;
+    uint64_t signature = Utils::FnvOffsetBasis;
+    for (const auto& source : _sources) {
+        signature = Utils::fnv1a(source.path.data(), source.path.size(), signature);
+        signature = Utils::hashValue(source.signature, signature);
+    }
+    return signature;
+}
+
+uint64_t Scene::statSignature(const std::string& path)
+{
+    return Utils::fileSignature(path);
+}
+
+namespace {
+    constexpr char SnapshotMagic[8] = {'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+    constexpr uint32_t SnapshotVersion = 2;
+    constexpr std::size_t BlobAlignment = Utils::MeshFile::SectionAlignment;
+
+    /**
+     * @brief Start of a snapshot; mesh images follow, then the metadata
+     */
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t metaOffset;
+        uint64_t metaSize;
+        uint8_t reserved[32];
+    };
+    static_assert(sizeof(SnapshotHeader) == 64);
+
+    enum class LightKind : uint8_t { Ambient, Directional, Point };
+
+    template <typename T>
+    void putXYZ(Utils::ByteWriter& out, const T& value)
+    {
+        out.put(value._x);
+        out.put(value._y);
+        out.put(value._z);
+    }
+
+    template <typename T>
+    T getXYZ(Utils::ByteReader& in)
+    {
+        double x = in.get<double>();
+        double y = in.get<double>();
+        double z = in.get<double>();
+        return T(x, y, z);
+    }
+
+    void putColor(Utils::ByteWriter& out, const Color& color)
+    {
+        out.put<int32_t>(color.getR());
+        out.put<int32_t>(color.getG());
+        out.put<int32_t>(color.getB());
+    }
+
+    Color getColor(Utils::ByteReader& in)
+    {
+        int r = in.get<int32_t>();
+        int g = in.get<int32_t>();
+        int b = in.get<int32_t>();
+        return Color(r, g, b);
+    }
+
+    void putConfig(Utils::ByteWriter& out, const PrimitiveConfig& cfg)
+    {
+        out.putString(cfg.type);
+        putColor(out, cfg.color);
+        out.put<uint32_t>(static_cast<uint32_t>(cfg.data.index()));
+        if (auto* d = std::get_if<SphereData_t>(&cfg.data)) {
+            putXYZ(out, d->c);
+            out.put(d->r);
+        } else if (auto* d = std::get_if<TriangleData_t>(&cfg.data)) {
+            putXYZ(out, d->a);
+            putXYZ(out, d->b);
+            putXYZ(out, d->c);
+        } else if (auto* d = std::get_if<RectangleData_t>(&cfg.data)) {
+            putXYZ(out, d->origin);
+            putXYZ(out, d->bottom);
+            putXYZ(out, d->left);
+        } else if (auto* d = std::get_if<PlaneData_t>(&cfg.data)) {
+            putXYZ(out, d->pos);
+            putXYZ(out, d->norm);
+        } else if (auto* d = std::get_if<ConeData_t>(&cfg.data)) {
+            putXYZ(out, d->apex);
+            putXYZ(out, d->axis);
+            out.put(d->radius);
+            out.put(d->height);
+        } else if (auto* d = std::get_if<CylinderData_t>(&cfg.data)) {
+            putXYZ(out, d->baseCenter);
+            putXYZ(out, d->axis);
+            out.put(d->radius);
+            out.put(d->height);
+        }
+    }
+
+    void putCamera(Utils::ByteWriter& out, const RayTracer::Camera& camera)
+    {
+        putXYZ(out, camera._origin);
+        putXYZ(out, camera._rotation);
+        putXYZ(out, camera._screen._origin);
+        putXYZ(out, camera._screen._bottom_side);
+        putXYZ(out, camera._screen._left_side);
+        out.put(camera._width);
+        out.put(camera._height);
+    }
+
+    void putLight(Utils::ByteWriter& out, const RayTracer::ILight& light)
+    {
+        if (auto amb = dynamic_cast<const RayTracer::AmbientLight*>(&light)) {
+            out.put(LightKind::Ambient);
+            out.put(amb->getIntensity());
+            putColor(out, amb->getColor());
+        } else if (auto dir = dynamic_cast<const RayTracer::DirectionalLight*>(&light)) {
+            out.put(LightKind::Directional);
+            out.put(dir->getIntensity());
+            putColor(out, dir->getColor());
+            putXYZ(out, dir->getDirection());
+        } else if (auto pt = dynamic_cast<const RayTracer::PointLight*>(&light)) {
+            out.put(LightKind::Point);
+            out.put(pt->getIntensity());
+            putColor(out, pt->getColor());
+            putXYZ(out, pt->getPosition());
+        } else {
+            throw std::runtime_error("Cannot serialize a light of unknown type");
+        }
+    }
+
+    PrimitiveConfig getConfig(Utils::ByteReader& in)
+    {
+        PrimitiveConfig cfg;
+        cfg.type = in.getString();
+        cfg.color = getColor(in);
+        switch (in.get<uint32_t>()) {
+            case 0:
+                break;
+            case 1: {
+                Math::Point3D c = getXYZ<Math::Point3D>(in);
+                cfg.data.emplace<SphereData_t>(c, in.get<double>());
+                break;
+            }
+            case 2: {
+                TriangleData_t d;
+                d.a = getXYZ<Math::Point3D>(in);
+                d.b = getXYZ<Math::Point3D>(in);
+                d.c = getXYZ<Math::Point3D>(in);
+                cfg.data = d;
+                break;
+            }
+            case 3: {
+                RectangleData_t d;
+                d.origin = getXYZ<Math::Point3D>(in);
+                d.bottom = getXYZ<Math::Vector3D>(in);
+                d.left = getXYZ<Math::Vector3D>(in);
+                cfg.data = d;
+                break;
+            }
+            case 4: {
+                PlaneData_t d;
+                d.pos = getXYZ<Math::Point3D>(in);
+                d.norm = getXYZ<Math::Vector3D>(in);
+                cfg.data = d;
+                break;
+            }
+            case 5: {
+                ConeData_t d;
+                d.apex = getXYZ<Math::Point3D>(in);
+                d.axis = getXYZ<Math::Vector3D>(in);
+                d.radius = in.get<double>();
+                d.height = in.get<double>();
+                cfg.data = d;
+                break;
+            }
+            case 6: {
+                CylinderData_t d;
+                d.baseCenter = getXYZ<Math::Point3D>(in);
+                d.axis = getXYZ<Math::Vector3D>(in);
+                d.radius = in.get<double>();
+                d.height = in.get<double>();
+                cfg.data = d;
+                break;
+            }
+            default:
+                throw std::runtime_error("Corrupt snapshot: unknown primitive data");
+        }
+        return cfg;
+    }
+}
+
+void Scene::saveSnapshot(const std::string& path)
+{
+    if (_sourcePath.empty())
+        throw std::runtime_error("Only a scene loaded from a file can be snapshotted");
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot open file for writing: " + path);
+
+    SnapshotHeader header{};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t offset = sizeof(header);
+
+    // Mesh images first, one at a time so that only one is held in memory
+    Utils::ByteWriter meta;
+    std::vector<std::pair<uint64_t, uint64_t>> blobs;
+    std::vector<std::pair<double, Math::Point3D>> placements;
+    RayTracer::MeshCache::Pass pass = _meshCache->beginPass();
+    for (const auto& record : _meshes) {
+        const RayTracer::Mesh* mesh = record.resident.get();
+        if (!mesh)
+            mesh = _meshCache->acquire(record.slot);
+        if (!mesh) {
+            blobs.push_back({0, 0});
+            placements.push_back({1.0, Math::Point3D()});
+            continue;
+        }
+        std::vector<char> bytes = Utils::MeshFile::serialize(*mesh);
+        uint64_t start = (offset + BlobAlignment - 1) / BlobAlignment * BlobAlignment;
+        out.write(std::string(start - offset, '\0').data(), static_cast<std::streamsize>(start - offset));
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        blobs.push_back({start, bytes.size()});
+        placements.push_back({mesh->scale(), mesh->offset()});
+        offset = start + bytes.size();
+    }
+
+    meta.putString(_sourcePath);
+    meta.put(_sourceHash);
+    meta.put<uint32_t>(static_cast<uint32_t>(_sources.size()));
+    for (const auto& source : _sources) {
+        meta.putString(source.path);
+        meta.put(source.kind);
+        meta.put(source.signature);
+    }
+
+    meta.put<uint32_t>(static_cast<uint32_t>(cameras.size()));
+    for (const auto& camera : cameras) {
+        std::string name;
+        for (const auto& [key, value] : cameraMap)
+            if (value == camera)
+                name = key;
+        meta.putString(name);
+        putCamera(meta, *camera);
+    }
+
+    meta.put<uint32_t>(static_cast<uint32_t>(_meshes.size()));
+    for (std::size_t i = 0; i < _meshes.size(); ++i) {
+        const auto& record = _meshes[i];
+        meta.putString(record.entry);
+        meta.putString(record.path);
+        meta.put(record.signature);
+        putColor(meta, record.color);
+        meta.put(record.scale);
+        putXYZ(meta, record.position);
+        meta.put(record.shading);
+        meta.put<uint8_t>(record.resident ? 0 : 1);
+        for (int axis = 0; axis < 3; ++axis) {
+            meta.put(record.min[axis]);
+            meta.put(record.max[axis]);
+        }
+        meta.put(placements[i].first);
+        putXYZ(meta, placements[i].second);
+        meta.put(blobs[i].first);
+        meta.put(blobs[i].second);
+    }
+
+    meta.put<uint32_t>(static_cast<uint32_t>(_builds.size()));
+    for (const auto& build : _builds) {
+        meta.put<int32_t>(build.mesh);
+        if (build.mesh < 0)
+            putConfig(meta, build.config);
+    }
+
+    meta.put<uint32_t>(static_cast<uint32_t>(lights.size()));
+    for (const auto& light : lights)
+        putLight(meta, *light);
+
+    std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = SnapshotVersion;
+    header.byteOrder = Utils::MeshFile::ByteOrderMark;
+    header.metaOffset = offset;
+    header.metaSize = meta.size();
+    out.write(meta.buffer().data(), static_cast<std::streamsize>(meta.size()));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out.flush())
+        throw std::runtime_error("Cannot write snapshot: " + path);
+}
+
+bool Scene::loadSnapshot(const std::string& path)
+{
+    auto file = std::make_shared<Utils::MappedFile>(path, Utils::MappedFile::Access::Random);
+    if (!file->isOpen())
+        throw std::runtime_error("Cannot open snapshot: " + path);
+
+    SnapshotHeader header;
+    if (file->size() < sizeof(header))
+        throw std::runtime_error("Truncated snapshot: " + path);
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0
+        || header.byteOrder != Utils::MeshFile::ByteOrderMark)
+        throw std::runtime_error("Not a scene snapshot: " + path);
+    if (header.version != SnapshotVersion)
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version) + ": " + path);
+    if (header.metaOffset > file->size() || header.metaSize > file->size() - header.metaOffset)
+        throw std::runtime_error("Corrupt snapshot: " + path);
+
+    Utils::ByteReader in(file->data() + header.metaOffset, header.metaSize);
+    std::string sourcePath = in.getString();
+    uint64_t sourceHash = in.get<uint64_t>();
+
+    // Everything the scene was compiled from must be unchanged
+    std::vector<Source> sources(in.get<uint32_t>());
+    bool fresh = true;
+    for (auto& source : sources) {
+        source.path = in.getString();
+        source.kind = in.get<Source::Kind>();
+        source.signature = in.get<uint64_t>();
+        uint64_t current = source.kind == Source::Content
+            ? hashFileContent(source.path) : statSignature(source.path);
+        fresh = fresh && current == source.signature;
+    }
+    if (!fresh) {
+        Utils::Log::info("Snapshot ", path, " is out of date, loading ", sourcePath);
+        loadFromFile(sourcePath);
+        return false;
+    }
+
+    std::vector<std::pair<std::string, std::shared_ptr<RayTracer::Camera>>> loadedCameras(in.get<uint32_t>());
+    for (auto& [name, camera] : loadedCameras) {
+        name = in.getString();
+        camera = std::make_shared<RayTracer::Camera>();
+        camera->_origin = getXYZ<Math::Point3D>(in);
+        camera->_rotation = getXYZ<Math::Vector3D>(in);
+        camera->_screen._origin = getXYZ<Math::Point3D>(in);
+        camera->_screen._bottom_side = getXYZ<Math::Vector3D>(in);
+        camera->_screen._left_side = getXYZ<Math::Vector3D>(in);
+        camera->_width = in.get<double>();
+        camera->_height = in.get<double>();
+    }
+
+    // Meshes wrap their image inside the mapping, which they keep alive
+    std::vector<MeshRecord> meshes(in.get<uint32_t>());
+    std::shared_ptr<const Utils::MappedFile> mapping = file;
+    for (auto& record : meshes) {
+        record.entry = in.getString();
+        record.path = in.getString();
+        record.signature = in.get<uint64_t>();
+        record.color = getColor(in);
+        record.scale = in.get<double>();
+        record.position = getXYZ<Math::Point3D>(in);
+        record.shading = in.get<RayTracer::Mesh::Shading>();
+        bool bounded = in.get<uint8_t>() != 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            record.min[axis] = in.get<double>();
+            record.max[axis] = in.get<double>();
+        }
+        double placementScale = in.get<double>();
+        Math::Point3D placementOffset = getXYZ<Math::Point3D>(in);
+        uint64_t offset = in.get<uint64_t>();
+        uint64_t size = in.get<uint64_t>();
+
+        Color color = record.color;
+        std::string name = path + ":" + record.path;
+        RayTracer::MeshCache::Loader loader = [=]() -> std::shared_ptr<RayTracer::Mesh> {
+            if (size == 0)
+                return std::make_shared<RayTracer::Mesh>(std::vector<float>(), std::vector<uint32_t>(), color);
+            return Utils::MeshFile::load(mapping, offset, size, name, placementScale, placementOffset,
+                                         color, RayTracer::Mesh::Shading::Auto);
+        };
+        if (bounded) {
+            record.slot = _meshCache->add(loader);
+            record.primitive = std::make_shared<RayTracer::MeshProxy>(
+                _meshCache, record.slot, record.min, record.max, color);
+        } else {
+            record.resident = loader();
+            record.primitive = record.resident;
+        }
+    }
+
+    std::vector<Build> builds(in.get<uint32_t>());
+    for (auto& build : builds) {
+        build.mesh = in.get<int32_t>();
+        if (build.mesh < 0)
+            build.config = getConfig(in);
+        else if (static_cast<std::size_t>(build.mesh) >= meshes.size())
+            throw std::runtime_error("Corrupt snapshot: " + path);
+    }
+
+    std::vector<std::shared_ptr<RayTracer::ILight>> loadedLights(in.get<uint32_t>());
+    for (auto& light : loadedLights) {
+        auto kind = in.get<LightKind>();
+        double intensity = in.get<double>();
+        Color color = getColor(in);
+        if (kind == LightKind::Ambient)
+            light = std::make_shared<RayTracer::AmbientLight>(intensity, color);
+        else if (kind == LightKind::Directional)
+            light = std::make_shared<RayTracer::DirectionalLight>(getXYZ<Math::Vector3D>(in), color, intensity);
+        else if (kind == LightKind::Point)
+            light = std::make_shared<RayTracer::PointLight>(getXYZ<Math::Point3D>(in), color, intensity);
+        else
+            throw std::runtime_error("Corrupt snapshot: " + path);
+    }
+
+    // Plugin primitives are created concurrently; nothing below throws
+    Construction work;
+    for (const auto& build : builds)
+        if (build.mesh < 0)
+            work.configs.push_back(&build.config);
+    construct(work);
+
+    const std::size_t meshBase = _meshes.size();
+    std::size_t created = 0;
+    for (const auto& build : builds) {
+        if (build.mesh < 0) {
+            _primitives.push_back(work.primitives[created++]);
+            _builds.push_back(build);
+        } else {
+            _primitives.push_back(meshes[build.mesh].primitive);
+            _builds.push_back({PrimitiveConfig(), static_cast<int>(meshBase + build.mesh)});
+        }
+    }
+    for (auto& [name, camera] : loadedCameras) {
+        cameras.push_back(camera);
+        if (!name.empty())
+            cameraMap[name] = camera;
+    }
+    lights.insert(lights.end(), loadedLights.begin(), loadedLights.end());
+    for (auto& record : meshes)
+        _meshes.push_back(std::move(record));
+    _sources.insert(_sources.end(), sources.begin(), sources.end());
+    _sourcePath = sourcePath;
+    _sourceHash = sourceHash;
+    buildAccel();
+
+    Utils::Log::info("Snapshot loaded: ", cameras.size(), " cameras, ",
+                     _primitives.size(), " primitives, ", lights.size(), " lights");
+    return true;
+}
+
+namespace {
+    // Byte encodings compared by reload(): equal keys mean equal objects
+
+    template <typename T, typename Put>
+    std::string keyOf(const T& value, Put put)
+    {
+        Utils::ByteWriter out;
+        put(out, value);
+        return std::string(out.buffer().data(), out.size());
+    }
+
+    std::string meshKey(const std::string& entry, const std::string& path, uint64_t signature,
+                        const Color& color, double scale, const Math::Point3D& position,
+                        RayTracer::Mesh::Shading shading)
+    {
+        Utils::ByteWriter out;
+        out.putString(entry);
+        out.putString(path);
+        out.put(signature);
+        putColor(out, color);
+        out.put(scale);
+        putXYZ(out, position);
+        out.put(shading);
+        return std::string(out.buffer().data(), out.size());
+    }
+}
+
+Scene::ReloadStats Scene::reload()
+{
+    if (_sourcePath.empty())
+        throw std::runtime_error("The scene was not loaded from a file");
+
+    Parser::Parser parser;
+    if (!parser.loadFromFile(_sourcePath))
+        throw std::runtime_error(parser.getErrorMessage());
+
+    // The new scene is assembled on the side and swapped in at the end,
+    // so a primitive that fails to build leaves the live scene as it was
+    ReloadStats stats;
+    std::vector<std::shared_ptr<RayTracer::Camera>> nextCameras;
+    std::map<std::string, std::shared_ptr<RayTracer::Camera>> nextCameraMap;
+    std::vector<std::pair<std::shared_ptr<RayTracer::Camera>, std::shared_ptr<RayTracer::Camera>>> cameraUpdates;
+    std::size_t camerasReused = 0;
+    for (const auto& parsedCam : parser.getCameras()) {
+        auto fresh = makeCamera(parsedCam);
+        auto it = cameraMap.find(parsedCam.name);
+        if (it == cameraMap.end() || nextCameraMap.count(parsedCam.name)) {
+            ++stats.added;
+            nextCameras.push_back(fresh);
+        } else {
+            if (keyOf(*it->second, putCamera) == keyOf(*fresh, putCamera))
+                ++stats.kept;
+            else
+                cameraUpdates.push_back({it->second, fresh});
+            nextCameras.push_back(it->second);
+            ++camerasReused;
+        }
+        nextCameraMap[parsedCam.name] = nextCameras.back();
+    }
+
+    std::unordered_multimap<std::string, std::size_t> oldConfigs;
+    for (std::size_t i = 0; i < _builds.size(); ++i)
+        if (_builds[i].mesh < 0)
+            oldConfigs.emplace(keyOf(_builds[i].config, putConfig), i);
+
+    std::unordered_multimap<std::string, std::size_t> oldMeshes;
+    for (std::size_t i = 0; i < _meshes.size(); ++i) {
+        const auto& m = _meshes[i];
+        oldMeshes.emplace(meshKey(m.entry, m.path, m.signature, m.color, m.scale, m.position, m.shading), i);
+    }
+
+    // Unchanged objects are taken from the live scene, the others are
+    // built in one concurrent pass
+    const std::vector<PrimitiveConfig> configs = primitiveConfigs(parser);
+    const auto& parsedObjs = parser.getObjFiles();
+    Construction work;
+    std::vector<std::shared_ptr<RayTracer::IPrimitive>> keptPrimitives(configs.size());
+    for (std::size_t i = 0; i < configs.size(); ++i) {
+        auto it = oldConfigs.find(keyOf(configs[i], putConfig));
+        if (it != oldConfigs.end()) {
+            keptPrimitives[i] = _primitives[it->second];
+            oldConfigs.erase(it);
+            ++stats.kept;
+        } else {
+            work.configs.push_back(&configs[i]);
+            ++stats.added;
+        }
+    }
+    std::vector<int> keptMeshes(parsedObjs.size(), -1);
+    for (std::size_t i = 0; i < parsedObjs.size(); ++i) {
+        const auto& parsedObj = parsedObjs[i];
+        std::string path = meshSource(parsedObj.path);
+        Color color(parsedObj.color.r, parsedObj.color.g, parsedObj.color.b);
+        Math::Point3D position(parsedObj.position.x, parsedObj.position.y, parsedObj.position.z);
+        auto it = oldMeshes.find(meshKey(parsedObj.path, path, statSignature(path), color, parsedObj.scale,
+                                         position, parseShading(parsedObj.shading, parsedObj.path)));
+        if (it != oldMeshes.end()) {
+            keptMeshes[i] = static_cast<int>(it->second);
+            oldMeshes.erase(it);
+            ++stats.kept;
+            ++stats.meshesReused;
+        } else {
+            work.objFiles.push_back(&parsedObj);
+            ++stats.added;
+        }
+    }
+    construct(work);
+
+    std::vector<std::shared_ptr<RayTracer::IPrimitive>> nextPrimitives;
+    std::vector<Build> nextBuilds;
+    std::size_t created = 0;
+    for (std::size_t i = 0; i < configs.size(); ++i) {
+        nextPrimitives.push_back(keptPrimitives[i] ? keptPrimitives[i] : work.primitives[created++]);
+        nextBuilds.push_back({configs[i], -1});
+    }
+
+    std::vector<MeshRecord> nextMeshes;
+    std::vector<Source> nextSources;
+    const uint64_t sourceHash = hashFileContent(_sourcePath);
+    nextSources.push_back({_sourcePath, Source::Content, sourceHash});
+    created = 0;
+    for (std::size_t i = 0; i < parsedObjs.size(); ++i) {
+        if (keptMeshes[i] >= 0)
+            nextMeshes.push_back(_meshes[keptMeshes[i]]);
+        else
+            nextMeshes.push_back(std::move(work.meshes[created++]));
+        const MeshRecord& record = nextMeshes.back();
+        nextSources.push_back({record.path, Source::Stat, record.signature});
+        nextPrimitives.push_back(record.primitive);
+        nextBuilds.push_back({PrimitiveConfig(), static_cast<int>(nextMeshes.size() - 1)});
+    }
+
+    std::unordered_multimap<std::string, std::shared_ptr<RayTracer::ILight>> oldLights;
+    for (const auto& light : lights)
+        oldLights.emplace(keyOf(*light, putLight), light);
+    std::vector<std::shared_ptr<RayTracer::ILight>> nextLights;
+    for (const auto& fresh : makeLights(parser.getLights())) {
+        auto it = oldLights.find(keyOf(*fresh, putLight));
+        if (it != oldLights.end()) {
+            nextLights.push_back(it->second);
+            oldLights.erase(it);
+            ++stats.kept;
+        } else {
+            nextLights.push_back(fresh);
+            ++stats.added;
+        }
+    }
+
+    // Nothing below throws: commit
+    for (auto& [camera, fresh] : cameraUpdates) {
+        *camera = *fresh;
+        ++stats.changed;
+    }
+    stats.removed = cameras.size() - camerasReused
+                  + oldConfigs.size() + oldMeshes.size() + oldLights.size();
+    for (const auto& [key, index] : oldMeshes)
+        if (!_meshes[index].resident)
+            _meshCache->release(_meshes[index].slot);
+
+    cameras = std::move(nextCameras);
+    cameraMap = std::move(nextCameraMap);
+    _primitives = std::move(nextPrimitives);
+    _builds = std::move(nextBuilds);
+    _meshes = std::move(nextMeshes);
+    _sources = std::move(nextSources);
+    lights = std::move(nextLights);
+    _sourceHash = sourceHash;
+    buildAccel();
+
+    Utils::Log::info("Scene reloaded: ", stats.kept, " kept, ", stats.changed, " changed, ",
+                     stats.added, " added, ", stats.removed, " removed, ",
+                     stats.meshesReused, " meshes reused");
+    return stats;
+}
+
+Scene::PluginReloadStats Scene::reloadPlugins()
+{
+    // Without a build for every primitive, some would keep the old code
+    if (_builds.size() != _primitives.size())
+        throw std::runtime_error("Primitives added by hand cannot be re-created, plugins left as they were");
+
+    PluginReloadStats stats;
+    Construction work;
+    std::vector<std::size_t> targets;
+    stats.plugins = _factory.reloadPlugins([&](const Core::PrimitiveFactory::PluginReload& reload) {
+        const auto& types = reload.types;
+        for (std::size_t i = 0; i < _builds.size(); ++i) {
+            const Build& build = _builds[i];
+            if (build.mesh < 0 && std::find(types.begin(), types.end(), build.config.type) != types.end()) {
+                work.configs.push_back(&build.config);
+                targets.push_back(i);
+            }
+        }
+        construct(work);
+    });
+    if (stats.plugins.types.empty())
+        return stats;
+
+    for (std::size_t k = 0; k < targets.size(); ++k)
+        _primitives[targets[k]] = std::move(work.primitives[k]);
+    stats.recreated = targets.size();
+    buildAccel();
+    Utils::Log::info("Plugins reloaded: ", stats.plugins.types.size(), " types, ", stats.recreated,
+                     " primitives re-created");
+    return stats;
+}
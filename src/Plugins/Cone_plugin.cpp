@@ -8,6 +8,7 @@
 #include "RayTracer/Cone.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Core/PluginABI.hpp"
 
 #include <iostream>
 
@@ -22,4 +23,45 @@ extern "C" {
     {
         return "cone";
     }
+
+    unsigned getAbiVersion()
+    {
+        return Core::PluginABI::Version;
+    }
+
+    Core::PluginABI::Layout getPrimitiveLayout()
+    {
+        return Core::PluginABI::layoutOf<RayTracer::Cone>();
+    }
+
+    std::size_t createPrimitives(const PrimitiveConfig* const* configs, std::size_t count,
+                                 void* storage, RayTracer::IPrimitive** out)
+    {
+        return Core::PluginABI::constructBatch<RayTracer::Cone>(configs, count, storage, out,
+            [](void* at, const PrimitiveConfig& conf) {
+                const ConeData_t& cone = std::get<ConeData_t>(conf.data);
+                return new (at) RayTracer::Cone(cone.apex, cone.axis, cone.radius, cone.height, conf.color);
+            });
+    }
+
+    unsigned getCapabilities()
+    {
+        return Core::PluginABI::Bounds | Core::PluginABI::IntersectBatch;
+    }
+
+    bool primitiveBounds(const RayTracer::IPrimitive& primitive, double min[3], double max[3])
+    {
+        const auto& cone = static_cast<const RayTracer::Cone&>(primitive);
+        Math::Vector3D axis = cone.getAxis().normalize();
+        Core::PluginABI::resetBounds(min, max);
+        Core::PluginABI::expand(min, max, cone.getApex());
+        Core::PluginABI::expandDisc(min, max, cone.getApex() + axis * cone.getHeight(), axis, cone.getRadius());
+        return true;
+    }
+
+    void intersectBatch(const RayTracer::IPrimitive* const* primitives, std::size_t count,
+                        const RayTracer::Ray* rays, std::size_t n, HitInfo* hits)
+    {
+        Core::PluginABI::intersectEach<RayTracer::Cone>(primitives, count, rays, n, hits);
+    }
 }
@@ -8,6 +8,7 @@
 #include "RayTracer/Cylinder.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Core/PluginABI.hpp"
 
 #include <memory>
 
@@ -22,5 +23,46 @@ extern "C" {
     {
         return "cylinder";
     }
-}
 
+    unsigned getAbiVersion()
+    {
+        return Core::PluginABI::Version;
+    }
+
+    Core::PluginABI::Layout getPrimitiveLayout()
+    {
+        return Core::PluginABI::layoutOf<RayTracer::Cylinder>();
+    }
+
+    std::size_t createPrimitives(const PrimitiveConfig* const* configs, std::size_t count,
+                                 void* storage, RayTracer::IPrimitive** out)
+    {
+        return Core::PluginABI::constructBatch<RayTracer::Cylinder>(configs, count, storage, out,
+            [](void* at, const PrimitiveConfig& conf) {
+                const CylinderData_t& cylindre = std::get<CylinderData_t>(conf.data);
+                return new (at) RayTracer::Cylinder(cylindre.baseCenter, cylindre.axis, cylindre.radius, cylindre.height, conf.color);
+            });
+    }
+
+    unsigned getCapabilities()
+    {
+        return Core::PluginABI::Bounds | Core::PluginABI::IntersectBatch;
+    }
+
+    bool primitiveBounds(const RayTracer::IPrimitive& primitive, double min[3], double max[3])
+    {
+        const auto& cylinder = static_cast<const RayTracer::Cylinder&>(primitive);
+        Math::Vector3D axis = cylinder.getAxis().normalize();
+        Core::PluginABI::resetBounds(min, max);
+        Core::PluginABI::expandDisc(min, max, cylinder.getBaseCenter(), axis, cylinder.getRadius());
+        Core::PluginABI::expandDisc(min, max, cylinder.getBaseCenter() + axis * cylinder.getHeight(),
+                                    axis, cylinder.getRadius());
+        return true;
+    }
+
+    void intersectBatch(const RayTracer::IPrimitive* const* primitives, std::size_t count,
+                        const RayTracer::Ray* rays, std::size_t n, HitInfo* hits)
+    {
+        Core::PluginABI::intersectEach<RayTracer::Cylinder>(primitives, count, rays, n, hits);
+    }
+}
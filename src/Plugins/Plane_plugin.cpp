@@ -8,6 +8,7 @@
 #include "RayTracer/Plane.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Core/PluginABI.hpp"
 
 #include <memory>
 
@@ -22,4 +23,35 @@ extern "C" {
     {
         return "plane";
     }
+
+    unsigned getAbiVersion()
+    {
+        return Core::PluginABI::Version;
+    }
+
+    Core::PluginABI::Layout getPrimitiveLayout()
+    {
+        return Core::PluginABI::layoutOf<RayTracer::Plane>();
+    }
+
+    std::size_t createPrimitives(const PrimitiveConfig* const* configs, std::size_t count,
+                                 void* storage, RayTracer::IPrimitive** out)
+    {
+        return Core::PluginABI::constructBatch<RayTracer::Plane>(configs, count, storage, out,
+            [](void* at, const PrimitiveConfig& conf) {
+                const PlaneData_t& plane = std::get<PlaneData_t>(conf.data);
+                return new (at) RayTracer::Plane(plane.pos, plane.norm, conf.color);
+            });
+    }
+
+    unsigned getCapabilities()
+    {
+        return Core::PluginABI::IntersectBatch;     // unbounded: no primitiveBounds
+    }
+
+    void intersectBatch(const RayTracer::IPrimitive* const* primitives, std::size_t count,
+                        const RayTracer::Ray* rays, std::size_t n, HitInfo* hits)
+    {
+        Core::PluginABI::intersectEach<RayTracer::Plane>(primitives, count, rays, n, hits);
+    }
 }
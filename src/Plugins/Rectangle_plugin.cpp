@@ -8,6 +8,7 @@
 #include "RayTracer/Rectangle.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Core/PluginABI.hpp"
 
 #include <memory>
 
@@ -22,4 +23,46 @@ extern "C" {
     {
         return "rectangle";
     }
+
+    unsigned getAbiVersion()
+    {
+        return Core::PluginABI::Version;
+    }
+
+    Core::PluginABI::Layout getPrimitiveLayout()
+    {
+        return Core::PluginABI::layoutOf<RayTracer::Rectangle>();
+    }
+
+    std::size_t createPrimitives(const PrimitiveConfig* const* configs, std::size_t count,
+                                 void* storage, RayTracer::IPrimitive** out)
+    {
+        return Core::PluginABI::constructBatch<RayTracer::Rectangle>(configs, count, storage, out,
+            [](void* at, const PrimitiveConfig& conf) {
+                const RectangleData_t& rect = std::get<RectangleData_t>(conf.data);
+                return new (at) RayTracer::Rectangle(rect.origin, rect.bottom, rect.left, conf.color);
+            });
+    }
+
+    unsigned getCapabilities()
+    {
+        return Core::PluginABI::Bounds | Core::PluginABI::IntersectBatch;
+    }
+
+    bool primitiveBounds(const RayTracer::IPrimitive& primitive, double min[3], double max[3])
+    {
+        const Math::Rectangle3D& rect = static_cast<const RayTracer::Rectangle&>(primitive)._geometry;
+        Core::PluginABI::resetBounds(min, max);
+        Core::PluginABI::expand(min, max, rect._origin);
+        Core::PluginABI::expand(min, max, rect._origin + rect._bottom_side);
+        Core::PluginABI::expand(min, max, rect._origin + rect._left_side);
+        Core::PluginABI::expand(min, max, rect._origin + rect._bottom_side + rect._left_side);
+        return true;
+    }
+
+    void intersectBatch(const RayTracer::IPrimitive* const* primitives, std::size_t count,
+                        const RayTracer::Ray* rays, std::size_t n, HitInfo* hits)
+    {
+        Core::PluginABI::intersectEach<RayTracer::Rectangle>(primitives, count, rays, n, hits);
+    }
 }
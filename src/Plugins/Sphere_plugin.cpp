@@ -8,7 +8,10 @@
 #include "RayTracer/Sphere.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Core/PluginABI.hpp"
 
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <iostream>
 
@@ -23,4 +26,48 @@ extern "C" {
     {
         return "sphere";
     }
+
+    unsigned getAbiVersion()
+    {
+        return Core::PluginABI::Version;
+    }
+
+    Core::PluginABI::Layout getPrimitiveLayout()
+    {
+        return Core::PluginABI::layoutOf<RayTracer::Sphere>();
+    }
+
+    std::size_t createPrimitives(const PrimitiveConfig* const* configs, std::size_t count,
+                                 void* storage, RayTracer::IPrimitive** out)
+    {
+        return Core::PluginABI::constructBatch<RayTracer::Sphere>(configs, count, storage, out,
+            [](void* at, const PrimitiveConfig& conf) {
+                const SphereData_t& sphere = std::get<SphereData_t>(conf.data);
+                return new (at) RayTracer::Sphere(sphere.c, sphere.r, conf.color);
+            });
+    }
+
+    unsigned getCapabilities()
+    {
+        return Core::PluginABI::Bounds | Core::PluginABI::IntersectBatch;
+    }
+
+    bool primitiveBounds(const RayTracer::IPrimitive& primitive, double min[3], double max[3])
+    {
+        const auto& sphere = static_cast<const RayTracer::Sphere&>(primitive);
+        const Math::Point3D& c = sphere.getCenter();
+        const double center[3] = {c._x, c._y, c._z};
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = center[axis] - sphere.getRadius();
+            max[axis] = center[axis] + sphere.getRadius();
+        }
+        return true;
+    }
+
+    void intersectBatch(const RayTracer::IPrimitive* const* primitives, std::size_t count,
+                        const RayTracer::Ray* rays, std::size_t n, HitInfo* hits)
+    {
+        Core::PluginABI::intersectClosest<RayTracer::Sphere>(primitives, count, rays, n, hits,
+            [](const RayTracer::Sphere& sphere, const RayTracer::Ray& ray) { return sphere.distance(ray); });
+    }
 }
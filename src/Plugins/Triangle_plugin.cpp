@@ -8,7 +8,10 @@
 #include "RayTracer/Triangle.hpp"
 #include "RayTracer/IPrimitive.hpp"
 #include "Core/PrimitiveConfig.hpp"
+#include "Core/PluginABI.hpp"
 
+#include <cmath>
+#include <limits>
 #include <memory>
 
 extern "C" {
@@ -22,4 +25,45 @@ extern "C" {
     {
         return "triangle";
     }
+
+    unsigned getAbiVersion()
+    {
+        return Core::PluginABI::Version;
+    }
+
+    Core::PluginABI::Layout getPrimitiveLayout()
+    {
+        return Core::PluginABI::layoutOf<RayTracer::Triangle>();
+    }
+
+    std::size_t createPrimitives(const PrimitiveConfig* const* configs, std::size_t count,
+                                 void* storage, RayTracer::IPrimitive** out)
+    {
+        return Core::PluginABI::constructBatch<RayTracer::Triangle>(configs, count, storage, out,
+            [](void* at, const PrimitiveConfig& conf) {
+                const TriangleData_t& triangle = std::get<TriangleData_t>(conf.data);
+                return new (at) RayTracer::Triangle(triangle.a, triangle.b, triangle.c, conf.color);
+            });
+    }
+
+    unsigned getCapabilities()
+    {
+        return Core::PluginABI::Bounds | Core::PluginABI::IntersectBatch;
+    }
+
+    bool primitiveBounds(const RayTracer::IPrimitive& primitive, double min[3], double max[3])
+    {
+        const auto& triangle = static_cast<const RayTracer::Triangle&>(primitive);
+        Core::PluginABI::resetBounds(min, max);
+        for (const Math::Point3D* p : {&triangle._a, &triangle._b, &triangle._c})
+            Core::PluginABI::expand(min, max, *p);
+        return true;
+    }
+
+    void intersectBatch(const RayTracer::IPrimitive* const* primitives, std::size_t count,
+                        const RayTracer::Ray* rays, std::size_t n, HitInfo* hits)
+    {
+        Core::PluginABI::intersectClosest<RayTracer::Triangle>(primitives, count, rays, n, hits,
+            [](const RayTracer::Triangle& triangle, const RayTracer::Ray& ray) { return triangle.distance(ray); });
+    }
 }
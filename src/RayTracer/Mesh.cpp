@@ -0,0 +1,361 @@
+/*
+** Mesh - Indexed triangle mesh with its own bounding volume hierarchy
+*/
+
+#include "RayTracer/Mesh.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr uint32_t LeafSize = 4;
+    constexpr int StackSize = 64;
+}
+
+RayTracer::Mesh::Mesh(std::vector<float> vertices, std::vector<uint32_t> indices, const Color& color)
+    : _ownedVertices(std::move(vertices)), _ownedIndices(std::move(indices)), _color(color)
+{
+    _vertices = _ownedVertices.data();
+    _vertexCount = _ownedVertices.size() / 3;
+    _triangleCount = _ownedIndices.size() / 3;
+
+    const uint32_t triangles = static_cast<uint32_t>(_triangleCount);
+    if (triangles == 0)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> centroids(3 * static_cast<size_t>(triangles));
+    std::vector<uint32_t> order(triangles);
+    for (uint32_t t = 0; t < triangles; ++t) {
+        order[t] = t;
+        for (int axis = 0; axis < 3; ++axis) {
+            float sum = 0.f;
+            for (int corner = 0; corner < 3; ++corner)
+                sum += _vertices[3 * _ownedIndices[3 * t + corner] + axis];
+            centroids[3 * t + axis] = sum / 3.f;
+        }
+    }
+
+    _indices = _ownedIndices.data();
+    _ownedNodes.reserve(2 * (triangles / LeafSize + 1));
+    build(order, 0, triangles, centroids);
+
+    // Store the triangles in leaf order so that leaves are contiguous
+    std::vector<uint32_t> sorted(_ownedIndices.size());
+    for (uint32_t i = 0; i < triangles; ++i)
+        std::copy_n(&_ownedIndices[3 * order[i]], 3, &sorted[3 * i]);
+    _ownedIndices = std::move(sorted);
+    _ownedNodes.shrink_to_fit();
+
+    _indices = _ownedIndices.data();
+    _nodes = _ownedNodes.data();
+    _nodeCount = _ownedNodes.size();
+    _buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+RayTracer::Mesh::Mesh(std::shared_ptr<const void> storage, const View& view, const Color& color)
+    : _storage(std::move(storage)),
+      _vertices(view.vertices), _indices(view.indices), _nodes(view.nodes),
+      _normals(view.normals), _uvs(view.uvs),
+      _vertexCount(view.vertexCount), _triangleCount(view.triangleCount), _nodeCount(view.nodeCount),
+      _color(color)
+{
+}
+
+bool RayTracer::Mesh::isValid(const View& view)
+{
+    for (std::size_t i = 0; i < 3 * view.triangleCount; ++i)
+        if (view.indices[i] >= view.vertexCount)
+            return false;
+    if (view.triangleCount > 0 && view.nodeCount == 0)
+        return false;
+
+    // Children come after their parent, so depths are final once a node is reached
+    std::vector<int> depth(view.nodeCount, 0);
+    if (view.nodeCount > 0)
+        depth[0] = 1;
+    for (std::size_t i = 0; i < view.nodeCount; ++i) {
+        const Node& node = view.nodes[i];
+        if (depth[i] == 0)
+            continue;   // unreachable, never traversed
+        if (node.count > 0) {
+            if (node.start > view.triangleCount || node.count > view.triangleCount - node.start)
+                return false;
+            continue;
+        }
+        // A stack holding one entry per level plus the sibling pushed last
+        if (depth[i] + 1 > StackSize || i + 1 >= view.nodeCount
+            || node.start <= i || node.start >= view.nodeCount)
+            return false;
+        depth[i + 1] = std::max(depth[i + 1], depth[i] + 1);
+        depth[node.start] = std::max(depth[node.start], depth[i] + 1);
+    }
+    return true;
+}
+
+void RayTracer::Mesh::setNormals(std::vector<float> normals)
+{
+    _ownedNormals = std::move(normals);
+    _normals = _ownedNormals.size() == 3 * _vertexCount && _vertexCount > 0 ? _ownedNormals.data() : nullptr;
+}
+
+void RayTracer::Mesh::setUVs(std::vector<float> uvs)
+{
+    _ownedUVs = std::move(uvs);
+    _uvs = _ownedUVs.size() == 2 * _vertexCount && _vertexCount > 0 ? _ownedUVs.data() : nullptr;
+}
+
+void RayTracer::Mesh::computeSmoothNormals()
+{
+    std::vector<double> sum(3 * _vertexCount, 0.0);
+    for (std::size_t t = 0; t < _triangleCount; ++t) {
+        const uint32_t* tri = &_indices[3 * t];
+        Math::Vector3D corner[3];
+        for (int k = 0; k < 3; ++k) {
+            const float* p = &_vertices[3 * tri[k]];
+            corner[k] = Math::Vector3D(p[0], p[1], p[2]);
+        }
+        Math::Vector3D face = (corner[1] - corner[0]).cross(corner[2] - corner[0]);
+        if (face.length2() == 0.0)
+            continue;
+        face = face.normalize();
+
+        for (int k = 0; k < 3; ++k) {
+            Math::Vector3D e1 = corner[(k + 1) % 3] - corner[k];
+            Math::Vector3D e2 = corner[(k + 2) % 3] - corner[k];
+            double lengths = std::sqrt(e1.length2() * e2.length2());
+            if (lengths == 0.0)
+                continue;
+            double angle = std::acos(std::clamp(e1.dot(e2) / lengths, -1.0, 1.0));
+            sum[3 * tri[k]]     += face._x * angle;
+            sum[3 * tri[k] + 1] += face._y * angle;
+            sum[3 * tri[k] + 2] += face._z * angle;
+        }
+    }
+
+    // Vertices without a valid face keep a zero normal and shade flat
+    std::vector<float> normals(3 * _vertexCount, 0.f);
+    for (std::size_t v = 0; v < _vertexCount; ++v) {
+        double len = std::sqrt(sum[3 * v] * sum[3 * v] + sum[3 * v + 1] * sum[3 * v + 1]
+                               + sum[3 * v + 2] * sum[3 * v + 2]);
+        if (len > 0.0)
+            for (int axis = 0; axis < 3; ++axis)
+                normals[3 * v + axis] = static_cast<float>(sum[3 * v + axis] / len);
+    }
+    setNormals(std::move(normals));
+}
+
+void RayTracer::Mesh::applyShading(Shading shading)
+{
+    if (shading == Shading::Flat) {
+        setNormals({});
+    } else if (shading == Shading::Smooth && !_normals) {
+        computeSmoothNormals();
+    }
+}
+
+void RayTracer::Mesh::setPlacement(double scale, const Math::Point3D& offset)
+{
+    _scale = scale;
+    _offset = offset;
+}
+
+uint32_t RayTracer::Mesh::build(std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                                const std::vector<float>& centroids)
+{
+    uint32_t index = static_cast<uint32_t>(_ownedNodes.size());
+    _ownedNodes.push_back(Node{});
+
+    Node node{};
+    float cmin[3], cmax[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        node.min[axis] = cmin[axis] = std::numeric_limits<float>::max();
+        node.max[axis] = cmax[axis] = std::numeric_limits<float>::lowest();
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t t = order[i];
+        for (int corner = 0; corner < 3; ++corner) {
+            const float* v = &_vertices[3 * _indices[3 * t + corner]];
+            for (int axis = 0; axis < 3; ++axis) {
+                node.min[axis] = std::min(node.min[axis], v[axis]);
+                node.max[axis] = std::max(node.max[axis], v[axis]);
+            }
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            cmin[axis] = std::min(cmin[axis], centroids[3 * t + axis]);
+            cmax[axis] = std::max(cmax[axis], centroids[3 * t + axis]);
+        }
+    }
+
+    int axis = 0;
+    for (int a = 1; a < 3; ++a)
+        if (cmax[a] - cmin[a] > cmax[axis] - cmin[axis])
+            axis = a;
+
+    if (end - begin <= LeafSize || cmax[axis] <= cmin[axis]) {
+        node.start = begin;
+        node.count = end - begin;
+        _ownedNodes[index] = node;
+        return index;
+    }
+
+    // Median split on the widest centroid axis
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [&](uint32_t a, uint32_t b) { return centroids[3 * a + axis] < centroids[3 * b + axis]; });
+
+    build(order, begin, mid, centroids);
+    node.start = build(order, mid, end, centroids);
+    node.count = 0;
+    _ownedNodes[index] = node;
+    return index;
+}
+
+bool RayTracer::Mesh::hitsTriangle(const Math::Vector3D& origin, const Math::Vector3D& direction,
+                                   uint32_t triangle, double& t, double& det, double& u, double& v) const
+{
+    const double EPSILON = 1e-8;
+    const float* a = &_vertices[3 * _indices[3 * triangle]];
+    const float* b = &_vertices[3 * _indices[3 * triangle + 1]];
+    const float* c = &_vertices[3 * _indices[3 * triangle + 2]];
+
+    Math::Vector3D edge1(b[0] - a[0], b[1] - a[1], b[2] - a[2]);
+    Math::Vector3D edge2(c[0] - a[0], c[1] - a[1], c[2] - a[2]);
+
+    Math::Vector3D pvec = direction.cross(edge2);
+    det = edge1.dot(pvec);
+    if (std::abs(det) < EPSILON)
+        return false;
+
+    double invDet = 1.0 / det;
+
+    Math::Vector3D tvec(origin._x - a[0], origin._y - a[1], origin._z - a[2]);
+    u = invDet * tvec.dot(pvec);
+    if (u < 0.0 || u > 1.0)
+        return false;
+
+    Math::Vector3D qvec = tvec.cross(edge1);
+    v = invDet * direction.dot(qvec);
+    if (v < 0.0 || u + v > 1.0)
+        return false;
+
+    t = invDet * edge2.dot(qvec);
+    return t >= EPSILON;
+}
+
+bool RayTracer::Mesh::hits(const Ray& ray, HitInfo& hit) const
+{
+    if (_nodeCount == 0)
+        return false;
+
+    // Model space ray; t is unchanged since the direction is scaled too
+    const double invScale = 1.0 / _scale;
+    const Math::Vector3D localOrigin((ray._origin._x - _offset._x) * invScale,
+                                     (ray._origin._y - _offset._y) * invScale,
+                                     (ray._origin._z - _offset._z) * invScale);
+    const Math::Vector3D localDirection = ray._direction * invScale;
+
+    const double origin[3] = {localOrigin._x, localOrigin._y, localOrigin._z};
+    const double invDir[3] = {1.0 / localDirection._x, 1.0 / localDirection._y, 1.0 / localDirection._z};
+
+    double closest = std::numeric_limits<double>::max();
+    double closestDet = 0.0;
+    double closestU = 0.0;
+    double closestV = 0.0;
+    int64_t closestTriangle = -1;
+
+    // Slab test against the node box, clipped to the closest hit so far
+    auto entersBox = [&](const Node& node) {
+        double tmin = 0.0;
+        double tmax = closest;
+        for (int axis = 0; axis < 3; ++axis) {
+            double t0 = (node.min[axis] - origin[axis]) * invDir[axis];
+            double t1 = (node.max[axis] - origin[axis]) * invDir[axis];
+            if (t0 > t1)
+                std::swap(t0, t1);
+            tmin = std::max(tmin, t0);
+            tmax = std::min(tmax, t1);
+            if (tmin > tmax)
+                return false;
+        }
+        return true;
+    };
+
+    uint32_t stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = _nodes[stack[--top]];
+        if (!entersBox(node))
+            continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.start; i < node.start + node.count; ++i) {
+                double t, det, u, v;
+                if (hitsTriangle(localOrigin, localDirection, i, t, det, u, v) && t < closest) {
+                    closest = t;
+                    closestDet = det;
+                    closestU = u;
+                    closestV = v;
+                    closestTriangle = i;
+                }
+            }
+        } else {
+            stack[top++] = node.start;
+            stack[top++] = static_cast<uint32_t>(&node - _nodes) + 1;
+        }
+    }
+    if (closestTriangle < 0)
+        return false;
+
+    const uint32_t* tri = &_indices[3 * closestTriangle];
+    const float* a = &_vertices[3 * tri[0]];
+    const float* b = &_vertices[3 * tri[1]];
+    const float* c = &_vertices[3 * tri[2]];
+    Math::Vector3D edge1(b[0] - a[0], b[1] - a[1], b[2] - a[2]);
+    Math::Vector3D edge2(c[0] - a[0], c[1] - a[1], c[2] - a[2]);
+    Math::Vector3D n = edge1.cross(edge2).normalize();
+    if (closestDet < 0.0)
+        n = n * -1.0;
+
+    // Interpolate the vertex attributes of the closest hit only
+    const double w = 1.0 - closestU - closestV;
+    if (_normals) {
+        const float* n0 = &_normals[3 * tri[0]];
+        const float* n1 = &_normals[3 * tri[1]];
+        const float* n2 = &_normals[3 * tri[2]];
+        Math::Vector3D smooth(w * n0[0] + closestU * n1[0] + closestV * n2[0],
+                              w * n0[1] + closestU * n1[1] + closestV * n2[1],
+                              w * n0[2] + closestU * n1[2] + closestV * n2[2]);
+        if (smooth.length2() > 1e-12) {
+            smooth = smooth.normalize();
+            n = smooth.dot(n) < 0.0 ? smooth * -1.0 : smooth;   // same side as the face
+        }
+    }
+    if (_uvs) {
+        hit.texU = w * _uvs[2 * tri[0]] + closestU * _uvs[2 * tri[1]] + closestV * _uvs[2 * tri[2]];
+        hit.texV = w * _uvs[2 * tri[0] + 1] + closestU * _uvs[2 * tri[1] + 1] + closestV * _uvs[2 * tri[2] + 1];
+    }
+
+    hit.t     = closest;
+    hit.p     = ray._origin + ray._direction * closest;
+    hit.n     = n;
+    hit.u     = closestU;
+    hit.v     = closestV;
+    hit.color = &_color;
+    return true;
+}
+
+const Color& RayTracer::Mesh::getColor() const
+{
+    return _color;
+}
+
+std::size_t RayTracer::Mesh::memoryUsage() const
+{
+    return _ownedVertices.capacity() * sizeof(float)
+         + _ownedIndices.capacity() * sizeof(uint32_t)
+         + _ownedNodes.capacity() * sizeof(Node)
+         + (_ownedNormals.capacity() + _ownedUVs.capacity()) * sizeof(float);
+}
@@ -0,0 +1,213 @@
+/*
+** MeshCache - Loads meshes on demand and keeps them under a memory budget
+*/
+
+#include "RayTracer/MeshCache.hpp"
+#include "Utils/Log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <utility>
+
+RayTracer::MeshCache::MeshCache(std::size_t budget)
+    : _budget(budget)
+{
+}
+
+std::size_t RayTracer::MeshCache::add(Loader loader)
+{
+    auto entry = std::make_unique<Entry>();
+    entry->loader = std::move(loader);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.push_back(std::move(entry));
+    return _entries.size() - 1;
+}
+
+void RayTracer::MeshCache::release(std::size_t slot)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry* entry = _entries[slot].get();
+    {
+        std::lock_guard<std::mutex> entryLock(entry->mutex);
+        entry->loader = nullptr;
+        entry->failed.store(true, std::memory_order_release);
+    }
+    drop(*entry);
+}
+
+RayTracer::MeshCache::Pass RayTracer::MeshCache::beginPass()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_passes[++_epoch];
+    return Pass(this, _epoch);
+}
+
+void RayTracer::MeshCache::endPass(uint64_t epoch)
+{
+    std::vector<Retired> freed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _passes.find(epoch);
+        if (--it->second == 0)
+            _passes.erase(it);
+        // Passes begun after a mesh was dropped never saw it
+        const uint64_t oldest = _passes.empty() ? _epoch + 1 : _passes.begin()->first;
+        auto stale = std::partition(_retired.begin(), _retired.end(),
+                                    [oldest](const Retired& r) { return r.epoch >= oldest; });
+        std::move(stale, _retired.end(), std::back_inserter(freed));
+        _retired.erase(stale, _retired.end());
+    }
+}
+
+RayTracer::MeshCache::Pass::Pass(Pass&& other) noexcept
+    : _cache(std::exchange(other._cache, nullptr)), _epoch(other._epoch)
+{
+}
+
+RayTracer::MeshCache::Pass& RayTracer::MeshCache::Pass::operator=(Pass&& other) noexcept
+{
+    if (this != &other) {
+        if (_cache)
+            _cache->endPass(_epoch);
+        _cache = std::exchange(other._cache, nullptr);
+        _epoch = other._epoch;
+    }
+    return *this;
+}
+
+RayTracer::MeshCache::Pass::~Pass()
+{
+    if (_cache)
+        _cache->endPass(_epoch);
+}
+
+const RayTracer::Mesh* RayTracer::MeshCache::acquire(std::size_t slot)
+{
+    Entry* entry = _entries[slot].get();
+
+    const uint64_t now = _clock.load(std::memory_order_relaxed);
+    if (entry->lastUse.load(std::memory_order_relaxed) != now)
+        entry->lastUse.store(now, std::memory_order_relaxed);
+
+    // Hot path: plain loads, the cache line stays shared between workers
+    if (const Mesh* mesh = entry->published.load(std::memory_order_acquire))
+        return mesh;
+    if (entry->failed.load(std::memory_order_acquire))
+        return nullptr;
+    return load(*entry, slot);
+}
+
+const RayTracer::Mesh* RayTracer::MeshCache::load(Entry& entry, std::size_t slot)
+{
+    const Mesh* mesh = nullptr;
+    std::size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        // Another caller may have loaded it while this one waited
+        if (entry.mesh || entry.failed.load(std::memory_order_relaxed))
+            return entry.mesh.get();
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            entry.mesh = entry.loader();
+        } catch (const std::exception& e) {
+            Utils::Log::error("Mesh load failed: ", e.what());
+        }
+        _loadNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+        if (!entry.mesh) {
+            entry.failed.store(true, std::memory_order_release);
+            return nullptr;
+        }
+        mesh = entry.mesh.get();
+        bytes = mesh->geometryBytes();
+        _buildNanos.fetch_add(static_cast<uint64_t>(mesh->buildSeconds() * 1e9), std::memory_order_relaxed);
+        entry.published.store(mesh, std::memory_order_release);
+    }
+
+    _loads.fetch_add(1, std::memory_order_relaxed);
+    // Stamp the load with the current clock and advance it, so that
+    // any mesh used from now on counts as more recent than this load
+    entry.lastUse.store(_clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        entry.bytes = bytes;
+        _resident += bytes;
+        enforceBudget(slot);
+    }
+    return mesh;
+}
+
+void RayTracer::MeshCache::enforceBudget(std::size_t keep)
+{
+    // Called with _mutex held; takes entry locks one at a time only
+    while (_budget != 0 && _resident > _budget) {
+        Entry* victim = nullptr;
+        for (std::size_t i = 0; i < _entries.size(); ++i) {
+            Entry* e = _entries[i].get();
+            if (i == keep || e->bytes == 0)
+                continue;
+            if (!victim || e->lastUse.load(std::memory_order_relaxed) < victim->lastUse.load(std::memory_order_relaxed))
+                victim = e;
+        }
+        if (!victim)
+            return;                 // only the mesh just loaded is left
+
+        drop(*victim);
+        _evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RayTracer::MeshCache::drop(Entry& entry)
+{
+    // Called with _mutex held. Running passes may have read the mesh:
+    // it is retired with the current epoch rather than freed
+    std::shared_ptr<Mesh> dropped;
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        entry.published.store(nullptr, std::memory_order_release);
+        dropped = std::move(entry.mesh);
+    }
+    _resident -= entry.bytes;
+    entry.bytes = 0;
+    if (dropped && !_passes.empty())
+        _retired.push_back({std::move(dropped), _epoch});
+}
+
+void RayTracer::MeshCache::setBudget(std::size_t budget)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = budget;
+    enforceBudget(_entries.size());
+}
+
+std::size_t RayTracer::MeshCache::budget() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget;
+}
+
+std::size_t RayTracer::MeshCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::size_t count = 0;
+    for (const auto& e : _entries)
+        count += e->loader != nullptr;
+    return count;
+}
+
+std::size_t RayTracer::MeshCache::residentCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::size_t count = 0;
+    for (const auto& e : _entries)
+        count += e->bytes != 0;
+    return count;
+}
+
+std::size_t RayTracer::MeshCache::residentBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _resident;
+}
@@ -0,0 +1,53 @@
+/*
+** MeshProxy - Stand-in for a mesh that is loaded the first time a ray reaches it
+*/
+
+#include "RayTracer/MeshProxy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+RayTracer::MeshProxy::MeshProxy(std::shared_ptr<MeshCache> cache, std::size_t slot,
+                                const double min[3], const double max[3], const Color& color)
+    : _cache(std::move(cache)), _slot(slot), _color(color)
+{
+    // Widen slightly so float rounding of the mesh cannot poke out of the box
+    for (int axis = 0; axis < 3; ++axis) {
+        double pad = 1e-6 * (std::abs(min[axis]) + std::abs(max[axis])) + 1e-9;
+        _min[axis] = min[axis] - pad;
+        _max[axis] = max[axis] + pad;
+    }
+}
+
+bool RayTracer::MeshProxy::hits(const Ray& ray, HitInfo& info) const
+{
+    const double origin[3] = {ray._origin._x, ray._origin._y, ray._origin._z};
+    const double direction[3] = {ray._direction._x, ray._direction._y, ray._direction._z};
+
+    double tmin = 0.0;
+    double tmax = std::numeric_limits<double>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        double inv = 1.0 / direction[axis];
+        double t0 = (_min[axis] - origin[axis]) * inv;
+        double t1 = (_max[axis] - origin[axis]) * inv;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tmin = std::max(tmin, t0);
+        tmax = std::min(tmax, t1);
+        if (tmin > tmax)
+            return false;
+    }
+
+    const Mesh* mesh = _cache->acquire(_slot);
+    if (!mesh || !mesh->hits(ray, info))
+        return false;
+
+    // The mesh may be freed once the pass ends; point at a color that stays
+    info.color = &_color;
+    return true;
+}
+
+const Color& RayTracer::MeshProxy::getColor() const
+{
+    return _color;
+}
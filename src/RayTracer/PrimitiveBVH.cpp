@@ -0,0 +1,298 @@
+/*
+** PrimitiveBVH - Bounding volume hierarchy over the primitives of a scene
+*/
+
+#include "RayTracer/PrimitiveBVH.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    constexpr double Far = std::numeric_limits<double>::max();
+
+    uint64_t maskOf(std::size_t n)
+    {
+        return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    }
+
+    // Entries sharing a kernel next to each other, in their original order otherwise
+    template <typename It>
+    void groupKernels(It begin, It end)
+    {
+        std::stable_sort(begin, end, [](const auto& a, const auto& b) {
+            return std::less<const void*>()(reinterpret_cast<const void*>(a.kernel),
+                                            reinterpret_cast<const void*>(b.kernel));
+        });
+    }
+}
+
+RayTracer::PrimitiveBVH::PrimitiveBVH(std::vector<Entry> entries)
+{
+    std::vector<Entry> bounded;
+    for (const Entry& entry : entries)
+        (entry.bounded ? bounded : _unbounded).push_back(entry);
+    groupKernels(_unbounded.begin(), _unbounded.end());
+    for (const Entry& entry : _unbounded)
+        _unboundedPrimitives.push_back(entry.primitive);
+
+    const uint32_t count = static_cast<uint32_t>(bounded.size());
+    if (count == 0)
+        return;
+
+    std::vector<double> centroids(3 * static_cast<std::size_t>(count));
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        order[i] = i;
+        for (int axis = 0; axis < 3; ++axis)
+            centroids[3 * i + axis] = 0.5 * (bounded[i].min[axis] + bounded[i].max[axis]);
+    }
+
+    _bounded = std::move(bounded);
+    _nodes.reserve(2 * (count / LeafSize + 1));
+    build(order, 0, count, centroids);
+
+    // Store the entries in leaf order so that leaves are contiguous
+    std::vector<Entry> sorted(count);
+    for (uint32_t i = 0; i < count; ++i)
+        sorted[i] = _bounded[order[i]];
+    _bounded = std::move(sorted);
+    for (const Node& node : _nodes)
+        if (node.count > 0)
+            groupKernels(_bounded.begin() + node.start, _bounded.begin() + node.start + node.count);
+    for (const Entry& entry : _bounded)
+        _boundedPrimitives.push_back(entry.primitive);
+    _nodes.shrink_to_fit();
+}
+
+uint32_t RayTracer::PrimitiveBVH::build(std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                                        const std::vector<double>& centroids)
+{
+    uint32_t index = static_cast<uint32_t>(_nodes.size());
+    _nodes.push_back(Node{});
+
+    Node node{};
+    double cmin[3], cmax[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        node.min[axis] = cmin[axis] = std::numeric_limits<double>::max();
+        node.max[axis] = cmax[axis] = std::numeric_limits<double>::lowest();
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+        const Entry& entry = _bounded[order[i]];
+        for (int axis = 0; axis < 3; ++axis) {
+            node.min[axis] = std::min(node.min[axis], entry.min[axis]);
+            node.max[axis] = std::max(node.max[axis], entry.max[axis]);
+            cmin[axis] = std::min(cmin[axis], centroids[3 * order[i] + axis]);
+            cmax[axis] = std::max(cmax[axis], centroids[3 * order[i] + axis]);
+        }
+    }
+
+    int axis = 0;
+    for (int a = 1; a < 3; ++a)
+        if (cmax[a] - cmin[a] > cmax[axis] - cmin[axis])
+            axis = a;
+
+    if (end - begin <= LeafSize || cmax[axis] <= cmin[axis]) {
+        node.start = begin;
+        node.count = end - begin;
+        _nodes[index] = node;
+        return index;
+    }
+
+    // Median split on the widest centroid axis
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [&](uint32_t a, uint32_t b) { return centroids[3 * a + axis] < centroids[3 * b + axis]; });
+
+    build(order, begin, mid, centroids);
+    node.start = build(order, mid, end, centroids);
+    node.count = 0;
+    _nodes[index] = node;
+    return index;
+}
+
+void RayTracer::PrimitiveBVH::intersectEntries(const Entry* entries, const IPrimitive* const* primitives,
+                                               std::size_t count, const Ray* rays, std::size_t n,
+                                               HitInfo* hits, uint64_t mask)
+{
+    thread_local std::vector<Ray> rayBatch;
+    thread_local std::vector<HitInfo> hitBatch;
+    thread_local std::vector<std::size_t> slots;
+
+    for (std::size_t i = 0, run; i < count; i = run) {
+        auto* kernel = entries[i].kernel;
+        for (run = i + 1; run < count && entries[run].kernel == kernel; ++run) {}
+
+        if (!kernel) {
+            for (std::size_t r = 0; r < n; ++r) {
+                if (!(mask >> r & 1))
+                    continue;
+                for (std::size_t k = i; k < run; ++k) {
+                    HitInfo hit;
+                    if (primitives[k]->hits(rays[r], hit) && hit.t < hits[r].t)
+                        hits[r] = hit;
+                }
+            }
+        } else if (mask == maskOf(n)) {
+            kernel(primitives + i, run - i, rays, n, hits);
+        } else {
+            // Only the rays that reached this leaf, packed for the kernel
+            rayBatch.clear();
+            hitBatch.clear();
+            slots.clear();
+            for (std::size_t r = 0; r < n; ++r) {
+                if (mask >> r & 1) {
+                    rayBatch.push_back(rays[r]);
+                    hitBatch.push_back(hits[r]);
+                    slots.push_back(r);
+                }
+            }
+            kernel(primitives + i, run - i, rayBatch.data(), rayBatch.size(), hitBatch.data());
+            for (std::size_t k = 0; k < slots.size(); ++k)
+                hits[slots[k]] = hitBatch[k];
+        }
+    }
+}
+
+uint64_t RayTracer::PrimitiveBVH::intersect(const Ray* rays, std::size_t n, HitInfo* hits) const
+{
+    n = std::min(n, MaxBatch);
+    double origin[MaxBatch][3];
+    double invDir[MaxBatch][3];
+    for (std::size_t r = 0; r < n; ++r) {
+        hits[r].t = Far;
+        const Ray& ray = rays[r];
+        origin[r][0] = ray._origin._x;
+        origin[r][1] = ray._origin._y;
+        origin[r][2] = ray._origin._z;
+        invDir[r][0] = 1.0 / ray._direction._x;
+        invDir[r][1] = 1.0 / ray._direction._y;
+        invDir[r][2] = 1.0 / ray._direction._z;
+    }
+    const uint64_t all = maskOf(n);
+
+    if (!_unbounded.empty())
+        intersectEntries(_unbounded.data(), _unboundedPrimitives.data(), _unbounded.size(), rays, n, hits, all);
+
+    // Slab test of every ray still active against the node box, clipped to its closest hit
+    auto entering = [&](const Node& node, uint64_t mask) {
+        uint64_t entered = 0;
+        for (std::size_t r = 0; r < n; ++r) {
+            if (!(mask >> r & 1))
+                continue;
+            double tmin = 0.0;
+            double tmax = hits[r].t;
+            int axis = 0;
+            for (; axis < 3; ++axis) {
+                double t0 = (node.min[axis] - origin[r][axis]) * invDir[r][axis];
+                double t1 = (node.max[axis] - origin[r][axis]) * invDir[r][axis];
+                if (t0 > t1)
+                    std::swap(t0, t1);
+                tmin = std::max(tmin, t0);
+                tmax = std::min(tmax, t1);
+                if (tmin > tmax)
+                    break;
+            }
+            if (axis == 3)
+                entered |= uint64_t(1) << r;
+        }
+        return entered;
+    };
+
+    if (!_nodes.empty()) {
+        struct Pending { uint32_t node; uint64_t mask; };
+        Pending stack[StackSize];
+        int top = 0;
+        stack[top++] = {0, all};
+        while (top > 0) {
+            Pending pending = stack[--top];
+            const Node& node = _nodes[pending.node];
+            uint64_t mask = entering(node, pending.mask);
+            if (!mask)
+                continue;
+
+            if (node.count > 0) {
+                intersectEntries(&_bounded[node.start], &_boundedPrimitives[node.start], node.count,
+                                 rays, n, hits, mask);
+            } else {
+                stack[top++] = {node.start, mask};
+                stack[top++] = {pending.node + 1, mask};
+            }
+        }
+    }
+
+    uint64_t found = 0;
+    for (std::size_t r = 0; r < n; ++r)
+        if (hits[r].t < Far)
+            found |= uint64_t(1) << r;
+    return found;
+}
+
+bool RayTracer::PrimitiveBVH::intersect(const Ray& ray, HitInfo& hit) const
+{
+    return intersect(&ray, 1, &hit) != 0;
+}
+
+bool RayTracer::PrimitiveBVH::occludedBy(const Entry* entries, const IPrimitive* const* primitives,
+                                         std::size_t count, const Ray& ray, double maxDist)
+{
+    for (std::size_t i = 0, run; i < count; i = run) {
+        auto* kernel = entries[i].kernel;
+        for (run = i + 1; run < count && entries[run].kernel == kernel; ++run) {}
+
+        HitInfo hit;
+        hit.t = maxDist;
+        if (kernel) {
+            kernel(primitives + i, run - i, &ray, 1, &hit);
+            if (hit.t < maxDist)
+                return true;
+            continue;
+        }
+        for (std::size_t k = i; k < run; ++k)
+            if (primitives[k]->hits(ray, hit) && hit.t < maxDist)
+                return true;
+    }
+    return false;
+}
+
+bool RayTracer::PrimitiveBVH::occluded(const Ray& ray, double maxDist) const
+{
+    if (occludedBy(_unbounded.data(), _unboundedPrimitives.data(), _unbounded.size(), ray, maxDist))
+        return true;
+    if (_nodes.empty())
+        return false;
+
+    const double origin[3] = {ray._origin._x, ray._origin._y, ray._origin._z};
+    const double invDir[3] = {1.0 / ray._direction._x, 1.0 / ray._direction._y, 1.0 / ray._direction._z};
+    auto entersBox = [&](const Node& node) {
+        double tmin = 0.0;
+        double tmax = maxDist;
+        for (int axis = 0; axis < 3; ++axis) {
+            double t0 = (node.min[axis] - origin[axis]) * invDir[axis];
+            double t1 = (node.max[axis] - origin[axis]) * invDir[axis];
+            if (t0 > t1)
+                std::swap(t0, t1);
+            tmin = std::max(tmin, t0);
+            tmax = std::min(tmax, t1);
+            if (tmin > tmax)
+                return false;
+        }
+        return true;
+    };
+
+    uint32_t stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        uint32_t index = stack[--top];
+        const Node& node = _nodes[index];
+        if (!entersBox(node))
+            continue;
+        if (node.count > 0) {
+            if (occludedBy(&_bounded[node.start], &_boundedPrimitives[node.start], node.count, ray, maxDist))
+                return true;
+        } else {
+            stack[top++] = node.start;
+            stack[top++] = index + 1;
+        }
+    }
+    return false;
+}
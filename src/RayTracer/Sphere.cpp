@@ -6,6 +6,8 @@
 */
 
 #include "RayTracer/Sphere.hpp"
+#include <cmath>
+#include <limits>
 
 RayTracer::Sphere::Sphere(const Math::Point3D &c, double r)
 {
@@ -27,25 +29,34 @@ RayTracer::Sphere::~Sphere()
 
 bool RayTracer::Sphere::hits(const Ray& r, HitInfo& hit) const
 {
+    double t = distance(r);
+    if (t == std::numeric_limits<double>::infinity()) return false;
+
+    hit.t     = t;
+    hit.p     = r._origin + r._direction * t;
+    hit.n     = Math::Vector3D(_center, hit.p).normalize();
+    hit.color = &_color;
+    return true;
+}
+
+double RayTracer::Sphere::distance(const Ray& r) const
+{
+    const double miss = std::numeric_limits<double>::infinity();
     Math::Vector3D oc(_center, r._origin);
     double a = r._direction.dot(r._direction);
     double b = 2.0 * oc.dot(r._direction);
     double c = oc.dot(oc) - _radius * _radius;
     double disc = b*b - 4*a*c;
-    if (disc < 0.0) return false;
+    if (disc < 0.0) return miss;
 
     double root = std::sqrt(disc);
     double inv2a = 1.0 / (2*a);
     double t = (-b - root) * inv2a;
     if (t < 1e-4) {
         t = (-b + root) * inv2a;
-        if (t < 1e-4) return false;
+        if (t < 1e-4) return miss;
     }
-    hit.t     = t;
-    hit.p     = r._origin + r._direction * t;
-    hit.n     = Math::Vector3D(_center, hit.p).normalize();
-    hit.color = &_color;
-    return true;
+    return t;
 }
 
 const Math::Point3D& RayTracer::Sphere::getCenter() const
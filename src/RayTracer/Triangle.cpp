@@ -6,6 +6,8 @@
 */
 
 #include "RayTracer/Triangle.hpp"
+#include <cmath>
+#include <limits>
 
 RayTracer::Triangle::Triangle()
 {
@@ -23,8 +25,25 @@ RayTracer::Triangle::~Triangle()
 {}
 
 bool RayTracer::Triangle::hits(const Ray& ray, HitInfo& hit) const
+{
+    double t = distance(ray);
+    if (t == std::numeric_limits<double>::infinity())
+        return false;
+
+    hit.t     = t;
+    hit.p     = ray._origin + ray._direction * t;
+    Math::Vector3D n = Math::Vector3D(_a, _b).cross(Math::Vector3D(_a, _c)).normalize();
+    // Facing the ray, as the sign of the determinant in distance() tells
+    hit.n     = (ray._direction.dot(n) > 0.0) ? n * -1.0 : n;
+    hit.color = &_color;
+
+    return true;
+}
+
+double RayTracer::Triangle::distance(const Ray& ray) const
 {
     const double EPSILON = 1e-8;
+    const double miss = std::numeric_limits<double>::infinity();
 
     Math::Vector3D edge1(_a, _b);
     Math::Vector3D edge2(_a, _c);
@@ -32,31 +51,22 @@ bool RayTracer::Triangle::hits(const Ray& ray, HitInfo& hit) const
     Math::Vector3D pvec = ray._direction.cross(edge2);
     double det = edge1.dot(pvec);
     if (std::abs(det) < EPSILON)
-        return false;
+        return miss;
 
     double invDet = 1.0 / det;
 
     Math::Vector3D tvec(_a, ray._origin);
     double u = invDet * tvec.dot(pvec);
     if (u < 0.0 || u > 1.0)
-        return false;
+        return miss;
 
     Math::Vector3D qvec = tvec.cross(edge1);
     double v = invDet * ray._direction.dot(qvec);
     if (v < 0.0 || u + v > 1.0)
-        return false;
+        return miss;
 
     double t = invDet * edge2.dot(qvec);
-    if (t < EPSILON)
-        return false;
-
-    hit.t     = t;
-    hit.p     = ray._origin + ray._direction * t;
-    Math::Vector3D n = edge1.cross(edge2).normalize();
-    hit.n     = (det < 0.0) ? n * -1.0 : n;
-    hit.color = &_color;
-
-    return true;
+    return t < EPSILON ? miss : t;
 }
 
 void RayTracer::Triangle::translate(const Math::Vector3D& offset)
@@ -0,0 +1,78 @@
+/*
+** BlueNoiseSampler - Implementation of the blue-noise rotated R2 sequence
+*/
+
+#include "Renderer/BlueNoiseSampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * Builds the mask with void filling: each rank goes to the empty cell
+ * with the lowest Gaussian energy from the cells already placed, on a
+ * torus so that the tile repeats seamlessly.
+ */
+BlueNoiseSampler::BlueNoiseSampler()
+    : _mask(TileSize * TileSize, 0.0)
+{
+    const int cells = TileSize * TileSize;
+    const double sigma = 1.5;
+
+    std::vector<double> kernel(cells);
+    for (int dy = 0; dy < TileSize; ++dy) {
+        for (int dx = 0; dx < TileSize; ++dx) {
+            int wx = std::min(dx, TileSize - dx);
+            int wy = std::min(dy, TileSize - dy);
+            kernel[dy * TileSize + dx] = std::exp(-(wx * wx + wy * wy) / (2.0 * sigma * sigma));
+        }
+    }
+
+    std::vector<double> energy(cells, 0.0);
+    std::vector<bool> filled(cells, false);
+    for (int rank = 0; rank < cells; ++rank) {
+        int best = -1;
+        double bestEnergy = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < cells; ++i) {
+            if (!filled[i] && energy[i] < bestEnergy) {
+                bestEnergy = energy[i];
+                best = i;
+            }
+        }
+        filled[best] = true;
+        _mask[best] = (rank + 0.5) / cells;
+
+        int bx = best % TileSize;
+        int by = best / TileSize;
+        for (int y = 0; y < TileSize; ++y) {
+            int dy = (y - by + TileSize) % TileSize;
+            for (int x = 0; x < TileSize; ++x) {
+                int dx = (x - bx + TileSize) % TileSize;
+                energy[y * TileSize + x] += kernel[dy * TileSize + dx];
+            }
+        }
+    }
+}
+
+void BlueNoiseSampler::prepare(int)
+{}
+
+SamplePoint BlueNoiseSampler::sample(int x, int y, int index) const
+{
+    // R2 sequence: generalized golden ratio in two dimensions
+    const double g = 1.32471795724474602596;
+    const double a1 = 1.0 / g;
+    const double a2 = 1.0 / (g * g);
+
+    // Second dimension reads the same tile at a fixed offset
+    return SamplePoint{
+        Sampling::wrap(0.5 + a1 * index + maskAt(x, y)),
+        Sampling::wrap(0.5 + a2 * index + maskAt(x + TileSize / 2, y + TileSize / 3))
+    };
+}
+
+double BlueNoiseSampler::maskAt(int x, int y) const
+{
+    int tx = ((x % TileSize) + TileSize) % TileSize;
+    int ty = ((y % TileSize) + TileSize) % TileSize;
+    return _mask[ty * TileSize + tx];
+}
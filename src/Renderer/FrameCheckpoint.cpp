@@ -0,0 +1,100 @@
+/*
+** FrameCheckpoint - Memory-mapped frame-buffer surviving a crashed render
+*/
+
+#include "Renderer/FrameCheckpoint.hpp"
+#include "Renderer/RendererExceptions.hpp"
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char Magic[8] = {'R', 'T', 'C', 'K', 'P', 'T', '\0', '\0'};
+    constexpr uint32_t Version = 1;
+}
+
+FrameCheckpoint::FrameCheckpoint(const std::string& path, int width, int height,
+                                 int tileSize, uint64_t key)
+    : _path(path)
+{
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    _tiles = tilesX * tilesY;
+
+    std::size_t words = (static_cast<std::size_t>(_tiles) + 63) / 64;
+    std::size_t pixelOffset = sizeof(Header) + words * sizeof(uint64_t);
+    pixelOffset = (pixelOffset + alignof(AccumPixel) - 1) / alignof(AccumPixel) * alignof(AccumPixel);
+    _size = pixelOffset + static_cast<std::size_t>(width) * height * sizeof(AccumPixel);
+
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0)
+        throw RendererException("Cannot open checkpoint " + path + ": " + std::strerror(errno));
+
+    Header expected{};
+    std::memcpy(expected.magic, Magic, sizeof(Magic));
+    expected.version = Version;
+    expected.width = width;
+    expected.height = height;
+    expected.tileSize = tileSize;
+    expected.key = key;
+
+    struct stat st{};
+    Header found{};
+    _resumed = ::fstat(_fd, &st) == 0 && static_cast<std::size_t>(st.st_size) == _size
+            && ::pread(_fd, &found, sizeof(found), 0) == static_cast<ssize_t>(sizeof(found))
+            && std::memcmp(&found, &expected, sizeof(Header)) == 0;
+
+    // A stale or foreign file starts over from zeros
+    if (!_resumed && (::ftruncate(_fd, 0) != 0 || ::ftruncate(_fd, static_cast<off_t>(_size)) != 0
+                      || ::pwrite(_fd, &expected, sizeof(expected), 0) != static_cast<ssize_t>(sizeof(expected)))) {
+        ::close(_fd);
+        throw RendererException("Cannot initialize checkpoint " + path + ": " + std::strerror(errno));
+    }
+
+    _map = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (_map == MAP_FAILED) {
+        ::close(_fd);
+        throw RendererException("Cannot map checkpoint " + path + ": " + std::strerror(errno));
+    }
+    _bitmap = reinterpret_cast<uint64_t*>(static_cast<char*>(_map) + sizeof(Header));
+    _pixels = reinterpret_cast<AccumPixel*>(static_cast<char*>(_map) + pixelOffset);
+}
+
+FrameCheckpoint::~FrameCheckpoint()
+{
+    if (_map)
+        ::munmap(_map, _size);
+    if (_fd >= 0)
+        ::close(_fd);
+}
+
+bool FrameCheckpoint::isTileDone(int tile) const
+{
+    uint64_t word = std::atomic_ref<uint64_t>(_bitmap[tile / 64]).load(std::memory_order_acquire);
+    return (word >> (tile % 64)) & 1u;
+}
+
+void FrameCheckpoint::markTileDone(int tile)
+{
+    std::atomic_ref<uint64_t>(_bitmap[tile / 64])
+        .fetch_or(uint64_t{1} << (tile % 64), std::memory_order_release);
+}
+
+int FrameCheckpoint::completedTiles() const
+{
+    int done = 0;
+    for (int word = 0; word * 64 < _tiles; ++word)
+        done += std::popcount(std::atomic_ref<uint64_t>(_bitmap[word]).load(std::memory_order_relaxed));
+    return done;
+}
+
+void FrameCheckpoint::remove()
+{
+    ::unlink(_path.c_str());
+}
@@ -0,0 +1,31 @@
+/*
+** HaltonSampler - Implementation of the rotated Halton sequence
+*/
+
+#include "Renderer/HaltonSampler.hpp"
+
+void HaltonSampler::prepare(int)
+{}
+
+SamplePoint HaltonSampler::sample(int x, int y, int index) const
+{
+    double shiftU = Sampling::toUnit(Sampling::hashPixel(x, y, 0x4a17));
+    double shiftV = Sampling::toUnit(Sampling::hashPixel(x, y, 0x0b3e));
+    return SamplePoint{
+        Sampling::wrap(radicalInverse(2, index) + shiftU),
+        Sampling::wrap(radicalInverse(3, index) + shiftV)
+    };
+}
+
+double HaltonSampler::radicalInverse(int base, int index)
+{
+    double inverseBase = 1.0 / base;
+    double factor = inverseBase;
+    double result = 0.0;
+    while (index > 0) {
+        result += (index % base) * factor;
+        index /= base;
+        factor *= inverseBase;
+    }
+    return result;
+}
@@ -6,53 +6,300 @@
 */
 
 #include "Renderer/Image.hpp"
+#include "Utils/Deflate.hpp"
+#include "Utils/FileIO.hpp"
+#include "Utils/PNG.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iterator>
 
 Image::Image(int width, int height)
-    : _width(width), _height(height), _pixels(width * height, Color{})
+    : _width(width), _height(height)
+    , _storage(static_cast<size_t>(width) * height), _data(_storage.data())
 {}
 
+Image::Image(int width, int height, AccumPixel* buffer)
+    : _width(width), _height(height), _data(buffer)
+{}
+
+Image::Image(const Image& other)
+    : _width(other._width), _height(other._height)
+    , _toneMap(other._toneMap), _exposure(other._exposure)
+    , _storage(other._data, other._data + other.pixelCount()), _data(_storage.data())
+{}
+
+Image::Image(Image&& other) noexcept
+    : _width(other._width), _height(other._height)
+    , _toneMap(other._toneMap), _exposure(other._exposure)
+    , _storage(std::move(other._storage))
+    , _data(_storage.empty() ? other._data : _storage.data())
+{}
+
+Image& Image::operator=(const Image& other)
+{
+    if (this != &other)
+        *this = Image(other);
+    return *this;
+}
+
+Image& Image::operator=(Image&& other) noexcept
+{
+    _width = other._width;
+    _height = other._height;
+    _toneMap = other._toneMap;
+    _exposure = other._exposure;
+    _storage = std::move(other._storage);
+    _data = _storage.empty() ? other._data : _storage.data();
+    return *this;
+}
+
 void Image::setPixel(int x, int y, const Color& c)
+{
+    setPixel(x, y, Color::Float(c));
+}
+
+void Image::setPixel(int x, int y, const Color::Float& c)
 {
     if (x < 0 || x >= _width || y < 0 || y >= _height)
         return;                                // silently ignore out-of-range
-    _pixels[y * _width + x] = c;
+    _data[y * _width + x] = AccumPixel{c, 1.f};
 }
 
 Color Image::getPixel(int x, int y) const
 {
     if (x < 0 || x >= _width || y < 0 || y >= _height)
         throw std::out_of_range("Image::getPixel");
-    return _pixels[y * _width + x];
+    Color::Float c = getPixelHDR(x, y);
+    return Color(quantize(c.r), quantize(c.g), quantize(c.b));
+}
+
+Color::Float Image::getPixelHDR(int x, int y) const
+{
+    if (x < 0 || x >= _width || y < 0 || y >= _height)
+        throw std::out_of_range("Image::getPixelHDR");
+    const AccumPixel& px = _data[y * _width + x];
+    if (px.weight <= 0.f)
+        return Color::Float();
+    return px.sum * (1.f / px.weight);
+}
+
+void Image::setToneMap(ToneMap op, float exposure)
+{
+    _toneMap = op;
+    _exposure = exposure;
+}
+
+uint8_t Image::quantize(float linear) const
+{
+    float v = std::max(0.f, linear * _exposure);
+    switch (_toneMap) {
+        case ToneMap::Reinhard:
+            v = v / (1.f + v);
+            break;
+        case ToneMap::Aces:
+            v = (v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f);
+            break;
+        case ToneMap::Clamp:
+            break;
+    }
+    return static_cast<uint8_t>(std::lround(std::clamp(v * 255.f, 0.f, 255.f)));
+}
+
+size_t Image::writePPM(const std::string& path) const
+{
+    std::string header = "P6\n" + std::to_string(_width) + ' '
+                       + std::to_string(_height) + "\n255\n";
+    std::vector<uint8_t> file(header.size() + pixelCount() * 3);
+    std::memcpy(file.data(), header.data(), header.size());
+    toRGB8(file.data() + header.size(), 0, _height);
+
+    Utils::writeFile(path, file.data(), file.size());
+    return file.size();
+}
+
+namespace {
+    template <typename T>
+    void putLE(std::vector<uint8_t>& out, T v)
+    {
+        static_assert(std::endian::native == std::endian::little);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&v);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void putEXRAttribute(std::vector<uint8_t>& out, const char* name,
+                         const char* type, const std::vector<uint8_t>& value)
+    {
+        out.insert(out.end(), name, name + std::strlen(name) + 1);
+        out.insert(out.end(), type, type + std::strlen(type) + 1);
+        putLE<int32_t>(out, static_cast<int32_t>(value.size()));
+        out.insert(out.end(), value.begin(), value.end());
+    }
+}
+
+size_t Image::writePNG(const std::string& path) const
+{
+    const size_t stride = static_cast<size_t>(_width) * 3;
+    const int strips = (_height + Utils::PNG::StripRows - 1) / Utils::PNG::StripRows;
+    std::vector<uint8_t> rgb = toRGB8();
+
+    // Strips are independent deflate streams: compress them in parallel
+    std::vector<Utils::PNG::Strip> compressed(strips);
+    Utils::ThreadPool::global().parallelFor(strips, [&](size_t i) {
+        int first = static_cast<int>(i) * Utils::PNG::StripRows;
+        int rows = std::min(Utils::PNG::StripRows, _height - first);
+        compressed[i] = Utils::PNG::compressStrip(rgb.data() + first * stride, _width, rows,
+                                                  static_cast<int>(i) == strips - 1);
+    });
+
+    std::vector<uint8_t> idat(std::begin(Utils::PNG::ZlibHeader), std::end(Utils::PNG::ZlibHeader));
+    uint32_t adler = 1;
+    for (const Utils::PNG::Strip& strip : compressed) {
+        idat.insert(idat.end(), strip.data.begin(), strip.data.end());
+        adler = Utils::adler32Combine(adler, strip.adler, strip.rawSize);
+    }
+    if (strips == 0)
+        idat = Utils::zlibCompress(nullptr, 0);
+    else
+        Utils::PNG::appendAdler(idat, adler);
+
+    std::vector<uint8_t> file = Utils::PNG::header(_width, _height);
+    file.reserve(file.size() + idat.size() + 24);
+    Utils::PNG::appendChunk(file, "IDAT", idat.data(), idat.size());
+    Utils::PNG::appendChunk(file, "IEND", nullptr, 0);
+
+    Utils::writeFile(path, file.data(), file.size());
+    return file.size();
+}
+
+size_t Image::writeEXR(const std::string& path) const
+{
+    std::vector<uint8_t> file = {0x76, 0x2F, 0x31, 0x01};
+    putLE<int32_t>(file, 2);                    // version 2, single-part scanline
+
+    std::vector<uint8_t> channels;
+    for (const char* name : {"B", "G", "R"}) {  // channels are sorted by name
+        channels.insert(channels.end(), name, name + 2);
+        putLE<int32_t>(channels, 2);            // FLOAT
+        channels.insert(channels.end(), {0, 0, 0, 0});  // pLinear + reserved
+        putLE<int32_t>(channels, 1);            // x sampling
+        putLE<int32_t>(channels, 1);            // y sampling
+    }
+    channels.push_back(0);
+    std::vector<uint8_t> window;
+    for (int32_t v : {0, 0, _width - 1, _height - 1})
+        putLE<int32_t>(window, v);
+    std::vector<uint8_t> one, center;
+    putLE<float>(one, 1.f);
+    putLE<float>(center, 0.f);
+    putLE<float>(center, 0.f);
+
+    putEXRAttribute(file, "channels", "chlist", channels);
+    putEXRAttribute(file, "compression", "compression", {0});
+    putEXRAttribute(file, "dataWindow", "box2i", window);
+    putEXRAttribute(file, "displayWindow", "box2i", window);
+    putEXRAttribute(file, "lineOrder", "lineOrder", {0});
+    putEXRAttribute(file, "pixelAspectRatio", "float", one);
+    putEXRAttribute(file, "screenWindowCenter", "v2f", center);
+    putEXRAttribute(file, "screenWindowWidth", "float", one);
+    file.push_back(0);
+
+    // Uncompressed files store one scanline per chunk: y, size, B row, G row, R row
+    const size_t lineBytes = static_cast<size_t>(_width) * 3 * sizeof(float);
+    const size_t chunkBytes = 2 * sizeof(int32_t) + lineBytes;
+    size_t offsets = file.size();
+    size_t data = offsets + static_cast<size_t>(_height) * sizeof(uint64_t);
+    file.resize(data + chunkBytes * _height);
+
+    for (int y = 0; y < _height; ++y) {
+        uint64_t chunk = data + chunkBytes * y;
+        std::memcpy(file.data() + offsets + y * sizeof(uint64_t), &chunk, sizeof(chunk));
+
+        uint8_t* dst = file.data() + chunk;
+        int32_t header[2] = {y, static_cast<int32_t>(lineBytes)};
+        std::memcpy(dst, header, sizeof(header));
+        float* b = reinterpret_cast<float*>(dst + sizeof(header));
+        float* g = b + _width;
+        float* r = g + _width;
+        for (int x = 0; x < _width; ++x) {
+            Color::Float c = getPixelHDR(x, y);
+            b[x] = c.b;
+            g[x] = c.g;
+            r[x] = c.r;
+        }
+    }
+
+    Utils::writeFile(path, file.data(), file.size());
+    return file.size();
 }
 
-void Image::writePPM(const std::string& path) const
+std::string Image::extension(const std::string& path)
 {
-    std::ofstream out(path, std::ios::out | std::ios::trunc);
-    if (!out)
-        throw std::runtime_error("Cannot open file for writing: " + path);
+    size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+bool Image::isSupportedFormat(const std::string& path)
+{
+    std::string ext = extension(path);
+    return ext == "ppm" || ext == "png" || ext == "exr";
+}
+
+size_t Image::save(const std::string& path) const
+{
+    std::string ext = extension(path);
+    if (ext == "ppm")
+        return writePPM(path);
+    if (ext == "png")
+        return writePNG(path);
+    if (ext == "exr")
+        return writeEXR(path);
+    throw std::invalid_argument("Unsupported image format: " + path);
+}
+
+std::vector<uint8_t> Image::toRGB8() const
+{
+    std::vector<uint8_t> data(pixelCount() * 3);
+    toRGB8(data.data(), 0, _height);
+    return data;
+}
 
-    out << "P3\n" << _width << ' ' << _height << "\n255\n";
-    for (const Color& col : _pixels)
-        out << static_cast<int>(col.getR()) << ' '
-            << static_cast<int>(col.getG()) << ' '
-            << static_cast<int>(col.getB()) << '\n';
+void Image::toRGB8(uint8_t* out, int firstRow, int rows) const
+{
+    const AccumPixel* px = _data + static_cast<size_t>(firstRow) * _width;
+    const AccumPixel* end = px + static_cast<size_t>(rows) * _width;
+
+    for (; px != end; ++px) {
+        float inv = px->weight > 0.f ? 1.f / px->weight : 0.f;
+        *out++ = quantize(px->sum.r * inv);
+        *out++ = quantize(px->sum.g * inv);
+        *out++ = quantize(px->sum.b * inv);
+    }
 }
 
 std::vector<uint8_t> Image::toRGBA() const {
-    std::vector<uint8_t> data;
-    data.reserve(_width * _height * 4);
+    return toRGBA(0, 0, _width, _height);
+}
 
-    auto clamp = [](int v) -> uint8_t {
-        if (v < 0) return 0;
-        if (v > 255) return 255;
-        return static_cast<uint8_t>(v);
-    };
+std::vector<uint8_t> Image::toRGBA(int x, int y, int w, int h) const {
+    std::vector<uint8_t> data;
+    data.reserve(static_cast<size_t>(w) * h * 4);
 
-    for (const auto& px : _pixels) {
-        data.push_back(clamp(px.getR()));
-        data.push_back(clamp(px.getG()));
-        data.push_back(clamp(px.getB()));
-        data.push_back(255);
+    for (int row = y; row < y + h; ++row) {
+        for (int col = x; col < x + w; ++col) {
+            const AccumPixel& px = _data[row * _width + col];
+            float inv = px.weight > 0.f ? 1.f / px.weight : 0.f;
+            data.push_back(quantize(px.sum.r * inv));
+            data.push_back(quantize(px.sum.g * inv));
+            data.push_back(quantize(px.sum.b * inv));
+            data.push_back(255);
+        }
     }
     return data;
-}
\ No newline at end of file
+}
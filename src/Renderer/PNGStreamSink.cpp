@@ -0,0 +1,103 @@
+/*
+** PNGStreamSink - PNG compressed in parallel while the render goes on
+*/
+
+#include "Renderer/PNGStreamSink.hpp"
+#include "Utils/Deflate.hpp"
+#include "Utils/ThreadPool.hpp"
+#include <chrono>
+#include <stdexcept>
+
+void PNGStreamSink::Strip::run(int width)
+{
+    if (claimed.exchange(true))
+        return;
+    try {
+        result = Utils::PNG::compressStrip(rgb.data(), width, rows, last);
+        std::vector<uint8_t>().swap(rgb);
+        promise.set_value();
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+PNGStreamSink::PNGStreamSink(const std::string& path)
+    : _path(path)
+{}
+
+void PNGStreamSink::begin(int width, int height)
+{
+    _out.open(_path, std::ios::binary | std::ios::trunc);
+    if (!_out)
+        throw std::runtime_error("Cannot open file for writing: " + _path);
+    _width = width;
+    _height = height;
+    write(Utils::PNG::header(width, height));
+}
+
+void PNGStreamSink::writeRows(int firstRow, int rows, const uint8_t* rgb)
+{
+    if (firstRow != _nextRow)
+        throw std::runtime_error("PNG bands must be written top to bottom: " + _path);
+    _nextRow += rows;
+
+    auto strip = std::make_shared<Strip>();
+    strip->rgb.assign(rgb, rgb + static_cast<std::size_t>(_width) * 3 * rows);
+    strip->rows = rows;
+    strip->last = _nextRow == _height;
+    _pending.push_back(strip);
+
+    int width = _width;
+    Utils::ThreadPool::global().submit([strip, width] { strip->run(width); });
+    flush(false);
+}
+
+void PNGStreamSink::end()
+{
+    flush(true);
+    std::vector<uint8_t> tail;
+    if (_height == 0) {
+        std::vector<uint8_t> empty = Utils::zlibCompress(nullptr, 0);
+        Utils::PNG::appendChunk(tail, "IDAT", empty.data(), empty.size());
+    }
+    Utils::PNG::appendChunk(tail, "IEND", nullptr, 0);
+    write(tail);
+    _out.close();
+    if (!_out)
+        throw std::runtime_error("Cannot write " + _path);
+}
+
+void PNGStreamSink::flush(bool wait)
+{
+    while (!_pending.empty()) {
+        Strip& strip = *_pending.front();
+        if (wait)
+            strip.run(_width);      // no-op if a worker already has it
+        else if (strip.done.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+        strip.done.get();
+
+        // One IDAT per strip; together they form a single zlib stream
+        std::vector<uint8_t> payload;
+        if (_first)
+            payload.assign(std::begin(Utils::PNG::ZlibHeader), std::end(Utils::PNG::ZlibHeader));
+        _first = false;
+        payload.insert(payload.end(), strip.result.data.begin(), strip.result.data.end());
+        _adler = Utils::adler32Combine(_adler, strip.result.adler, strip.result.rawSize);
+        if (strip.last)
+            Utils::PNG::appendAdler(payload, _adler);
+
+        std::vector<uint8_t> chunk;
+        Utils::PNG::appendChunk(chunk, "IDAT", payload.data(), payload.size());
+        write(chunk);
+        _pending.pop_front();
+    }
+}
+
+void PNGStreamSink::write(const std::vector<uint8_t>& bytes)
+{
+    _out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!_out)
+        throw std::runtime_error("Cannot write " + _path);
+    _written += bytes.size();
+}
@@ -0,0 +1,67 @@
+/*
+** PPMStreamSink - Binary PPM written in place, band by band
+*/
+
+#include "Renderer/PPMStreamSink.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+PPMStreamSink::PPMStreamSink(const std::string& path)
+    : _path(path)
+{}
+
+PPMStreamSink::~PPMStreamSink()
+{
+    if (_fd >= 0)
+        ::close(_fd);
+}
+
+void PPMStreamSink::begin(int width, int height)
+{
+    _fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (_fd < 0)
+        throw std::runtime_error("Cannot open file for writing: " + _path);
+
+    std::string header = "P6\n" + std::to_string(width) + ' '
+                       + std::to_string(height) + "\n255\n";
+    _height = height;
+    _rowBytes = static_cast<std::size_t>(width) * 3;
+    _dataOffset = header.size();
+
+    // Reserve the whole file up front so that bands can land anywhere
+    if (::ftruncate(_fd, static_cast<off_t>(size())) != 0)
+        throw std::runtime_error("Cannot resize " + _path + ": " + std::strerror(errno));
+    writeAt(header.data(), header.size(), 0);
+}
+
+void PPMStreamSink::writeRows(int firstRow, int rows, const uint8_t* rgb)
+{
+    writeAt(rgb, _rowBytes * rows, _dataOffset + _rowBytes * firstRow);
+}
+
+void PPMStreamSink::end()
+{
+    int fd = _fd;
+    _fd = -1;
+    if (::close(fd) != 0)
+        throw std::runtime_error("Cannot write " + _path + ": " + std::strerror(errno));
+}
+
+void PPMStreamSink::writeAt(const void* data, std::size_t size, std::size_t offset)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::pwrite(_fd, bytes, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("Cannot write " + _path + ": " + std::strerror(errno));
+        }
+        bytes += written;
+        offset += static_cast<std::size_t>(written);
+        size -= static_cast<std::size_t>(written);
+    }
+}
@@ -0,0 +1,140 @@
+/*
+** RenderJob - Implementation of the asynchronous render handle
+*/
+
+#include "Renderer/RenderJob.hpp"
+#include "Renderer/RendererExceptions.hpp"
+
+RenderJob::RenderJob(Image frame, int tileSize, std::vector<RenderPass> passes,
+                     std::shared_ptr<const ISampler> sampler,
+                     ProgressCallback progress, PassCallback onPass)
+    : _frame(std::move(frame))
+    , _lumaSq(static_cast<size_t>(_frame.width()) * _frame.height(), 0.f)
+    , _samples(static_cast<size_t>(_frame.width()) * _frame.height(), 0)
+    , _converged(static_cast<size_t>(_frame.width()) * _frame.height(), 0)
+    , _tileSize(tileSize)
+    , _tilesX((_frame.width() + tileSize - 1) / tileSize)
+    , _tilesY((_frame.height() + tileSize - 1) / tileSize)
+    , _passes(std::move(passes))
+    , _sampler(std::move(sampler))
+    , _progress(std::move(progress))
+    , _onPass(std::move(onPass))
+    , _future(_promise.get_future())
+{}
+
+std::future<Image>& RenderJob::future()
+{
+    return _future;
+}
+
+Image RenderJob::get()
+{
+    return _future.get();
+}
+
+void RenderJob::wait() const
+{
+    if (_future.valid())
+        _future.wait();
+}
+
+bool RenderJob::isDone() const
+{
+    return !_future.valid()
+        || _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void RenderJob::cancel()
+{
+    _cancelled = true;
+}
+
+bool RenderJob::isCancelled() const
+{
+    return _cancelled;
+}
+
+int RenderJob::completedTiles() const
+{
+    return _completed;
+}
+
+int RenderJob::totalTiles() const
+{
+    return tileCount();
+}
+
+const std::vector<RenderPass>& RenderJob::passes() const
+{
+    return _passes;
+}
+
+double RenderJob::averageSamplesPerPixel() const
+{
+    if (_samples.empty())
+        return 0.0;
+    return static_cast<double>(_samplesTraced) / static_cast<double>(_samples.size());
+}
+
+const Image& RenderJob::frame() const
+{
+    return _frame;
+}
+
+void RenderJob::tileDone(int x, int y, int width, int height, int frameY)
+{
+    int completed = ++_completed;
+    if (!_progress)
+        return;
+    // Quantized while this worker still owns the tile: a later pass may
+    // rewrite it as soon as the callback returns
+    TileProgress tile{x, y, width, height, _pass, completed, tileCount(),
+                      _frame.toRGBA(x, frameY, width, height)};
+    std::lock_guard<std::mutex> lock(_progressMutex);
+    _progress(tile);
+}
+
+void RenderJob::fail(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(_errorMutex);
+    if (!_error)
+        _error = error;
+    _cancelled = true;              // no point rendering the remaining tiles
+}
+
+/**
+ * Called by every worker leaving the current pass. The last one out
+ * publishes the pass, then either settles the future or moves the job to
+ * the next pass, in which case it returns true and the caller must
+ * schedule the workers again.
+ */
+bool RenderJob::workerFinished()
+{
+    if (--_activeWorkers != 0)
+        return false;
+    _meshPass = {};                 // no ray of the pass is left
+
+    bool passComplete = _completed == (_pass + 1) * tilesPerPass();
+    if (passComplete && _onPass) {
+        try {
+            _onPass(currentPass(), _frame);
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    }
+
+    if (_error) {
+        _promise.set_exception(_error);
+    } else if (!passComplete) {
+        _promise.set_exception(std::make_exception_ptr(RenderCancelledException()));
+    } else if (_pass + 1 == static_cast<int>(_passes.size())) {
+        _promise.set_value(_frame);
+    } else if (_cancelled) {
+        _promise.set_exception(std::make_exception_ptr(RenderCancelledException()));
+    } else {
+        _nextTile = 0;
+        ++_pass;
+        return true;
+    }
+    return false;
+}
@@ -3,214 +3,436 @@
 */
 
 #include "Renderer/Renderer.hpp"
-#include <thread>
-#include <vector>
-#include <mutex>
-#include <queue>
+#include "Renderer/SobolSampler.hpp"
+#include "Utils/ThreadPool.hpp"
+#include "Utils/Hash.hpp"
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
 
 /**
  * @brief Constructor for the renderer
  * @param w Width of the output image in pixels
  * @param h Height of the output image in pixels
+ * @param samplesPerPixel Samples per pixel (maximum when adaptive sampling is on)
  */
-Renderer::Renderer(int w, int h, int samplesPerPixel) : _w(w), _h(h), _samplesPerPixel(samplesPerPixel) {}
-
-// Structure to hold shared rendering data using references to avoid const issues
-struct ThreadData {
-    const Scene& scene;
-    const std::shared_ptr<RayTracer::Camera>& camera;
-    Image& frame;
-    int blockSize;
-    int width;
-    int height;
-    std::queue<std::pair<int, int>>& blockQueue;
-    std::mutex& queueMutex;
-    std::mutex& frameMutex;
-    std::atomic<int>& blocksCompleted;
-    int totalBlocks;
-};
+Renderer::Renderer(int w, int h, int samplesPerPixel)
+    : _w(w), _h(h)
+    , _samplesPerPixel(std::clamp(samplesPerPixel, 1, static_cast<int>(UINT16_MAX)))  // per-pixel counts are 16-bit
+{
+    setSampler(std::make_shared<SobolSampler>());
+}
+
+void Renderer::setSampler(std::shared_ptr<ISampler> sampler)
+{
+    sampler->prepare(_samplesPerPixel);
+    _sampler = std::move(sampler);
+}
+
+void Renderer::setToneMap(ToneMap op, float exposure)
+{
+    _toneMap = op;
+    _exposure = exposure;
+}
+
+void Renderer::setAdaptiveSampling(int minSamples, double threshold)
+{
+    _minSamples = std::max(0, minSamples);
+    _varianceThreshold = threshold;
+}
 
 /**
- * @brief Worker function to process blocks of the image
- * @param renderer Pointer to the renderer
- * @param data Thread shared data
+ * @brief Worker loop: claims tiles of the current pass until none are left
+ * @param scene The scene to render
+ * @param camera The camera defining the viewpoint
+ * @param job Job shared by every worker of this render
  */
-void Renderer::processBlocks(const Renderer* renderer, const ThreadData& data) {
-    while (true) {
-        // Get next block to render (thread-safe)
-        std::pair<int, int> block;
-        {
-            std::lock_guard<std::mutex> lock(data.queueMutex);
-            if (data.blockQueue.empty()) {
-                break; // No more blocks to process
+void Renderer::renderTiles(const Scene& scene,
+                           const std::shared_ptr<RayTracer::Camera>& camera,
+                           const std::shared_ptr<RenderJob>& job) const
+{
+    try {
+        int tile;
+        while (!job->isCancelled() && (tile = job->_nextTile++) < job->tilesPerPass())
+            renderTile(scene, *camera, *job, tile);
+    } catch (...) {
+        job->fail(std::current_exception());
+    }
+    // The last worker of a pass starts the next one, if any
+    if (job->workerFinished())
+        schedulePass(scene, camera, job);
+}
+
+/**
+ * @brief Renders one tile of the current pass straight into the job frame
+ *
+ * Tiles never overlap and passes never run concurrently, so workers write
+ * their pixels without locking.
+ */
+void Renderer::renderTile(const Scene& scene,
+                          const RayTracer::Camera& camera,
+                          RenderJob& job,
+                          int tile) const
+{
+    const RenderPass& pass = job.currentPass();
+
+    // Calculate this block's coordinates
+    int blockX = tile % job._tilesX;
+    int blockY = tile / job._tilesX;
+    // A job may only cover the band of rows [originY, frameEnd)
+    int frameEnd = job._originY + job._frame.height();
+    int startX = blockX * job._tileSize;
+    int startY = job._originY + blockY * job._tileSize;
+    int endX = std::min(startX + job._tileSize, _w);
+    int endY = std::min(startY + job._tileSize, frameEnd);
+
+    if (pass.scale > 1) {
+        // Preview: one ray per scale x scale block, nothing accumulated
+        for (int by = startY; by < endY; by += pass.scale) {
+            for (int bx = startX; bx < endX; bx += pass.scale) {
+                double u = (bx + 0.5 * pass.scale) / (_w - 1);
+                double v = (by + 0.5 * pass.scale) / (_h - 1);
+                RayTracer::Ray ray = camera.ray(u, v);
+                HitInfo hit;
+                Color::Float color = tracePrimaryRay(scene, ray, hit)
+                    ? shadePixel(scene, hit) : writeBackground();
+                for (int y = by; y < std::min(by + pass.scale, endY); ++y)
+                    for (int x = bx; x < std::min(bx + pass.scale, endX); ++x)
+                        job._frame.setPixel(x, frameEnd - 1 - y, color);
             }
-            block = data.blockQueue.front();
-            data.blockQueue.pop();
         }
+        job.tileDone(startX, _h - endY, endX - startX, endY - startY, frameEnd - endY);
+        return;
+    }
 
-        // Calculate this block's coordinates
-        int blockX = block.first;
-        int blockY = block.second;
-        int startX = blockX * data.blockSize;
-        int startY = blockY * data.blockSize;
-        int endX = std::min(startX + data.blockSize, data.width);
-        int endY = std::min(startY + data.blockSize, data.height);
-
-        // Use local buffer to minimize lock time
-        std::vector<Color> blockBuffer((endX - startX) * (endY - startY));
-
-        // Calculate the size of the sampling grid
-        int gridSize = static_cast<int>(std::sqrt(renderer->_samplesPerPixel));
-        // Render all pixels in this block
-        for (int y = startY; y < endY; ++y) {
-            double v = static_cast<double>(y) / (data.height - 1);
-            for (int x = startX; x < endX; ++x) {
-                double u = static_cast<double>(x) / (data.width - 1);
-                RayTracer::Ray ray = data.camera->ray(u, v);
+    if (job._checkpoint && job._checkpoint->isTileDone(tile)) {
+        // Restored from an earlier run
+        job.tileDone(startX, _h - endY, endX - startX, endY - startY, frameEnd - endY);
+        return;
+    }
 
-                HitInfo hit;
-                Color::Float pixel(0.f, 0.f, 0.f);
-                // shoot multiple rays per pixel for antialiasing
-                for (int s = 0; s < renderer->_samplesPerPixel; ++s) {
-                    int sx = s % gridSize;
-                    int sy = s / gridSize;
-                    double offsetU = (sx + 0.5) / gridSize - 0.5;
-                    double offsetV = (sy + 0.5) / gridSize - 0.5;
-                    double u = (x + 0.5 + offsetU) / (data.width - 1);
-                    double v = (y + 0.5 + offsetV) / (data.height - 1);
-
-                    RayTracer::Ray ray = data.camera->ray(u, v);
-                    HitInfo hit;
-                    Color sampleColor;
-                    // Trace the ray into the scene and determine the color
-                    if (renderer->tracePrimaryRay(data.scene, ray, hit))
-                        sampleColor = renderer->shadePixel(data.scene, hit);
-                    else
-                        sampleColor = renderer->writeBackground();
-                    pixel += Color::Float(sampleColor);
+    const ISampler& sampler = *job._sampler;
+    long long traced = 0;
+    std::vector<RayTracer::Ray> rays;
+    HitInfo hits[RayBatch];
+    // Render all pixels in this block
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            size_t idx = static_cast<size_t>(y - job._originY) * _w + x;
+            if (job._converged[idx])
+                continue;               // adaptive sampling already settled it
+
+            // Samples are summed straight into the HDR frame, which divides
+            // by the weight only when it is read back
+            AccumPixel& pixel = job._frame.at(x, frameEnd - 1 - y);
+            float& lumaSq = job._lumaSq[idx];
+            uint16_t& n = job._samples[idx];
+            if (n == 0)
+                pixel = AccumPixel{};   // drop the preview value, if any
+            // shoot multiple rays per pixel for antialiasing, traced
+            // together up to the next convergence test: once _minSamples
+            // are in, then each time the count doubles, so that batches
+            // grow back to RayBatch
+            bool converged = false;
+            while (n < pass.endSample && !converged) {
+                int batch = std::min(pass.endSample - n, RayBatch);
+                if (_minSamples > 0)
+                    batch = std::min(batch, n < _minSamples ? _minSamples - n : static_cast<int>(n));
+                rays.clear();
+                for (int s = 0; s < batch; ++s) {
+                    SamplePoint offset = sampler.sample(x, y, n + s);
+                    double u = (x + offset.u) / (_w - 1);
+                    double v = (y + offset.v) / (_h - 1);
+                    rays.push_back(camera.ray(u, v));
                 }
+                uint64_t found = scene.intersect(rays.data(), batch, hits);
 
-                // Store in local buffer
-                int localX = x - startX;
-                int localY = y - startY;
-                Color finalColor = (pixel * (1.0f / renderer->_samplesPerPixel)).toColor();
-                blockBuffer[localY * (endX - startX) + localX] = finalColor;
-            }
-        }
+                for (int s = 0; s < batch; ++s) {
+                    // Determine the color of each ray
+                    Color::Float sample = (found >> s & 1) ? shadePixel(scene, hits[s]) : writeBackground();
+                    pixel.sum += sample;
+                    pixel.weight += 1.f;
+                    float luma = sample.luminance();
+                    lumaSq += luma * luma;
+                    ++n;
+                    ++traced;
+                }
 
-        {
-            std::lock_guard<std::mutex> lock(data.frameMutex);
-            for (int y = startY; y < endY; ++y) {
-                for (int x = startX; x < endX; ++x) {
-                    int localX = x - startX;
-                    int localY = y - startY;
-                    data.frame.setPixel(x, data.height - 1 - y,
-                                       blockBuffer[localY * (endX - startX) + localX]);
+                if (_minSamples > 0 && n >= _minSamples && isConverged(pixel.sum, lumaSq, n)) {
+                    job._converged[idx] = 1;
+                    converged = true;
                 }
             }
         }
+    }
+    job._samplesTraced += traced;
+    if (job._checkpoint)
+        job._checkpoint->markTileDone(tile);
 
-        int completed = ++(data.blocksCompleted);
-        if (completed % 10 == 0 || completed == data.totalBlocks) {
-            float progress = 100.0f * completed / data.totalBlocks;
-            std::cout << "\rRendering progress: " << progress << "% ("
-                      << completed << "/" << data.totalBlocks << " blocks)" << std::flush;
-        }
+    // Rows are flipped on write, report the tile in image space
+    job.tileDone(startX, _h - endY, endX - startX, endY - startY, frameEnd - endY);
+}
+
+/**
+ * @brief Submits one worker per pool thread for the current pass of a job
+ */
+void Renderer::schedulePass(const Scene& scene,
+                            const std::shared_ptr<RayTracer::Camera>& cam,
+                            const std::shared_ptr<RenderJob>& job) const
+{
+    Utils::ThreadPool& pool = Utils::ThreadPool::global();
+    int workers = std::min(static_cast<int>(pool.size()), job->tilesPerPass());
+
+    job->_meshPass = scene.beginPass();
+    job->_activeWorkers = workers;
+    for (int i = 0; i < workers; ++i) {
+        pool.submit([this, &scene, cam, job] {
+            renderTiles(scene, cam, job);
+        });
     }
 }
 
 /**
- * @brief Renders a scene using multithreaded block-based approach
+ * @brief Creates a job for the given passes and schedules its first pass
+ */
+std::shared_ptr<RenderJob> Renderer::startJob(const Scene& scene,
+                      const std::shared_ptr<RayTracer::Camera>& cam,
+                      std::vector<RenderPass> passes,
+                      RenderJob::ProgressCallback progress,
+                      RenderJob::PassCallback onPass,
+                      int originY, int rows,
+                      std::shared_ptr<FrameCheckpoint> checkpoint) const
+{
+    int height = rows < 0 ? _h : rows;
+    Image frame = checkpoint ? Image(_w, height, checkpoint->pixels()) : Image(_w, height);
+    auto job = std::make_shared<RenderJob>(std::move(frame), BlockSize,
+                                           std::move(passes), _sampler,
+                                           std::move(progress), std::move(onPass));
+    job->_originY = originY;
+    job->_checkpoint = std::move(checkpoint);
+    job->_frame.setToneMap(_toneMap, _exposure);
+
+    if (job->tilesPerPass() == 0) {
+        // Empty frame: nothing to schedule, publish right away
+        job->_pass = static_cast<int>(job->_passes.size()) - 1;
+        job->_activeWorkers = 1;
+        job->workerFinished();
+        return job;
+    }
+    schedulePass(scene, cam, job);
+    return job;
+}
+
+/**
+ * @brief Starts a tile-based render on the shared worker pool
  * @param scene The scene to render
  * @param cam The camera defining the viewpoint
- * @return The rendered image
+ * @param progress Callback invoked after each finished tile
+ * @return Handle on the running job
  */
-Image Renderer::render(const Scene& scene,
-                      const std::shared_ptr<RayTracer::Camera>& cam) const
+std::shared_ptr<RenderJob> Renderer::renderAsync(const Scene& scene,
+                      const std::shared_ptr<RayTracer::Camera>& cam,
+                      RenderJob::ProgressCallback progress) const
 {
-    Image frame(_w, _h);
-
-    // Divide image into blocks for parallel processing
-    const int blockSize = 32;
-    const int numBlocksX = (_w + blockSize - 1) / blockSize;
-    const int numBlocksY = (_h + blockSize - 1) / blockSize;
-    const int totalBlocks = numBlocksX * numBlocksY;
-
-    // Thread coordination tools
-    std::queue<std::pair<int, int>> blockQueue;
-    std::mutex queueMutex;        // Protects the block queue
-    std::mutex frameMutex;        // Protects the final image
-    std::atomic<int> blocksCompleted(0);
-
-    // Fill queue with all blocks to render
-    for (int blockY = 0; blockY < numBlocksY; ++blockY) {
-        for (int blockX = 0; blockX < numBlocksX; ++blockX) {
-            blockQueue.push({blockX, blockY});
-        }
+    return startJob(scene, cam, {RenderPass{0, 1, 1, 0, _samplesPerPixel}},
+                    std::move(progress), nullptr);
+}
+
+/**
+ * @brief Starts a multi-pass render refining the frame after a quick preview
+ * @param scene The scene to render
+ * @param cam The camera defining the viewpoint
+ * @param onPass Consumer of every finished pass
+ * @param progress Callback invoked after each finished tile
+ * @return Handle on the running job
+ */
+std::shared_ptr<RenderJob> Renderer::renderProgressive(const Scene& scene,
+                      const std::shared_ptr<RayTracer::Camera>& cam,
+                      RenderJob::PassCallback onPass,
+                      RenderJob::ProgressCallback progress) const
+{
+    const int previewScale = 8;
+    std::vector<RenderPass> passes;
+    passes.push_back(RenderPass{0, 0, previewScale, 0, 0});
+
+    // 1 spp, then double the accumulated samples up to the target
+    for (int first = 0, end = 1; first < _samplesPerPixel; first = end, end *= 2) {
+        end = std::min(end, _samplesPerPixel);
+        passes.push_back(RenderPass{static_cast<int>(passes.size()), 0, 1, first, end});
     }
+    for (RenderPass& pass : passes)
+        pass.count = static_cast<int>(passes.size());
 
-    // Set up thread data (using references to handle const correctness)
-    ThreadData threadData = {
-        scene,
-        cam,
-        frame,
-        blockSize,
-        _w,
-        _h,
-        blockQueue,
-        queueMutex,
-        frameMutex,
-        blocksCompleted,
-        totalBlocks
-    };
+    return startJob(scene, cam, std::move(passes), std::move(progress), std::move(onPass));
+}
+
+/**
+ * @brief Starts a single-pass render whose frame lives in a checkpoint file
+ * @param scene The scene to render
+ * @param cam The camera defining the viewpoint
+ * @param checkpointPath File mapped as the frame-buffer
+ * @param progress Callback invoked after each finished tile
+ * @return Handle on the running job
+ */
+std::shared_ptr<RenderJob> Renderer::renderResumable(const Scene& scene,
+                      const std::shared_ptr<RayTracer::Camera>& cam,
+                      const std::string& checkpointPath,
+                      RenderJob::ProgressCallback progress) const
+{
+    // Everything that changes the traced pixels invalidates the checkpoint
+    uint64_t key = Utils::hashValue(scene.contentSignature());
+    for (const Math::Point3D* p : {&cam->_origin, &cam->_screen._origin})
+        for (double v : {p->_x, p->_y, p->_z})
+            key = Utils::hashValue(v, key);
+    for (const Math::Vector3D* d : {&cam->_screen._bottom_side, &cam->_screen._left_side})
+        for (double v : {d->_x, d->_y, d->_z})
+            key = Utils::hashValue(v, key);
+    for (int v : {_w, _h, _samplesPerPixel, _minSamples})
+        key = Utils::hashValue(v, key);
+    key = Utils::hashValue(_varianceThreshold, key);
+    std::string sampler = typeid(*_sampler).name();
+    key = Utils::fnv1a(sampler.data(), sampler.size(), key);
 
-    // Start worker threads (one per CPU core)
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0) numThreads = 4;
+    auto checkpoint = std::make_shared<FrameCheckpoint>(checkpointPath, _w, _h, BlockSize, key);
+    return startJob(scene, cam, {RenderPass{0, 1, 1, 0, _samplesPerPixel}},
+                    std::move(progress), nullptr, 0, -1, std::move(checkpoint));
+}
 
-    std::cout << "Rendering with " << numThreads << " threads..." << std::endl;
+/**
+ * @brief Renders the frame as successive bands handed to a sink
+ * @param scene The scene to render
+ * @param cam The camera defining the viewpoint
+ * @param sink Output receiving the quantized bands
+ * @param progress Callback invoked after each finished tile
+ * @return Average samples per pixel
+ */
+double Renderer::renderStreaming(const Scene& scene,
+                      const std::shared_ptr<RayTracer::Camera>& cam,
+                      IImageSink& sink,
+                      RenderJob::ProgressCallback progress) const
+{
+    const int bandRows = BlockSize;
+    const int bands = (_h + bandRows - 1) / bandRows;
+    const int tilesX = (_w + BlockSize - 1) / BlockSize;
+    const int total = tilesX * bands;
+    // Two bands run at once: their callbacks are serialized here
+    auto done = std::make_shared<int>(0);
+    auto progressMutex = std::make_shared<std::mutex>();
 
-    std::vector<std::thread> threads;
-    threads.reserve(numThreads);
-    for (unsigned int i = 0; i < numThreads; ++i) {
-        threads.emplace_back(&Renderer::processBlocks, this, std::ref(threadData));
-    }
+    // Band 0 is the top of the image, i.e. the last render-space rows
+    auto startBand = [&](int band) {
+        int imageEnd = std::min((band + 1) * bandRows, _h);
+        int rows = imageEnd - band * bandRows;
+        RenderJob::ProgressCallback onTile;
+        if (progress) {
+            onTile = [progress, done, progressMutex, total](const TileProgress& tile) {
+                TileProgress global = tile;
+                std::lock_guard<std::mutex> lock(*progressMutex);
+                global.completed = ++*done;
+                global.total = total;
+                progress(global);
+            };
+        }
+        return startJob(scene, cam, {RenderPass{0, 1, 1, 0, _samplesPerPixel}},
+                        std::move(onTile), nullptr, _h - imageEnd, rows);
+    };
+
+    sink.begin(_w, _h);
+    std::vector<uint8_t> rgb;
+    double samples = 0.0;
+    std::shared_ptr<RenderJob> next = bands > 0 ? startBand(0) : nullptr;
+    for (int band = 0; band < bands; ++band) {
+        std::shared_ptr<RenderJob> current = std::move(next);
+        try {
+            // Queued behind the current band, so the workers move straight
+            // on to it instead of waiting for this band to be written
+            if (band + 1 < bands)
+                next = startBand(band + 1);
+            Image frame = current->get();
+            samples += current->averageSamplesPerPixel() * frame.height();
 
-    // Wait for all threads to complete
-    for (auto& thread : threads) {
-        thread.join();
+            rgb.resize(static_cast<size_t>(_w) * frame.height() * 3);
+            frame.toRGB8(rgb.data(), 0, frame.height());
+            sink.writeRows(band * bandRows, frame.height(), rgb.data());
+        } catch (...) {
+            // Workers hold references to the scene: let them go first
+            for (const auto& job : {current, next}) {
+                if (job) {
+                    job->cancel();
+                    job->wait();
+                }
+            }
+            throw;
+        }
     }
+    sink.end();
+    return _h > 0 ? samples / _h : 0.0;
+}
+
+/**
+ * @brief Renders a scene and blocks until the frame is complete
+ * @param scene The scene to render
+ * @param cam The camera defining the viewpoint
+ * @return The rendered image
+ */
+Image Renderer::render(const Scene& scene,
+                      const std::shared_ptr<RayTracer::Camera>& cam) const
+{
+    std::cout << "Rendering with " << Utils::ThreadPool::global().size()
+              << " threads..." << std::endl;
+
+    auto job = renderAsync(scene, cam, [](const TileProgress& tile) {
+        if (tile.completed % 10 == 0 || tile.completed == tile.total) {
+            float progress = 100.0f * tile.completed / tile.total;
+            std::cout << "\rRendering progress: " << progress << "% ("
+                      << tile.completed << "/" << tile.total << " blocks)" << std::flush;
+        }
+    });
+    Image frame = job->get();
 
     std::cout << "\nRendering complete!" << std::endl;
     return frame;
 }
 
+/**
+ * @brief Checks whether a pixel estimate is precise enough to stop sampling
+ * @param sum Sum of the samples taken so far
+ * @param lumaSq Sum of the squared sample luminances
+ * @param n Number of samples taken
+ * @return True when the standard error of the mean luminance is below threshold
+ */
+bool Renderer::isConverged(const Color::Float& sum, float lumaSq, int n) const
+{
+    if (n < 2)
+        return false;
+    double mean = sum.luminance() / n;
+    double variance = (lumaSq / n - mean * mean) * n / (n - 1);
+    return std::max(0.0, variance) / n <= _varianceThreshold * _varianceThreshold;
+}
+
 bool Renderer::tracePrimaryRay(const Scene& scene,
                              const RayTracer::Ray& ray,
                              HitInfo& outHit) const
 {
-    bool touched = false;
-    outHit.t = std::numeric_limits<double>::max();
-    for (const auto& prim : scene.primitives) {
-        HitInfo tmp;
-        if (prim->hits(ray, tmp) && tmp.t < outHit.t) {
-            outHit = tmp;
-            touched = true;
-        }
-    }
-    return touched;
+    return scene.intersect(ray, outHit);
 }
 
-Color Renderer::shadePixel(const Scene& scene,
+/**
+ * @brief Direct lighting at a hit point, in linear HDR (not clamped)
+ */
+Color::Float Renderer::shadePixel(const Scene& scene,
                           const HitInfo& hit) const
 {
-    Color result(0,0,0);
+    Color::Float result;
+    Color::Float albedo(*hit.color);
     for (const auto& lightPtr : scene.lights) {
         // Lumière AMBIANTE
         if (auto amb = std::dynamic_pointer_cast<RayTracer::AmbientLight>(lightPtr)) {
-            result += (*hit.color) * amb->getColor() * amb->getIntensity();
+            result += albedo * Color::Float(amb->getColor()) * static_cast<float>(amb->getIntensity());
             continue;
         }
         // ---------- Directionnelle ----------
@@ -218,7 +440,8 @@ Color Renderer::shadePixel(const Scene& scene,
             Math::Vector3D L = -dir->getDirection();
             if (!isShadowed(scene, hit.p, L)) {
                 double diff = std::max(0.0, hit.n.dot(L));
-                result += (*hit.color) * dir->getColor() * (dir->getIntensity() * diff);
+                result += albedo * Color::Float(dir->getColor())
+                          * static_cast<float>(dir->getIntensity() * diff);
             }
             continue;
         }
@@ -230,8 +453,8 @@ Color Renderer::shadePixel(const Scene& scene,
             if (!isShadowed(scene, hit.p, L, std::sqrt(dist2))) {
                 double diff   = std::max(0.0, hit.n.dot(L));
                 double atten  = 1.0 / dist2;            // atténuation simple
-                result += (*hit.color) * pt->getColor()
-                          * (pt->getIntensity() * diff * atten);
+                result += albedo * Color::Float(pt->getColor())
+                          * static_cast<float>(pt->getIntensity() * diff * atten);
             }
         }
     }
@@ -244,15 +467,10 @@ bool Renderer::isShadowed(const Scene& scene,
                         double maxDist) const
 {
     RayTracer::Ray shadowRay(p + L * 1e-3, L);
-    for (const auto& prim : scene.primitives) {
-        HitInfo tmp;
-        if (prim->hits(shadowRay, tmp) && tmp.t < maxDist)
-            return true;          // quelque chose bloque
-    }
-    return false;
+    return scene.occluded(shadowRay, maxDist);   // quelque chose bloque
 }
 
-Color Renderer::writeBackground()
+Color::Float Renderer::writeBackground()
 {
-    return Color(40,40,80);
+    return Color::Float(Color(40,40,80));
 }
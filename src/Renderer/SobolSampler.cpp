@@ -0,0 +1,51 @@
+/*
+** SobolSampler - Implementation of the scrambled Sobol sequence
+*/
+
+#include "Renderer/SobolSampler.hpp"
+
+void SobolSampler::prepare(int)
+{}
+
+SamplePoint SobolSampler::sample(int x, int y, int index) const
+{
+    uint32_t i = static_cast<uint32_t>(index);
+    uint32_t seed = Sampling::hashPixel(x, y, 0x50b0);
+    return SamplePoint{
+        Sampling::toUnit(owenScramble(vanDerCorput(i), seed)),
+        Sampling::toUnit(owenScramble(sobol2(i), seed * 0x9e3779b9u + 1))
+    };
+}
+
+uint32_t SobolSampler::vanDerCorput(uint32_t bits)
+{
+    bits = (bits << 16) | (bits >> 16);
+    bits = ((bits & 0x00ff00ffu) << 8) | ((bits & 0xff00ff00u) >> 8);
+    bits = ((bits & 0x0f0f0f0fu) << 4) | ((bits & 0xf0f0f0f0u) >> 4);
+    bits = ((bits & 0x33333333u) << 2) | ((bits & 0xccccccccu) >> 2);
+    bits = ((bits & 0x55555555u) << 1) | ((bits & 0xaaaaaaaau) >> 1);
+    return bits;
+}
+
+uint32_t SobolSampler::sobol2(uint32_t index)
+{
+    uint32_t result = 0;
+    for (uint32_t v = 1u << 31; index; index >>= 1, v ^= v >> 1) {
+        if (index & 1)
+            result ^= v;
+    }
+    return result;
+}
+
+uint32_t SobolSampler::owenScramble(uint32_t value, uint32_t seed)
+{
+    // Laine-Karras hash applied to the reversed bits: flipping a bit only
+    // ever depends on the bits above it, as in nested uniform scrambling
+    value = vanDerCorput(value);
+    value += seed;
+    value ^= value * 0x6c50b47cu;
+    value ^= value * 0xb82f1e52u;
+    value ^= value * 0xc7afe638u;
+    value ^= value * 0x8d22f6e6u;
+    return vanDerCorput(value);
+}
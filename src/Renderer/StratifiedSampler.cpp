@@ -0,0 +1,40 @@
+/*
+** StratifiedSampler - Implementation of the jittered N-rooks pattern
+*/
+
+#include "Renderer/StratifiedSampler.hpp"
+#include <numeric>
+
+void StratifiedSampler::prepare(int samplesPerPixel)
+{
+    int bits = 0;
+    while ((1 << bits) < samplesPerPixel)
+        ++bits;
+
+    // Bit-reversed enumeration of the next power of two, out-of-range skipped
+    _order.clear();
+    for (int i = 0; i < (1 << bits); ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        if (reversed < samplesPerPixel)
+            _order.push_back(reversed);
+    }
+}
+
+SamplePoint StratifiedSampler::sample(int x, int y, int index) const
+{
+    int n = static_cast<int>(_order.size());
+    int column = _order[index];
+
+    // Rows are a per-pixel permutation of the columns (an affine map mod n)
+    uint32_t h = Sampling::hashPixel(x, y, 0x5eed);
+    int stride = 1 + static_cast<int>(h % n);
+    while (n > 1 && std::gcd(stride, n) != 1)
+        ++stride;
+    int row = static_cast<int>((static_cast<int64_t>(column) * stride + (h >> 16)) % n);
+
+    double jitterU = Sampling::toUnit(Sampling::hashPixel(x, y, 2 * index + 1));
+    double jitterV = Sampling::toUnit(Sampling::hashPixel(x, y, 2 * index + 2));
+    return SamplePoint{(column + jitterU) / n, (row + jitterV) / n};
+}
@@ -7,6 +7,19 @@
 
 #include "UI/CommandLineInterface.hpp"
 #include "UI/SFMLViewer.hpp"
+#include "Renderer/RendererExceptions.hpp"
+#include "Renderer/StratifiedSampler.hpp"
+#include "Renderer/HaltonSampler.hpp"
+#include "Renderer/SobolSampler.hpp"
+#include "Renderer/BlueNoiseSampler.hpp"
+#include "Renderer/PPMStreamSink.hpp"
+#include "Renderer/PNGStreamSink.hpp"
+#include "Utils/Log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
 #include <iostream>
 #include <sstream>
 
@@ -22,6 +35,15 @@ void CommandLineInterface::initCommands() {
     _commands["render"] = [this](std::istringstream& iss) { cmd_render(iss); };
     _commands["move"] = [this](std::istringstream& iss) { cmd_move(iss); };
     _commands["preview"] = [this](std::istringstream& iss) { cmd_preview(iss); };
+    _commands["sampler"] = [this](std::istringstream& iss) { cmd_sampler(iss); };
+    _commands["tonemap"] = [this](std::istringstream& iss) { cmd_tonemap(iss); };
+    _commands["stream"] = [this](std::istringstream& iss) { cmd_stream(iss); };
+    _commands["meshes"] = [this](std::istringstream& iss) { cmd_meshes(iss); };
+    _commands["snapshot"] = [this](std::istringstream& iss) { cmd_snapshot(iss); };
+    _commands["log"] = [this](std::istringstream& iss) { cmd_log(iss); };
+    _commands["reload"] = [this](std::istringstream& iss) { cmd_reload(iss); };
+    _commands["watch"] = [this](std::istringstream& iss) { cmd_watch(iss); };
+    _commands["plugins"] = [this](std::istringstream& iss) { cmd_plugins(iss); };
 }
 
 void CommandLineInterface::run() {
@@ -34,16 +56,41 @@ void CommandLineInterface::run() {
     }
 }
 
+void CommandLineInterface::cancelRender() {
+    if (!_job)
+        return;
+    _job->cancel();
+    _job->wait();
+    _job.reset();
+}
+
 void CommandLineInterface::executeCommand(const std::string& line) {
     std::istringstream iss(line);
     std::string cmd;
     iss >> cmd;
 
-    auto it = _commands.find(cmd);
-    if (it != _commands.end()) {
-        it->second(iss);
-    } else
-        std::cerr << "Unknown command: " << cmd << "\n";
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _commands.find(cmd);
+        if (it != _commands.end()) {
+            it->second(iss);
+        } else
+            std::cerr << "Unknown command: " << cmd << "\n";
+    }
+    runPendingReloads();
+}
+
+void CommandLineInterface::runPendingReloads() {
+    // Whoever sets the flag then finds _mutex taken leaves the reload to
+    // the holder, which checks again once it has let go of the lock, so
+    // a change saved during a command or a reload is never lost
+    while (_reloadPending) {
+        std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+            return;
+        if (_reloadPending.exchange(false))
+            reloadScene();
+    }
 }
 
 void CommandLineInterface::cmd_move(std::istringstream& iss) {
@@ -54,6 +101,7 @@ void CommandLineInterface::cmd_move(std::istringstream& iss) {
         return;
     }
 
+    cancelRender();
     if (!_scene.moveObject(name, {dx, dy, dz})) {
         std::cerr << "Error: no object '" << name << "'\n";
         return;
@@ -70,6 +118,7 @@ void CommandLineInterface::cmd_cam(std::istringstream& iss) {
     }
     auto cam = _scene.getCameraByName(camName);
     if (cam) {
+        cancelRender();
         _activeCamera = cam;
         std::cout << "Camera changed to '" << camName << "'\n";
     } else
@@ -77,15 +126,290 @@ void CommandLineInterface::cmd_cam(std::istringstream& iss) {
 }
 
 void CommandLineInterface::cmd_render(std::istringstream& iss) {
+    if (!_activeCamera) {
+        std::cerr << "Error: no active camera\n";
+        return;
+    }
+    std::string filename = "output.ppm";
+    std::string mode;
+    iss >> filename >> mode;
+    if (!Image::isSupportedFormat(filename)) {
+        std::cerr << "Error: output must end in .ppm, .png or .exr\n";
+        return;
+    }
+    if (!mode.empty() && mode != "resume") {
+        std::cerr << "Usage: render [file] [resume]\n";
+        return;
+    }
+    cancelRender();
+    if (mode.empty() && Image::extension(filename) == "png") {
+        // Compress finished bands while the rest of the frame renders
+        renderStreamed(filename);
+        return;
+    }
+    auto progress = [](const TileProgress& tile) {
+        if (tile.completed % 10 == 0 || tile.completed == tile.total)
+            std::cout << "\rRendering progress: " << 100.0f * tile.completed / tile.total
+                      << "% (" << tile.completed << "/" << tile.total << " blocks)" << std::flush;
+    };
+    // Resumable renders keep their frame-buffer next to the output until saved
+    std::string checkpoint = "screenshots/" + filename + ".ckpt";
+    try {
+        if (mode == "resume")
+            _job = _renderer.renderResumable(_scene, _activeCamera, checkpoint, progress);
+        else
+            _job = _renderer.renderAsync(_scene, _activeCamera, progress);
+        Image frame = _job->get();
+        std::cout << "\nAverage samples per pixel: " << _job->averageSamplesPerPixel() << "\n";
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = frame.save("screenshots/" + filename);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Image saved to screenshots/" << filename << " ("
+                  << bytes / 1024 << " KiB in " << elapsed.count() << " ms)\n";
+        if (mode == "resume")
+            std::remove(checkpoint.c_str());
+    } catch (const RendererException& e) {
+        std::cerr << "\n" << e.what() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "\nError: " << e.what() << "\n";
+    }
+    _job.reset();
+}
+
+void CommandLineInterface::cmd_stream(std::istringstream& iss) {
+    if (!_activeCamera) {
+        std::cerr << "Error: no active camera\n";
+        return;
+    }
     std::string filename = "output.ppm";
     iss >> filename;
-    auto frame = _renderer.render(_scene, _activeCamera);
-    frame.writePPM("screenshots/" + filename);
-    std::cout << "Image saved to screenshots/" << filename << "\n";
+    std::string ext = Image::extension(filename);
+    if (ext != "ppm" && ext != "png") {
+        std::cerr << "Error: streamed output must be a .ppm or .png file\n";
+        return;
+    }
+    cancelRender();
+    renderStreamed(filename);
+}
+
+void CommandLineInterface::cmd_meshes(std::istringstream& iss) {
+    RayTracer::MeshCache& cache = _scene.meshCache();
+    double budget;
+    if (iss >> budget) {
+        if (budget < 0) {
+            std::cerr << "Usage: meshes [budget_MiB]\n";
+            return;
+        }
+        cancelRender();
+        cache.setBudget(static_cast<std::size_t>(budget * 1024 * 1024));
+    }
+
+    std::size_t limit = cache.budget();
+    std::cout << cache.residentCount() << "/" << cache.size() << " meshes resident, "
+              << cache.residentBytes() / (1024.0 * 1024.0) << " MiB of "
+              << (limit ? std::to_string(limit / (1024 * 1024)) + " MiB" : std::string("unlimited"))
+              << " (" << cache.loads() << " loads in " << cache.loadSeconds() << "s, BVH "
+              << cache.buildSeconds() << "s, " << cache.evictions() << " evictions)\n";
+}
+
+void CommandLineInterface::cmd_log(std::istringstream& iss) {
+    std::string name;
+    Utils::Log::Level level;
+    if (!(iss >> name) || !Utils::Log::parseLevel(name, level)) {
+        std::cerr << "Usage: log <off|error|warn|info|debug>\n";
+        return;
+    }
+    Utils::Log::setLevel(level);
+}
+
+void CommandLineInterface::cmd_snapshot(std::istringstream& iss) {
+    std::string filename;
+    if (!(iss >> filename)) {
+        std::cerr << "Usage: snapshot <file.rtscene>\n";
+        return;
+    }
+    try {
+        auto start = std::chrono::steady_clock::now();
+        _scene.saveSnapshot(filename);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Snapshot saved to " << filename << " in " << elapsed.count() << "s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Snapshot error: " << e.what() << "\n";
+    }
+}
+
+void CommandLineInterface::cmd_reload(std::istringstream&) {
+    _reloadPending = false;         // covered by this reload
+    reloadScene();
+}
+
+void CommandLineInterface::cmd_watch(std::istringstream& iss) {
+    std::string mode;
+    iss >> mode;
+    if (mode == "off") {
+        _watcher.reset();
+        std::cout << "Stopped watching the scene file\n";
+        return;
+    }
+    if (!mode.empty() && mode != "on") {
+        std::cerr << "Usage: watch [on|off]\n";
+        return;
+    }
+    if (_scene.sourcePath().empty()) {
+        std::cerr << "Error: the scene was not loaded from a file\n";
+        return;
+    }
+    try {
+        // Never blocks on a running command: the reload then waits for it to end
+        _watcher = std::make_unique<Utils::FileWatcher>(_scene.sourcePath(), [this]() {
+            _reloadPending = true;
+            runPendingReloads();
+        });
+        std::cout << "Watching " << _scene.sourcePath() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
+
+void CommandLineInterface::cmd_plugins(std::istringstream& iss) {
+    std::string action;
+    if (!(iss >> action) || action != "reload") {
+        std::cerr << "Usage: plugins reload\n";
+        return;
+    }
+    cancelRender();
+    try {
+        auto start = std::chrono::steady_clock::now();
+        Scene::PluginReloadStats stats = _scene.reloadPlugins();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        for (const auto& failure : stats.plugins.failures)
+            std::cerr << "Plugin error: " << failure << "\n";
+        if (stats.plugins.types.empty()) {
+            std::cout << "No loaded plugin changed\n";
+            return;
+        }
+        std::cout << "Plugins reloaded in " << elapsed.count() << "s:";
+        for (const auto& type : stats.plugins.types)
+            std::cout << " " << type;
+        std::cout << ", " << stats.recreated << " primitives re-created\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Plugin reload error: " << e.what() << "\n";
+    }
+}
+
+void CommandLineInterface::reloadScene() {
+    cancelRender();
+    try {
+        auto start = std::chrono::steady_clock::now();
+        Scene::ReloadStats stats = _scene.reload();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Scene reloaded in " << elapsed.count() << "s: " << stats.kept << " kept ("
+                  << stats.meshesReused << " meshes), " << stats.changed << " changed, "
+                  << stats.added << " added, " << stats.removed << " removed\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Reload error: " << e.what() << "\n";
+        return;
+    }
+    const auto& cameras = _scene.cameras;
+    if (std::find(cameras.begin(), cameras.end(), _activeCamera) == cameras.end()) {
+        _activeCamera = _scene.getCameraByName("main_camera");
+        if (!_activeCamera && !cameras.empty())
+            _activeCamera = cameras.front();
+        if (_activeCamera)
+            std::cout << "Active camera removed, switched to another one\n";
+        else
+            std::cerr << "Warning: the scene has no camera left\n";
+    }
+}
+
+void CommandLineInterface::renderStreamed(const std::string& filename) {
+    try {
+        std::unique_ptr<IImageSink> sink;
+        if (Image::extension(filename) == "png")
+            sink = std::make_unique<PNGStreamSink>("screenshots/" + filename);
+        else
+            sink = std::make_unique<PPMStreamSink>("screenshots/" + filename);
+        auto start = std::chrono::steady_clock::now();
+        double spp = _renderer.renderStreaming(_scene, _activeCamera, *sink,
+            [](const TileProgress& tile) {
+                if (tile.completed % 10 == 0 || tile.completed == tile.total)
+                    std::cout << "\rRendering progress: " << 100.0f * tile.completed / tile.total
+                              << "% (" << tile.completed << "/" << tile.total << " blocks)" << std::flush;
+            });
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "\nAverage samples per pixel: " << spp << "\n"
+                  << "Image streamed to screenshots/" << filename << " ("
+                  << std::filesystem::file_size("screenshots/" + filename) / 1024
+                  << " KiB, " << elapsed.count() << " s)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "\nError: " << e.what() << "\n";
+    }
 }
 
 void CommandLineInterface::cmd_preview(std::istringstream& iss) {
-    Image frame = _renderer.render(_scene, _activeCamera);
+    if (!_activeCamera) {
+        std::cerr << "Error: no active camera\n";
+        return;
+    }
+    cancelRender();
     SFMLViewer display(_activeCamera->_width, _activeCamera->_height);
-    display.show(frame);
+    display.show(
+        [this](RenderJob::ProgressCallback onTile, RenderJob::PassCallback onPass) {
+            _job = _renderer.renderProgressive(_scene, _activeCamera,
+                std::move(onPass), std::move(onTile));
+            return _job;
+        },
+        [this](const Math::Vector3D& offset) {
+            _activeCamera->translate(offset);
+        });
+    _job.reset();
+}
+
+void CommandLineInterface::cmd_sampler(std::istringstream& iss) {
+    std::string name;
+    if (!(iss >> name)) {
+        std::cerr << "Usage: sampler <stratified|halton|sobol|bluenoise>\n";
+        return;
+    }
+
+    std::shared_ptr<ISampler> sampler;
+    if (name == "stratified")
+        sampler = std::make_shared<StratifiedSampler>();
+    else if (name == "halton")
+        sampler = std::make_shared<HaltonSampler>();
+    else if (name == "sobol")
+        sampler = std::make_shared<SobolSampler>();
+    else if (name == "bluenoise")
+        sampler = std::make_shared<BlueNoiseSampler>();
+    else {
+        std::cerr << "Error: unknown sampler '" << name << "'\n";
+        return;
+    }
+    _renderer.setSampler(sampler);
+    std::cout << "Sampler changed to '" << name << "'\n";
+}
+
+void CommandLineInterface::cmd_tonemap(std::istringstream& iss) {
+    std::string name;
+    float exposure = 1.f;
+    if (!(iss >> name)) {
+        std::cerr << "Usage: tonemap <clamp|reinhard|aces> [exposure]\n";
+        return;
+    }
+    if (!(iss >> exposure))
+        exposure = 1.f;
+
+    ToneMap op;
+    if (name == "clamp")
+        op = ToneMap::Clamp;
+    else if (name == "reinhard")
+        op = ToneMap::Reinhard;
+    else if (name == "aces")
+        op = ToneMap::Aces;
+    else {
+        std::cerr << "Error: unknown tone mapping '" << name << "'\n";
+        return;
+    }
+    _renderer.setToneMap(op, exposure);
+    std::cout << "Tone mapping changed to '" << name << "' (exposure " << exposure << ")\n";
 }
@@ -32,3 +32,78 @@ void SFMLViewer::show(const Image& image)
         _window.display();
     }
 }
+
+void SFMLViewer::show(const RenderStarter& startRender, const CameraMover& moveCamera)
+{
+    auto onTile = [this](const TileProgress& tile) {
+        std::lock_guard<std::mutex> lock(_tilesMutex);
+        _pendingTiles.push_back(tile);
+    };
+
+    auto onPass = [this](const RenderPass& pass, const Image&) {
+        std::lock_guard<std::mutex> lock(_tilesMutex);
+        _pendingTitle = "Raytracer - pass " + std::to_string(pass.index + 1) + "/"
+            + std::to_string(pass.count)
+            + (pass.scale > 1 ? " (preview)" : " (" + std::to_string(pass.endSample) + " spp)");
+    };
+
+    _window.setFramerateLimit(60);
+    std::shared_ptr<RenderJob> job = startRender(onTile, onPass);
+
+    while (_window.isOpen()) {
+        sf::Event event;
+        while (_window.pollEvent(event)) {
+            Math::Vector3D offset;
+            if (event.type == sf::Event::Closed) {
+                _window.close();
+            } else if (event.type == sf::Event::KeyPressed
+                && cameraOffset(event.key.code, offset)) {
+                // The camera is shared with the workers: stop them first
+                job->cancel();
+                job->wait();
+                {
+                    std::lock_guard<std::mutex> lock(_tilesMutex);
+                    _pendingTiles.clear();
+                }
+                moveCamera(offset);
+                job = startRender(onTile, onPass);
+            }
+        }
+
+        uploadPendingTiles();
+        _window.clear();
+        _window.draw(_sprite);
+        _window.display();
+    }
+
+    job->cancel();
+    job->wait();
+}
+
+void SFMLViewer::uploadPendingTiles()
+{
+    std::vector<TileProgress> tiles;
+    std::string title;
+    {
+        std::lock_guard<std::mutex> lock(_tilesMutex);
+        tiles.swap(_pendingTiles);
+        title.swap(_pendingTitle);
+    }
+    if (!title.empty())
+        _window.setTitle(title);
+    for (const TileProgress& tile : tiles)
+        _texture.update(tile.rgba.data(), tile.width, tile.height, tile.x, tile.y);
+}
+
+bool SFMLViewer::cameraOffset(sf::Keyboard::Key key, Math::Vector3D& offset)
+{
+    switch (key) {
+        case sf::Keyboard::Left:     offset = Math::Vector3D(-1, 0, 0); return true;
+        case sf::Keyboard::Right:    offset = Math::Vector3D(1, 0, 0);  return true;
+        case sf::Keyboard::Up:       offset = Math::Vector3D(0, 0, -1); return true;
+        case sf::Keyboard::Down:     offset = Math::Vector3D(0, 0, 1);  return true;
+        case sf::Keyboard::PageUp:   offset = Math::Vector3D(0, 1, 0);  return true;
+        case sf::Keyboard::PageDown: offset = Math::Vector3D(0, -1, 0); return true;
+        default:                     return false;
+    }
+}
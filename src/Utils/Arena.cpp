@@ -0,0 +1,99 @@
+/*
+** Arena - Monotonic bump allocator releasing everything at once
+*/
+
+#include "Utils/Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace Utils {
+
+Arena::Arena(std::size_t blockSize)
+    : _nextBlockSize(std::max<std::size_t>(blockSize, 256))
+{
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return allocateLocked(size, alignment);
+}
+
+void* Arena::allocateLocked(std::size_t size, std::size_t alignment)
+{
+    auto aligned = [alignment](std::byte* p) {
+        auto address = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+    };
+
+    _used += size;
+    if (_cursor) {
+        std::byte* start = aligned(_cursor);
+        if (start <= _end && static_cast<std::size_t>(_end - start) >= size) {
+            _cursor = start + size;
+            return start;
+        }
+    }
+
+    // Requests larger than a quarter block get their own; the current block stays open
+    const std::size_t need = size + alignment;
+    if (need > _nextBlockSize / 4) {
+        _blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(need));
+        _reserved += need;
+        return aligned(_blocks.back().get());
+    }
+
+    _blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(_nextBlockSize));
+    _reserved += _nextBlockSize;
+    _cursor = _blocks.back().get();
+    _end = _cursor + _nextBlockSize;
+    _nextBlockSize = std::min(_nextBlockSize * 2, MaxBlockSize);
+    std::byte* start = aligned(_cursor);
+    _cursor = start + size;
+    return start;
+}
+
+void Arena::onRelease(void (*destroy)(void*), void* object)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* cleanup = static_cast<Cleanup*>(allocateLocked(sizeof(Cleanup), alignof(Cleanup)));
+    *cleanup = {destroy, object, _cleanups};
+    _cleanups = cleanup;
+    ++_objects;
+}
+
+void Arena::release()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (Cleanup* c = _cleanups; c; c = c->next)
+        c->destroy(c->object);
+    _cleanups = nullptr;
+    _blocks.clear();
+    _cursor = _end = nullptr;
+    _used = _reserved = _objects = 0;
+}
+
+std::size_t Arena::bytesUsed() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _used;
+}
+
+std::size_t Arena::bytesReserved() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _reserved;
+}
+
+std::size_t Arena::objectCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _objects;
+}
+
+}
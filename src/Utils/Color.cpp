@@ -110,10 +110,22 @@ Color::Float& Color::Float::operator+=(const Color::Float& other) {
     return *this;
 }
 
+Color::Float Color::Float::operator+(const Color::Float& other) const {
+    return Color::Float(r + other.r, g + other.g, b + other.b);
+}
+
 Color::Float Color::Float::operator*(float factor) const {
     return Color::Float(r * factor, g * factor, b * factor);
 }
 
+Color::Float Color::Float::operator*(const Color::Float& other) const {
+    return Color::Float(r * other.r, g * other.g, b * other.b);
+}
+
+float Color::Float::luminance() const {
+    return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+}
+
 Color Color::Float::toColor() const {
     return Color(
         static_cast<int>(std::round(std::clamp(r * 255.f, 0.f, 255.f))),
@@ -0,0 +1,229 @@
+/*
+** Deflate - Minimal zlib-compatible compressor
+*/
+
+#include "Utils/Deflate.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+    constexpr int WindowBits = 15;
+    constexpr int WindowSize = 1 << WindowBits;
+    constexpr int HashBits = 15;
+    constexpr int MinMatch = 3;
+    constexpr int MaxMatch = 258;
+    constexpr int MaxChain = 32;
+
+    constexpr uint16_t LengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr uint8_t LengthExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    constexpr uint16_t DistBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+        8193, 12289, 16385, 24577};
+    constexpr uint8_t DistExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    /**
+     * @brief LSB-first bit packer
+     */
+    class BitWriter {
+        public:
+            explicit BitWriter(std::vector<uint8_t>& out) : _out(out) {}
+
+            void bits(uint32_t value, int count) {
+                _acc |= static_cast<uint64_t>(value) << _count;
+                _count += count;
+                while (_count >= 8) {
+                    _out.push_back(static_cast<uint8_t>(_acc));
+                    _acc >>= 8;
+                    _count -= 8;
+                }
+            }
+
+            // Huffman codes are defined MSB first
+            void code(uint32_t code, int length) {
+                uint32_t reversed = 0;
+                for (int i = 0; i < length; ++i)
+                    reversed |= ((code >> i) & 1u) << (length - 1 - i);
+                bits(reversed, length);
+            }
+
+            void align() {
+                if (_count > 0)
+                    bits(0, 8 - _count);
+            }
+
+        private:
+            std::vector<uint8_t>& _out;
+            uint64_t _acc = 0;
+            int _count = 0;
+    };
+
+    void literal(BitWriter& bw, int symbol)
+    {
+        if (symbol < 144)
+            bw.code(0x30 + symbol, 8);
+        else if (symbol < 256)
+            bw.code(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            bw.code(symbol - 256, 7);
+        else
+            bw.code(0xC0 + symbol - 280, 8);
+    }
+
+    void match(BitWriter& bw, int length, int distance)
+    {
+        int l = static_cast<int>(std::upper_bound(LengthBase, LengthBase + 29, length) - LengthBase) - 1;
+        literal(bw, 257 + l);
+        bw.bits(length - LengthBase[l], LengthExtra[l]);
+
+        int d = static_cast<int>(std::upper_bound(DistBase, DistBase + 30, distance) - DistBase) - 1;
+        bw.code(d, 5);
+        bw.bits(distance - DistBase[d], DistExtra[d]);
+    }
+
+    uint32_t hash3(const uint8_t* p)
+    {
+        uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+        return (v * 2654435761u) >> (32 - HashBits);
+    }
+}
+
+uint32_t Utils::crc32(const uint8_t* data, std::size_t size, uint32_t crc)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t Utils::adler32(const uint8_t* data, std::size_t size, uint32_t adler)
+{
+    const uint32_t mod = 65521;
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+
+    while (size > 0) {
+        // 5552 bytes is the most that can be summed before b overflows
+        std::size_t chunk = std::min<std::size_t>(size, 5552);
+        for (std::size_t i = 0; i < chunk; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= mod;
+        b %= mod;
+        data += chunk;
+        size -= chunk;
+    }
+    return (b << 16) | a;
+}
+
+uint32_t Utils::adler32Combine(uint32_t adlerA, uint32_t adlerB, std::size_t sizeB)
+{
+    const uint64_t mod = 65521;
+    uint64_t rem = sizeB % mod;
+    uint64_t a1 = adlerA & 0xFFFF, b1 = adlerA >> 16;
+    uint64_t a2 = adlerB & 0xFFFF, b2 = adlerB >> 16;
+
+    // a = a1 + a2 - 1, b = b1 + b2 + len(B) * (a1 - 1), everything mod 65521
+    uint64_t a = (a1 + a2 + mod - 1) % mod;
+    uint64_t b = (b1 + b2 + rem * ((a1 + mod - 1) % mod)) % mod;
+    return static_cast<uint32_t>((b << 16) | a);
+}
+
+std::vector<uint8_t> Utils::deflate(const uint8_t* data, std::size_t size, bool last)
+{
+    std::vector<uint8_t> out;
+    out.reserve(size / 4 + 64);
+    BitWriter bw(out);
+
+    // Single fixed-Huffman block covering the whole input
+    bw.bits(last ? 1 : 0, 1);
+    bw.bits(1, 2);
+
+    std::vector<int32_t> head(1 << HashBits, -1);
+    std::vector<int32_t> prev(WindowSize, -1);
+    auto insert = [&](std::size_t pos) {
+        uint32_t h = hash3(data + pos);
+        prev[pos & (WindowSize - 1)] = head[h];
+        head[h] = static_cast<int32_t>(pos);
+    };
+
+    std::size_t pos = 0;
+    while (pos < size) {
+        int bestLength = 0;
+        int bestDistance = 0;
+
+        if (pos + MinMatch <= size) {
+            int limit = static_cast<int>(std::min<std::size_t>(MaxMatch, size - pos));
+            int32_t candidate = head[hash3(data + pos)];
+            for (int chain = 0; candidate >= 0 && chain < MaxChain; ++chain) {
+                std::size_t distance = pos - static_cast<std::size_t>(candidate);
+                if (distance > static_cast<std::size_t>(WindowSize - 1))
+                    break;
+                const uint8_t* a = data + candidate;
+                const uint8_t* b = data + pos;
+                int length = 0;
+                while (length < limit && a[length] == b[length])
+                    ++length;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = static_cast<int>(distance);
+                    if (length == limit)
+                        break;
+                }
+                candidate = prev[candidate & (WindowSize - 1)];
+            }
+            insert(pos);
+        }
+
+        if (bestLength >= MinMatch) {
+            match(bw, bestLength, bestDistance);
+            for (std::size_t i = pos + 1; i < pos + bestLength && i + MinMatch <= size; ++i)
+                insert(i);
+            pos += bestLength;
+        } else {
+            literal(bw, data[pos]);
+            ++pos;
+        }
+    }
+    literal(bw, 256);
+
+    if (!last) {
+        // Empty stored block: realigns on a byte boundary
+        bw.bits(0, 3);
+        bw.align();
+        bw.bits(0x0000, 16);
+        bw.bits(0xFFFF, 16);
+    }
+    bw.align();
+    return out;
+}
+
+std::vector<uint8_t> Utils::zlibCompress(const uint8_t* data, std::size_t size)
+{
+    std::vector<uint8_t> out = {0x78, 0x01};   // 32K window, fastest-level flag
+    std::vector<uint8_t> body = deflate(data, size, true);
+    out.insert(out.end(), body.begin(), body.end());
+
+    uint32_t adler = adler32(data, size);
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(adler >> shift));
+    return out;
+}
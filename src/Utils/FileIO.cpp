@@ -0,0 +1,45 @@
+/*
+** FileIO - Whole-buffer file output and change detection
+*/
+
+#include "Utils/FileIO.hpp"
+#include "Utils/Hash.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void Utils::writeFile(const std::string& path, const void* data, std::size_t size)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open file for writing: " + path);
+
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            std::string reason = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Cannot write " + path + ": " + reason);
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    if (::close(fd) != 0)
+        throw std::runtime_error("Cannot write " + path + ": " + std::strerror(errno));
+}
+
+uint64_t Utils::fileSignature(const std::string& path)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0)
+        return 0;
+    uint64_t hash = Utils::hashValue(static_cast<int64_t>(st.st_size));
+    hash = Utils::hashValue(static_cast<int64_t>(st.st_mtim.tv_sec), hash);
+    return Utils::hashValue(static_cast<int64_t>(st.st_mtim.tv_nsec), hash);
+}
@@ -0,0 +1,71 @@
+/*
+** FileWatcher - Notifies when a file is rewritten, through inotify
+*/
+
+#include "Utils/FileWatcher.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int PollMs = 100;
+    constexpr auto Quiet = std::chrono::milliseconds(150);
+}
+
+Utils::FileWatcher::FileWatcher(const std::string& path, Callback callback)
+    : _callback(std::move(callback))
+{
+    auto slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    _name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    _fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_fd < 0)
+        throw std::runtime_error(std::string("Cannot start inotify: ") + std::strerror(errno));
+    if (::inotify_add_watch(_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        std::string reason = std::strerror(errno);
+        ::close(_fd);
+        throw std::runtime_error("Cannot watch " + directory + ": " + reason);
+    }
+    _thread = std::thread(&FileWatcher::run, this);
+}
+
+Utils::FileWatcher::~FileWatcher()
+{
+    _stop.store(true);
+    if (_thread.joinable())
+        _thread.join();
+    ::close(_fd);
+}
+
+void Utils::FileWatcher::run()
+{
+    alignas(inotify_event) char buffer[4096];
+    bool pending = false;
+    auto lastEvent = std::chrono::steady_clock::now();
+
+    while (!_stop.load()) {
+        pollfd pfd{_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, PollMs) > 0) {
+            ssize_t got;
+            while ((got = ::read(_fd, buffer, sizeof(buffer))) > 0) {
+                for (char* p = buffer; p < buffer + got;) {
+                    auto* event = reinterpret_cast<inotify_event*>(p);
+                    if (event->len > 0 && _name == event->name) {
+                        pending = true;
+                        lastEvent = std::chrono::steady_clock::now();
+                    }
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+        if (pending && std::chrono::steady_clock::now() - lastEvent >= Quiet) {
+            pending = false;
+            _callback();
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+** Log - Leveled diagnostics on stderr, errors only by default
+*/
+
+#include "Utils/Log.hpp"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+namespace {
+    std::atomic<Utils::Log::Level> currentLevel{Utils::Log::Level::Error};
+    std::mutex outputMutex;
+
+    const char* prefix(Utils::Log::Level level)
+    {
+        switch (level) {
+            case Utils::Log::Level::Error: return "[error] ";
+            case Utils::Log::Level::Warn: return "[warn] ";
+            case Utils::Log::Level::Info: return "[info] ";
+            case Utils::Log::Level::Debug: return "[debug] ";
+            default: return "";
+        }
+    }
+}
+
+void Utils::Log::setLevel(Level level)
+{
+    currentLevel.store(level, std::memory_order_relaxed);
+}
+
+Utils::Log::Level Utils::Log::level()
+{
+    return currentLevel.load(std::memory_order_relaxed);
+}
+
+bool Utils::Log::parseLevel(const std::string& name, Level& level)
+{
+    static const std::pair<const char*, Level> names[] = {
+        {"off", Level::Off}, {"error", Level::Error}, {"warn", Level::Warn},
+        {"info", Level::Info}, {"debug", Level::Debug}};
+    for (const auto& [key, value] : names) {
+        if (name == key) {
+            level = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Utils::Log::emit(Level messageLevel, const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cerr << prefix(messageLevel) << line << '\n';
+}
@@ -0,0 +1,40 @@
+/*
+** MappedFile - Read-only memory mapping of a whole file
+*/
+
+#include "Utils/MappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Utils::MappedFile::MappedFile(const std::string& path, Access access)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        _size = static_cast<std::size_t>(st.st_size);
+        if (_size == 0) {
+            _open = true;           // nothing to map, but a valid empty file
+        } else {
+            void* map = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                ::madvise(map, _size, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                _data = static_cast<const char*>(map);
+                _open = true;
+            } else {
+                _size = 0;
+            }
+        }
+    }
+    ::close(fd);                    // the mapping keeps its own reference
+}
+
+Utils::MappedFile::~MappedFile()
+{
+    if (_data)
+        ::munmap(const_cast<char*>(_data), _size);
+}
@@ -0,0 +1,227 @@
+/*
+** MeshFile - Binary .rtmesh mesh files, loaded by memory mapping
+*/
+
+#include "Utils/MeshFile.hpp"
+#include "Utils/FileIO.hpp"
+#include "Utils/Log.hpp"
+#include "Utils/MappedFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    constexpr char Magic[8] = {'R', 'T', 'M', 'E', 'S', 'H', '\0', '\0'};
+
+    static_assert(sizeof(Utils::MeshFile::Header) == 128);
+    static_assert(sizeof(RayTracer::Mesh::Node) == 32);
+
+    std::size_t alignSection(std::size_t offset)
+    {
+        const std::size_t a = Utils::MeshFile::SectionAlignment;
+        return (offset + a - 1) / a * a;
+    }
+
+    // True if count elements of size bytes at offset lie inside the file
+    bool sectionFits(uint64_t offset, uint64_t count, std::size_t size, std::size_t fileSize)
+    {
+        if (offset % alignof(float) != 0 || offset > fileSize)
+            return false;
+        return count <= (fileSize - offset) / size;
+    }
+}
+
+namespace Utils {
+
+bool MeshFile::isMeshFile(const std::string& path)
+{
+    const std::string ext(Extension);
+    return path.size() > ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+std::string MeshFile::companionOf(const std::string& objPath)
+{
+    auto dot = objPath.find_last_of('.');
+    auto slash = objPath.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return "";
+
+    std::string companion = objPath.substr(0, dot) + Extension;
+    struct stat obj{}, mesh{};
+    if (::stat(companion.c_str(), &mesh) != 0)
+        return "";
+    if (::stat(objPath.c_str(), &obj) == 0 && obj.st_mtime > mesh.st_mtime)
+        return "";
+    return companion;
+}
+
+bool MeshFile::bounds(const std::string& path, double min[3], double max[3])
+{
+    Header header;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    ssize_t got = ::pread(fd, &header, sizeof(Header), 0);
+    ::close(fd);
+
+    if (got != static_cast<ssize_t>(sizeof(Header))
+        || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0
+        || header.byteOrder != ByteOrderMark || header.version != Version)
+        return false;
+    for (int axis = 0; axis < 3; ++axis) {
+        min[axis] = header.boundsMin[axis];
+        max[axis] = header.boundsMax[axis];
+    }
+    return true;
+}
+
+std::size_t MeshFile::write(const std::string& path, const RayTracer::Mesh& mesh, bool withBVH)
+{
+    std::vector<char> buffer = serialize(mesh, withBVH);
+    writeFile(path, buffer.data(), buffer.size());
+    return buffer.size();
+}
+
+std::vector<char> MeshFile::serialize(const RayTracer::Mesh& mesh, bool withBVH)
+{
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.vertexCount = mesh.vertexCount();
+    header.triangleCount = mesh.triangleCount();
+    header.normalCount = mesh.normals() ? mesh.vertexCount() : 0;
+    header.uvCount = mesh.uvs() ? mesh.vertexCount() : 0;
+    header.nodeCount = withBVH ? mesh.nodeCount() : 0;
+
+    const std::size_t vertexBytes = header.vertexCount * 3 * sizeof(float);
+    const std::size_t indexBytes = header.triangleCount * 3 * sizeof(uint32_t);
+    const std::size_t normalBytes = header.normalCount * 3 * sizeof(float);
+    const std::size_t nodeBytes = header.nodeCount * sizeof(RayTracer::Mesh::Node);
+    const std::size_t uvBytes = header.uvCount * 2 * sizeof(float);
+
+    header.vertexOffset = alignSection(sizeof(Header));
+    header.indexOffset = alignSection(header.vertexOffset + vertexBytes);
+    header.normalOffset = alignSection(header.indexOffset + indexBytes);
+    header.nodeOffset = alignSection(header.normalOffset + normalBytes);
+    header.uvOffset = alignSection(header.nodeOffset + nodeBytes);
+    const std::size_t total = header.uvOffset + uvBytes;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = std::numeric_limits<float>::max();
+        header.boundsMax[axis] = std::numeric_limits<float>::lowest();
+    }
+    const float* vertices = mesh.vertices();
+    for (std::size_t v = 0; v < header.vertexCount; ++v) {
+        for (int axis = 0; axis < 3; ++axis) {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], vertices[3 * v + axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], vertices[3 * v + axis]);
+        }
+    }
+
+    std::vector<char> buffer(total, 0);
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    if (vertexBytes)
+        std::memcpy(buffer.data() + header.vertexOffset, vertices, vertexBytes);
+    if (indexBytes)
+        std::memcpy(buffer.data() + header.indexOffset, mesh.indices(), indexBytes);
+    if (normalBytes)
+        std::memcpy(buffer.data() + header.normalOffset, mesh.normals(), normalBytes);
+    if (nodeBytes)
+        std::memcpy(buffer.data() + header.nodeOffset, mesh.nodes(), nodeBytes);
+    if (uvBytes)
+        std::memcpy(buffer.data() + header.uvOffset, mesh.uvs(), uvBytes);
+    return buffer;
+}
+
+std::shared_ptr<RayTracer::Mesh> MeshFile::load(
+    const std::string& path,
+    double scale,
+    const Math::Point3D& position,
+    const Color& color,
+    RayTracer::Mesh::Shading shading)
+{
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Access::Random);
+    if (!file->isOpen()) {
+        Log::error("Could not open mesh file: ", path);
+        return std::make_shared<RayTracer::Mesh>(std::vector<float>(), std::vector<uint32_t>(), color);
+    }
+
+    return load(file, 0, file->size(), path, scale, position, color, shading);
+}
+
+std::shared_ptr<RayTracer::Mesh> MeshFile::load(
+    std::shared_ptr<const MappedFile> file,
+    std::size_t offset,
+    std::size_t size,
+    const std::string& path,
+    double scale,
+    const Math::Point3D& position,
+    const Color& color,
+    RayTracer::Mesh::Shading shading)
+{
+    Header header;
+    if (offset > file->size() || size > file->size() - offset || size < sizeof(Header))
+        throw std::runtime_error("Truncated mesh file: " + path);
+    const char* base = file->data() + offset;
+    std::memcpy(&header, base, sizeof(Header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+        throw std::runtime_error("Not a mesh file: " + path);
+    if (header.byteOrder != ByteOrderMark)
+        throw std::runtime_error("Mesh file written with another byte order: " + path);
+    if (header.version != Version)
+        throw std::runtime_error("Unsupported mesh file version " + std::to_string(header.version) + ": " + path);
+
+    if (!sectionFits(header.vertexOffset, header.vertexCount, 3 * sizeof(float), size)
+        || !sectionFits(header.indexOffset, header.triangleCount, 3 * sizeof(uint32_t), size)
+        || !sectionFits(header.normalOffset, header.normalCount, 3 * sizeof(float), size)
+        || !sectionFits(header.nodeOffset, header.nodeCount, sizeof(RayTracer::Mesh::Node), size)
+        || !sectionFits(header.uvOffset, header.uvCount, 2 * sizeof(float), size)
+        || header.vertexCount > std::numeric_limits<uint32_t>::max()
+        || (header.normalCount != 0 && header.normalCount != header.vertexCount)
+        || (header.uvCount != 0 && header.uvCount != header.vertexCount))
+        throw std::runtime_error("Corrupt mesh file: " + path);
+
+    RayTracer::Mesh::View view;
+    view.vertices = reinterpret_cast<const float*>(base + header.vertexOffset);
+    view.vertexCount = header.vertexCount;
+    view.indices = reinterpret_cast<const uint32_t*>(base + header.indexOffset);
+    view.triangleCount = header.triangleCount;
+    view.nodes = reinterpret_cast<const RayTracer::Mesh::Node*>(base + header.nodeOffset);
+    view.nodeCount = header.nodeCount;
+    if (header.normalCount)
+        view.normals = reinterpret_cast<const float*>(base + header.normalOffset);
+    if (header.uvCount)
+        view.uvs = reinterpret_cast<const float*>(base + header.uvOffset);
+
+    std::shared_ptr<RayTracer::Mesh> mesh;
+    if (header.nodeCount > 0 || header.triangleCount == 0) {
+        if (!RayTracer::Mesh::isValid(view))
+            throw std::runtime_error("Corrupt mesh file: " + path);
+        mesh = std::make_shared<RayTracer::Mesh>(file, view, color);
+    } else {
+        // No stored BVH: copy the arrays out and build one, checking indices on the way
+        std::vector<float> vertices(view.vertices, view.vertices + 3 * view.vertexCount);
+        std::vector<uint32_t> indices(view.indices, view.indices + 3 * view.triangleCount);
+        for (uint32_t index : indices)
+            if (index >= view.vertexCount)
+                throw std::runtime_error("Corrupt mesh file: " + path);
+        mesh = std::make_shared<RayTracer::Mesh>(std::move(vertices), std::move(indices), color);
+        if (view.normals)
+            mesh->setNormals(std::vector<float>(view.normals, view.normals + 3 * view.vertexCount));
+        if (view.uvs)
+            mesh->setUVs(std::vector<float>(view.uvs, view.uvs + 2 * view.vertexCount));
+    }
+    mesh->applyShading(shading);
+    mesh->setPlacement(scale, position);
+
+    Log::info("Loaded ", path, ": ", mesh->vertexCount(), " vertices, ", mesh->triangleCount(), " faces");
+    return mesh;
+}
+
+}
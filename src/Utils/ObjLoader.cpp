@@ -2,113 +2,465 @@
 ** ObjLoader - Implementation of the OBJ file parser
 */
 #include "Utils/ObjLoader.hpp"
-#include "RayTracer/Triangle.hpp"
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include "Utils/MappedFile.hpp"
+#include "Utils/ThreadPool.hpp"
+#include "Utils/Log.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const char* skipBlanks(const char* p, const char* end)
+    {
+        while (p < end && isBlank(*p))
+            ++p;
+        return p;
+    }
+
+    // A position paired with a normal/uv combination other than its first
+    struct SplitKey {
+        uint32_t vertex;
+        uint64_t pair;
+        bool operator==(const SplitKey&) const = default;
+    };
+
+    struct SplitKeyHash {
+        std::size_t operator()(const SplitKey& key) const
+        {
+            return std::hash<uint64_t>()(key.pair * 0x9E3779B97F4A7C15ull ^ key.vertex);
+        }
+    };
+
+    // from_chars rejects an explicit '+', which OBJ exporters do emit
+    template <typename T>
+    const char* parseNumber(const char* p, const char* end, T& value)
+    {
+        if (p < end && *p == '+')
+            ++p;
+        auto [next, ec] = std::from_chars(p, end, value);
+        return ec == std::errc() ? next : nullptr;
+    }
+}
 
 namespace Utils {
 
-std::shared_ptr<RayTracer::CompositePrimitive> ObjLoader::load(
+std::shared_ptr<RayTracer::Mesh> ObjLoader::load(
     const std::string& objPath,
     double scale,
     const Math::Point3D& position,
-    const Color& color)
+    const Color& color,
+    RayTracer::Mesh::Shading shading)
 {
-    std::ifstream file(objPath);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open OBJ file: " << objPath << std::endl;
-        return std::make_shared<RayTracer::CompositePrimitive>(color);
+    auto start = std::chrono::steady_clock::now();
+    ObjMeshData data;
+    if (!parse(objPath, data, scale, position)) {
+        Log::error("Could not open OBJ file: ", objPath);
+        return std::make_shared<RayTracer::Mesh>(std::vector<float>(), std::vector<uint32_t>(), color);
     }
 
-    std::vector<Math::Point3D> vertices;
-    auto composite = std::make_shared<RayTracer::CompositePrimitive>(color);
+    auto mesh = std::make_shared<RayTracer::Mesh>(
+        std::move(data.positions), std::move(data.triangles), color);
+    mesh->setNormals(std::move(data.normals));
+    mesh->setUVs(std::move(data.uvs));
+    mesh->applyShading(shading);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    Log::info("Loaded ", objPath, ": ", mesh->vertexCount(), " vertices, ", mesh->triangleCount(),
+              " faces in ", elapsed.count(), " ms (BVH ", mesh->buildSeconds() * 1e3, " ms)");
+
+    return mesh;
+}
+
+bool ObjLoader::parse(
+    const std::string& objPath,
+    ObjMeshData& out,
+    double scale,
+    const Math::Point3D& position)
+{
+    MappedFile file(objPath);
+    if (!file.isOpen())
+        return false;
+    parse(file.data(), file.end(), out, scale, position);
+    return true;
+}
+
+bool ObjLoader::bounds(
+    const std::string& objPath,
+    double scale,
+    const Math::Point3D& position,
+    double min[3],
+    double max[3])
+{
+    MappedFile file(objPath);
+    if (!file.isOpen())
+        return false;
+
+    bool any = false;
+    const char* end = file.end();
+    for (const char* line = file.data(); line < end; ) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol)
+            eol = end;
+
+        const char* p = skipBlanks(line, eol);
+        if (eol - p >= 2 && p[0] == 'v' && isBlank(p[1])) {
+            double xyz[3];
+            p += 2;
+            for (double& v : xyz)
+                if (p)
+                    p = parseNumber(skipBlanks(p, eol), eol, v);
+            if (p) {
+                // Same float rounding as parseVertex, so the box holds the mesh
+                const double offset[3] = {position._x, position._y, position._z};
+                for (int axis = 0; axis < 3; ++axis) {
+                    double v = static_cast<float>(xyz[axis] * scale + offset[axis]);
+                    min[axis] = any ? std::min(min[axis], v) : v;
+                    max[axis] = any ? std::max(max[axis], v) : v;
+                }
+                any = true;
+            }
+        }
+        line = eol + 1;
+    }
+    return any;
+}
+
+void ObjLoader::parse(
+    const char* begin,
+    const char* end,
+    ObjMeshData& out,
+    double scale,
+    const Math::Point3D& position)
+{
+    const std::size_t minChunk = 1 << 20;
+    ThreadPool& pool = ThreadPool::global();
+    std::size_t size = static_cast<std::size_t>(end - begin);
+    std::size_t count = std::clamp<std::size_t>(size / minChunk, 1, pool.size() * 4);
+
+    // Cut the text at line boundaries
+    std::vector<const char*> bounds(count + 1, end);
+    bounds[0] = begin;
+    for (std::size_t i = 1; i < count; ++i) {
+        const char* p = std::max(begin + size * i / count, bounds[i - 1]);
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        bounds[i] = eol ? eol + 1 : end;
+    }
+
+    std::vector<Chunk> chunks(count);
+    out = ObjMeshData();
+    pool.parallelFor(count, [&](std::size_t i) {
+        parseChunk(bounds[i], bounds[i + 1], chunks[i], scale, position);
+    });
+
+    // Prefix sums give every chunk its first vertex, normal and texture coordinate
+    std::vector<std::size_t> vertexBase(count + 1, 0);
+    std::vector<std::size_t> normalBase(count + 1, 0);
+    std::vector<std::size_t> uvBase(count + 1, 0);
+    bool anyNormals = false;
+    bool anyUVs = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        vertexBase[i + 1] = vertexBase[i] + chunks[i].positions.size() / 3;
+        normalBase[i + 1] = normalBase[i] + chunks[i].normals.size() / 3;
+        uvBase[i + 1] = uvBase[i] + chunks[i].uvs.size() / 2;
+        anyNormals = anyNormals || chunks[i].hasNormals;
+        anyUVs = anyUVs || chunks[i].hasUVs;
+    }
+    anyNormals = anyNormals && normalBase[count] > 0;     // references to nothing are ignored
+    anyUVs = anyUVs && uvBase[count] > 0;
+    const long long total = static_cast<long long>(vertexBase[count]);
+    const long long totalNormals = static_cast<long long>(normalBase[count]);
+    const long long totalUVs = static_cast<long long>(uvBase[count]);
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#')
+    // Rebase relative indices, then drop triangles referencing missing vertices
+    // and forget normals or texture coordinates that do not exist
+    pool.parallelFor(count, [&](std::size_t i) {
+        Chunk& chunk = chunks[i];
+        for (std::size_t slot : chunk.relative)
+            chunk.triangles[slot] += static_cast<int>(vertexBase[i]);
+        for (std::size_t slot : chunk.relativeNormals)
+            chunk.cornerNormals[slot] += static_cast<int>(normalBase[i]);
+        for (std::size_t slot : chunk.relativeUVs)
+            chunk.cornerUVs[slot] += static_cast<int>(uvBase[i]);
+
+        auto valid = [total](long long idx) { return idx >= 0 && idx < total; };
+        const bool normals = chunk.hasNormals;
+        const bool uvs = chunk.hasUVs;
+        std::size_t kept = 0;
+        for (std::size_t t = 0; t < chunk.triangles.size(); t += 3) {
+            const int* tri = &chunk.triangles[t];
+            if (valid(tri[0]) && valid(tri[1]) && valid(tri[2])) {
+                std::copy(tri, tri + 3, chunk.triangles.begin() + kept);
+                if (normals)
+                    std::copy_n(chunk.cornerNormals.begin() + t, 3, chunk.cornerNormals.begin() + kept);
+                if (uvs)
+                    std::copy_n(chunk.cornerUVs.begin() + t, 3, chunk.cornerUVs.begin() + kept);
+                kept += 3;
+            }
+        }
+        chunk.triangles.resize(kept);
+        if (normals)
+            chunk.cornerNormals.resize(kept);
+        if (uvs)
+            chunk.cornerUVs.resize(kept);
+
+        for (int& idx : chunk.cornerNormals)
+            if (idx < 0 || idx >= totalNormals)
+                idx = NoAttribute;
+        for (int& idx : chunk.cornerUVs)
+            if (idx < 0 || idx >= totalUVs)
+                idx = NoAttribute;
+    });
+
+    std::vector<std::size_t> triangleBase(count + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        triangleBase[i + 1] = triangleBase[i] + chunks[i].triangles.size();
+        out.faces += chunks[i].faces;
+    }
+    out.positions.resize(3 * vertexBase[count]);
+    out.triangles.resize(triangleBase[count]);
+
+    std::vector<float> normals(anyNormals ? 3 * normalBase[count] : 0);
+    std::vector<float> uvs(anyUVs ? 2 * uvBase[count] : 0);
+    std::vector<int> cornerNormals(anyNormals ? triangleBase[count] : 0);
+    std::vector<int> cornerUVs(anyUVs ? triangleBase[count] : 0);
+
+    pool.parallelFor(count, [&](std::size_t i) {
+        const Chunk& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(),
+                  out.positions.begin() + 3 * vertexBase[i]);
+        std::copy(chunk.triangles.begin(), chunk.triangles.end(),
+                  out.triangles.begin() + triangleBase[i]);
+        if (anyNormals) {
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + 3 * normalBase[i]);
+            if (!chunk.hasNormals)
+                std::fill_n(cornerNormals.begin() + triangleBase[i], chunk.triangles.size(), NoAttribute);
+            else
+                std::copy(chunk.cornerNormals.begin(), chunk.cornerNormals.end(), cornerNormals.begin() + triangleBase[i]);
+        }
+        if (anyUVs) {
+            std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + 2 * uvBase[i]);
+            if (!chunk.hasUVs)
+                std::fill_n(cornerUVs.begin() + triangleBase[i], chunk.triangles.size(), NoAttribute);
+            else
+                std::copy(chunk.cornerUVs.begin(), chunk.cornerUVs.end(), cornerUVs.begin() + triangleBase[i]);
+        }
+    });
+
+    if (anyNormals || anyUVs)
+        weldAttributes(out, normals, uvs, cornerNormals, cornerUVs);
+}
+
+void ObjLoader::weldAttributes(
+    ObjMeshData& out,
+    const std::vector<float>& normals,
+    const std::vector<float>& uvs,
+    const std::vector<int>& cornerNormals,
+    const std::vector<int>& cornerUVs)
+{
+    const bool hasNormals = !cornerNormals.empty();
+    const bool hasUVs = !cornerUVs.empty();
+    const std::size_t vertices = out.positions.size() / 3;
+    out.normals.assign(hasNormals ? 3 * vertices : 0, 0.f);
+    out.uvs.assign(hasUVs ? 2 * vertices : 0, 0.f);
+
+    auto assign = [&](uint32_t vertex, int normal, int uv) {
+        if (hasNormals && normal != NoAttribute)
+            std::copy_n(&normals[3 * static_cast<std::size_t>(normal)], 3, &out.normals[3 * vertex]);
+        if (hasUVs && uv != NoAttribute)
+            std::copy_n(&uvs[2 * static_cast<std::size_t>(uv)], 2, &out.uvs[2 * vertex]);
+    };
+
+    // The first normal/uv pair seen with a position claims it; other pairs
+    // get a copy of the position, shared by every corner using that pair
+    const uint64_t unclaimed = std::numeric_limits<uint64_t>::max();
+    std::vector<uint64_t> claim(vertices, unclaimed);
+    std::unordered_map<SplitKey, uint32_t, SplitKeyHash> splits;
+
+    for (std::size_t c = 0; c < out.triangles.size(); ++c) {
+        const uint32_t vertex = out.triangles[c];
+        const int normal = hasNormals ? cornerNormals[c] : NoAttribute;
+        const int uv = hasUVs ? cornerUVs[c] : NoAttribute;
+        const uint64_t pair = (uint64_t(uint32_t(normal)) << 32) | uint32_t(uv);
+
+        if (claim[vertex] == unclaimed) {
+            claim[vertex] = pair;
+            assign(vertex, normal, uv);
+            continue;
+        }
+        if (claim[vertex] == pair)
             continue;
 
-        if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t')) {
-            parseVertex(line, vertices, scale, position);
-        } else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t')) {
-            parseFace(line, vertices, composite, color);
+        const uint32_t next = static_cast<uint32_t>(out.positions.size() / 3);
+        auto [it, inserted] = splits.try_emplace(SplitKey{vertex, pair}, next);
+        if (inserted) {
+            for (int axis = 0; axis < 3; ++axis)
+                out.positions.push_back(out.positions[3 * vertex + axis]);
+            out.normals.resize(hasNormals ? 3 * (next + 1) : 0, 0.f);
+            out.uvs.resize(hasUVs ? 2 * (next + 1) : 0, 0.f);
+            assign(next, normal, uv);
         }
-        // Ignore other OBJ elements like texture coords, normals, etc. for now
+        out.triangles[c] = it->second;
     }
+}
+
+void ObjLoader::parseChunk(
+    const char* begin,
+    const char* end,
+    Chunk& out,
+    double scale,
+    const Math::Point3D& position)
+{
+    std::vector<Corner> polygon;
 
-    std::cout << "Loaded " << objPath << ": "
-              << vertices.size() << " vertices, "
-              << composite->getChildCount() << " faces" << std::endl;
+    for (const char* line = begin; line < end; ) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol)
+            eol = end;
 
-    return composite;
+        const char* p = skipBlanks(line, eol);
+        if (eol - p >= 2 && isBlank(p[1])) {
+            if (p[0] == 'v')
+                parseVertex(p + 2, eol, out, scale, position);
+            else if (p[0] == 'f')
+                parseFace(p + 2, eol, out, polygon);
+        } else if (eol - p >= 3 && p[0] == 'v' && isBlank(p[2])) {
+            if (p[1] == 'n')
+                parseAttribute(p + 3, eol, out.normals, 3, 3);
+            else if (p[1] == 't')
+                parseAttribute(p + 3, eol, out.uvs, 1, 2);
+        }
+        // Ignore comments and other OBJ elements like groups and materials
+        line = eol + 1;
+    }
 }
 
 void ObjLoader::parseVertex(
-    const std::string& line,
-    std::vector<Math::Point3D>& vertices,
+    const char* p,
+    const char* end,
+    Chunk& out,
     double scale,
     const Math::Point3D& position)
 {
-    std::istringstream iss(line.substr(1)); // Skip the 'v' prefix
-    double x, y, z;
-
-    if (iss >> x >> y >> z) {
-        // Apply scale and position offset
-        vertices.push_back(Math::Point3D(
-            x * scale + position._x,
-            y * scale + position._y,
-            z * scale + position._z
-        ));
+    double xyz[3];
+    for (double& v : xyz) {
+        p = parseNumber(skipBlanks(p, end), end, v);
+        if (!p)
+            return;             // malformed vertex, skipped
     }
+
+    // Apply scale and position offset
+    out.positions.push_back(static_cast<float>(xyz[0] * scale + position._x));
+    out.positions.push_back(static_cast<float>(xyz[1] * scale + position._y));
+    out.positions.push_back(static_cast<float>(xyz[2] * scale + position._z));
+}
+
+void ObjLoader::parseAttribute(
+    const char* p,
+    const char* end,
+    std::vector<float>& out,
+    int required,
+    int count)
+{
+    float values[3] = {0.f, 0.f, 0.f};
+    for (int i = 0; i < count; ++i) {
+        const char* next = parseNumber(skipBlanks(p, end), end, values[i]);
+        if (!next) {
+            if (i < required)
+                return;         // malformed record, skipped
+            break;
+        }
+        p = next;
+    }
+    out.insert(out.end(), values, values + count);
 }
 
 void ObjLoader::parseFace(
-    const std::string& line,
-    const std::vector<Math::Point3D>& vertices,
-    std::shared_ptr<RayTracer::CompositePrimitive>& composite,
-    const Color& color)
+    const char* p,
+    const char* end,
+    Chunk& out,
+    std::vector<Corner>& polygon)
 {
-    std::istringstream iss(line.substr(1)); // Skip the 'f' prefix
-    std::string segment;
-    std::vector<int> vertexIndices;
+    polygon.clear();
+    const int defined = static_cast<int>(out.positions.size() / 3);
+    const int definedNormals = static_cast<int>(out.normals.size() / 3);
+    const int definedUVs = static_cast<int>(out.uvs.size() / 2);
+
+    // OBJ indices are 1-based, or count back from the last element
+    // defined when negative (resolved against this chunk for now)
+    auto resolve = [](int idx, int defined) { return idx > 0 ? idx - 1 : defined + idx; };
 
     // Parse vertex indices, handling different OBJ formats:
     // f v1 v2 v3 ...                (simple vertex indices)
     // f v1/vt1/vn1 v2/vt2/vn2 ...   (vertex/texture/normal)
     // f v1//vn1 v2//vn2 ...         (vertex//normal)
-    while (iss >> segment) {
-        std::istringstream indexStream(segment);
-        std::string indexStr;
-
-        if (std::getline(indexStream, indexStr, '/')) {
-            try {
-                int idx = std::stoi(indexStr);
-                // OBJ indices are 1-based, convert to 0-based
-                vertexIndices.push_back(idx - 1);
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing face index: " << indexStr << std::endl;
+    while ((p = skipBlanks(p, end)) < end) {
+        int idx = 0;
+        const char* next = parseNumber(p, end, idx);
+        if (next && idx != 0) {
+            Corner corner{resolve(idx, defined), NoAttribute, NoAttribute, idx < 0, false, false};
+            p = next;
+            if (p < end && *p == '/') {
+                int uv = 0;
+                next = parseNumber(++p, end, uv);
+                if (next && uv != 0) {
+                    corner.uv = resolve(uv, definedUVs);
+                    corner.relativeUV = uv < 0;
+                    p = next;
+                }
+                if (p < end && *p == '/') {
+                    int normal = 0;
+                    next = parseNumber(++p, end, normal);
+                    if (next && normal != 0) {
+                        corner.normal = resolve(normal, definedNormals);
+                        corner.relativeNormal = normal < 0;
+                        p = next;
+                    }
+                }
             }
+            polygon.push_back(corner);
+        } else {
+            Log::warn("Error parsing face index: ", std::string(p, std::find_if(p, end, isBlank)));
         }
+        while (p < end && !isBlank(*p))
+            ++p;                // skip whatever is left of a malformed reference
     }
+    ++out.faces;
 
     // Create triangles from the face (triangulation for polygons with > 3 vertices)
-    if (vertexIndices.size() >= 3) {
-        // Convert polygon to triangle fan (simple triangulation for convex polygons)
-        for (size_t i = 2; i < vertexIndices.size(); ++i) {
-            int idx1 = vertexIndices[0];
-            int idx2 = vertexIndices[i-1];
-            int idx3 = vertexIndices[i];
-
-            // Ensure indices are valid
-            if (idx1 >= 0 && idx1 < static_cast<int>(vertices.size()) &&
-                idx2 >= 0 && idx2 < static_cast<int>(vertices.size()) &&
-                idx3 >= 0 && idx3 < static_cast<int>(vertices.size())) {
-
-                auto triangle = std::make_shared<RayTracer::Triangle>(
-                    vertices[idx1], vertices[idx2], vertices[idx3], color);
-                composite->addChild(triangle);
+    // Convert polygon to triangle fan (simple triangulation for convex polygons)
+    for (std::size_t i = 2; i < polygon.size(); ++i) {
+        for (std::size_t k : {std::size_t{0}, i - 1, i}) {
+            const Corner& corner = polygon[k];
+            // Attribute arrays start at the first corner that has one
+            if (corner.normal != NoAttribute && !out.hasNormals) {
+                out.cornerNormals.assign(out.triangles.size(), NoAttribute);
+                out.hasNormals = true;
+            }
+            if (corner.uv != NoAttribute && !out.hasUVs) {
+                out.cornerUVs.assign(out.triangles.size(), NoAttribute);
+                out.hasUVs = true;
+            }
+
+            if (out.hasNormals) {
+                if (corner.relativeNormal)
+                    out.relativeNormals.push_back(out.cornerNormals.size());
+                out.cornerNormals.push_back(corner.normal);
+            }
+            if (out.hasUVs) {
+                if (corner.relativeUV)
+                    out.relativeUVs.push_back(out.cornerUVs.size());
+                out.cornerUVs.push_back(corner.uv);
             }
+            if (corner.relativePosition)
+                out.relative.push_back(out.triangles.size());
+            out.triangles.push_back(corner.position);
         }
     }
 }
@@ -0,0 +1,99 @@
+/*
+** PNG - Building blocks of the PNG encoder
+*/
+
+#include "Utils/PNG.hpp"
+#include "Utils/Deflate.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    void putBE32(std::vector<uint8_t>& out, uint32_t v)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<uint8_t>(v >> shift));
+    }
+
+    uint8_t paeth(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = std::abs(p - a);
+        int pb = std::abs(p - b);
+        int pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return static_cast<uint8_t>(a);
+        return static_cast<uint8_t>(pb <= pc ? b : c);
+    }
+}
+
+std::vector<uint8_t> Utils::PNG::header(int width, int height)
+{
+    std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, static_cast<uint32_t>(width));
+    putBE32(ihdr, static_cast<uint32_t>(height));
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, deflate, no interlace
+    appendChunk(out, "IHDR", ihdr.data(), ihdr.size());
+    return out;
+}
+
+void Utils::PNG::appendChunk(std::vector<uint8_t>& out, const char type[4],
+                             const uint8_t* data, std::size_t size)
+{
+    putBE32(out, static_cast<uint32_t>(size));
+    std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0)
+        out.insert(out.end(), data, data + size);
+    putBE32(out, Utils::crc32(out.data() + start, size + 4));
+}
+
+void Utils::PNG::appendAdler(std::vector<uint8_t>& out, uint32_t adler)
+{
+    putBE32(out, adler);
+}
+
+Utils::PNG::Strip Utils::PNG::compressStrip(const uint8_t* rgb, int width, int rows, bool last)
+{
+    const std::size_t stride = static_cast<std::size_t>(width) * 3;
+
+    // Filter every row with whichever of None/Sub/Up/Paeth gives the
+    // smallest sum of absolute residuals (the usual libpng heuristic).
+    // The first row of a strip may not refer to the strip above it.
+    std::vector<uint8_t> filtered((stride + 1) * rows);
+    std::vector<uint8_t> candidate(stride);
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* row = rgb + y * stride;
+        const uint8_t* up = y > 0 ? row - stride : nullptr;
+        uint8_t* dst = filtered.data() + y * (stride + 1);
+        long best = -1;
+
+        for (uint8_t type : {0, 1, 2, 4}) {
+            if (!up && type >= 2)
+                break;
+            long cost = 0;
+            for (std::size_t i = 0; i < stride; ++i) {
+                int left = i >= 3 ? row[i - 3] : 0;
+                int above = up ? up[i] : 0;
+                int corner = (up && i >= 3) ? up[i - 3] : 0;
+                uint8_t predicted = type == 0 ? 0
+                                  : type == 1 ? left
+                                  : type == 2 ? above
+                                  : paeth(left, above, corner);
+                candidate[i] = static_cast<uint8_t>(row[i] - predicted);
+                cost += std::abs(static_cast<int8_t>(candidate[i]));
+            }
+            if (best < 0 || cost < best) {
+                best = cost;
+                dst[0] = type;
+                std::memcpy(dst + 1, candidate.data(), stride);
+            }
+        }
+    }
+
+    Strip strip;
+    strip.rawSize = filtered.size();
+    strip.adler = Utils::adler32(filtered.data(), filtered.size());
+    strip.data = Utils::deflate(filtered.data(), filtered.size(), last);
+    return strip;
+}
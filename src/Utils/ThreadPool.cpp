@@ -0,0 +1,116 @@
+/*
+** ThreadPool - Implementation of the worker pool
+*/
+
+#include "Utils/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace Utils {
+
+ThreadPool::ThreadPool(std::size_t threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 4;
+
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        _workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _cv.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+void ThreadPool::submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push(std::move(task));
+    }
+    _cv.notify_one();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body)
+{
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::size_t count = 0;
+        std::function<void(std::size_t)> body;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t finished = 0;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->body = body;
+
+    auto work = [](State& s) {
+        std::size_t i;
+        while ((i = s.next++) < s.count) {
+            std::exception_ptr error;
+            try {
+                s.body(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (error && !s.error)
+                s.error = error;
+            if (++s.finished == s.count)
+                s.cv.notify_all();
+        }
+    };
+
+    // Helpers that start after the caller took every index simply return
+    std::size_t helpers = std::min(_workers.size(), count > 0 ? count - 1 : 0);
+    for (std::size_t i = 0; i < helpers; ++i)
+        submit([state, work] { work(*state); });
+    work(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->finished == state->count; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+std::size_t ThreadPool::size() const
+{
+    return _workers.size();
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+            if (_tasks.empty())
+                return;             // stopping and nothing left to run
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+        task();
+    }
+}
+
+}  // namespace Utils
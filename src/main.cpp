@@ -5,26 +5,46 @@
 **
 */
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include "Core/Scene.hpp"
 #include "Renderer/Renderer.hpp"
 #include "Renderer/Image.hpp"
 #include "RayTracer/Camera.hpp"
 #include "Core/PrimitiveFactory.hpp"
 #include "UI/CommandLineInterface.hpp"
+#include "Utils/Log.hpp"
 
 int main(int ac, char** av)
 {
     if (ac < 2) {
-        std::cerr << "Usage: ./raytracer <scene.cfg>\n";
+        std::cerr << "Usage: ./raytracer <scene.cfg | scene.rtscene>\n";
         return 84;
     }
+    Utils::Log::Level level;
+    if (const char* name = std::getenv("RAYTRACER_LOG")) {
+        if (Utils::Log::parseLevel(name, level))
+            Utils::Log::setLevel(level);
+        else
+            std::cerr << "Unknown RAYTRACER_LOG level \"" << name << "\", expected off, error, warn, info or debug\n";
+    }
+
     Core::PrimitiveFactory factory;
     factory.loadPlugins("plugins");
 
     Scene scene(factory);
+    const std::string path = av[1];
+    const std::string snapshotExt = ".rtscene";
     try {
-        scene.loadFromFile(av[1]);
+        if (path.size() > snapshotExt.size()
+            && path.compare(path.size() - snapshotExt.size(), snapshotExt.size(), snapshotExt) == 0) {
+            // A stale snapshot falls back to its source and is rewritten
+            if (!scene.loadSnapshot(path))
+                scene.saveSnapshot(path);
+        } else {
+            scene.loadFromFile(path);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Scene load error: " << e.what() << "\n";
         return 84;
@@ -37,6 +57,7 @@ int main(int ac, char** av)
     }
 
     Renderer renderer(cam->_width, cam->_height, 16);
+    renderer.setAdaptiveSampling(4);
     CommandLineInterface cli(scene, renderer);
     cli.run();
 
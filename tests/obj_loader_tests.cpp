@@ -0,0 +1,260 @@
+#include <criterion/criterion.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "Utils/FileIO.hpp"
+#include "Utils/MeshFile.hpp"
+#include "Utils/ObjLoader.hpp"
+#include "RayTracer/Mesh.hpp"
+#include "RayTracer/MeshCache.hpp"
+#include "RayTracer/MeshProxy.hpp"
+
+Test(obj_loader, parses_vertices_and_triangulates_faces)
+{
+    const std::string obj =
+        "# comment\n"
+        "o quad\n"
+        "v 0 0 0\n"
+        "v +1.5 0 0\r\n"
+        "  v 1.5 1e0 0\n"
+        "v 0 1 -0.25\n"
+        "vt 0.5 0.5\n"
+        "f 1/1/1 2/1/1 3/1/1 4/1/1\n"
+        "f 1//1 2//1 9//1\n";
+    Utils::ObjMeshData mesh;
+    Utils::ObjLoader::parse(obj.data(), obj.data() + obj.size(), mesh, 2.0, Math::Point3D(0, 0, 1));
+
+    cr_assert_eq(mesh.positions.size(), 12u, "Every vertex line should be read");
+    cr_assert_float_eq(mesh.positions[3], 3.0, 1e-9, "Scale should apply to explicit '+' values");
+    cr_assert_float_eq(mesh.positions[11], 0.5, 1e-9, "Position offset should apply");
+    cr_assert_eq(mesh.faces, 2u);
+    cr_assert_eq(mesh.triangles.size(), 6u, "The quad makes two triangles, the bad face none");
+    cr_assert_eq(mesh.triangles[3], 0u);
+    cr_assert_eq(mesh.triangles[4], 2u);
+    cr_assert_eq(mesh.triangles[5], 3u);
+}
+
+Test(obj_loader, missing_file)
+{
+    Utils::ObjMeshData mesh;
+    cr_assert_not(Utils::ObjLoader::parse("nonexistent.obj", mesh));
+}
+
+Test(obj_loader, resolves_relative_indices_across_chunks)
+{
+    // Big enough to be split into several chunks
+    std::string obj;
+    const int quads = 60000;
+    for (int i = 0; i < quads; ++i) {
+        obj += "v " + std::to_string(i) + " 0 0\n";
+        obj += "v " + std::to_string(i) + " 1 0\n";
+        obj += "v " + std::to_string(i) + " 1 1\n";
+        obj += "f -3 -2 -1\n";
+        obj += "f " + std::to_string(3 * i + 1) + "/1 " + std::to_string(3 * i + 2)
+             + "/1 " + std::to_string(3 * i + 3) + "/1\n";
+    }
+    Utils::ObjMeshData mesh;
+    Utils::ObjLoader::parse(obj.data(), obj.data() + obj.size(), mesh, 1.0, Math::Point3D(0, 0, 0));
+
+    cr_assert_eq(mesh.positions.size(), 9u * quads);
+    cr_assert_eq(mesh.faces, 2u * quads);
+    cr_assert_eq(mesh.triangles.size(), 6u * quads);
+    for (int i = 0; i < quads; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            uint32_t vertex = 3 * i + k;
+            cr_assert_eq(mesh.triangles[6 * i + k], vertex, "Relative index should match vertex %u", vertex);
+            cr_assert_eq(mesh.triangles[6 * i + 3 + k], vertex);
+        }
+    }
+}
+
+Test(obj_loader, mesh_hits_closest_triangle)
+{
+    // Two parallel quads facing +z, at z = 0 and z = -1
+    std::vector<float> vertices = {
+        -1, -1, 0,   1, -1, 0,   1, 1, 0,   -1, 1, 0,
+        -1, -1, -1,  1, -1, -1,  1, 1, -1,  -1, 1, -1};
+    std::vector<uint32_t> indices = {4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3};
+    RayTracer::Mesh mesh(vertices, indices, Color(10, 20, 30));
+
+    HitInfo hit;
+    RayTracer::Ray ray(Math::Point3D(0.2, 0.3, 5), Math::Vector3D(0, 0, -1));
+    cr_assert(mesh.hits(ray, hit));
+    cr_assert_float_eq(hit.t, 5.0, 1e-6, "The nearest quad should be reported");
+    cr_assert_float_eq(hit.n._z, 1.0, 1e-6, "The normal should face the ray");
+    cr_assert_eq(hit.color->getB(), 30);
+
+    RayTracer::Ray miss(Math::Point3D(3, 0, 5), Math::Vector3D(0, 0, -1));
+    cr_assert_not(mesh.hits(miss, hit));
+    cr_assert_eq(mesh.triangleCount(), 4u);
+}
+
+Test(obj_loader, rtmesh_round_trip_with_placement)
+{
+    std::vector<float> vertices = {
+        -1, -1, 0,   1, -1, 0,   1, 1, 0,   -1, 1, 0,
+        -1, -1, -1,  1, -1, -1,  1, 1, -1,  -1, 1, -1};
+    std::vector<uint32_t> indices = {4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3};
+    RayTracer::Mesh source(vertices, indices);
+
+    const std::string path = "/tmp/obj_loader_tests.rtmesh";
+    for (bool withBVH : {true, false}) {
+        Utils::MeshFile::write(path, source, withBVH);
+        auto mesh = Utils::MeshFile::load(path, 2.0, Math::Point3D(0, 0, 10), Color(1, 2, 3));
+        cr_assert_eq(mesh->vertexCount(), 8u);
+        cr_assert_eq(mesh->triangleCount(), 4u);
+
+        // Front quad lands at z = 10 after placement, twice as wide
+        HitInfo hit;
+        RayTracer::Ray ray(Math::Point3D(1.5, 1.5, 15), Math::Vector3D(0, 0, -1));
+        cr_assert(mesh->hits(ray, hit));
+        cr_assert_float_eq(hit.t, 5.0, 1e-6, "Placement should apply to loaded meshes");
+        cr_assert_float_eq(hit.n._z, 1.0, 1e-6);
+        cr_assert_eq(hit.color->getG(), 2);
+    }
+
+    Utils::writeFile(path, "RTMESH", 6);
+    bool threw = false;
+    try {
+        Utils::MeshFile::load(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    cr_assert(threw, "A truncated file should be rejected");
+    std::remove(path.c_str());
+}
+
+Test(obj_loader, rtmesh_with_corrupt_indices_or_nodes_is_rejected)
+{
+    std::vector<float> vertices = {-1, -1, 0, 1, -1, 0, 1, 1, 0, -1, 1, 0};
+    RayTracer::Mesh source(vertices, {0, 1, 2, 0, 2, 3});
+    const std::vector<char> image = Utils::MeshFile::serialize(source, true);
+    Utils::MeshFile::Header header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    cr_assert_gt(header.nodeCount, 0u);
+
+    const std::string path = "/tmp/obj_loader_tests_corrupt.rtmesh";
+    auto rejects = [&](auto corrupt) {
+        std::vector<char> bytes = image;
+        corrupt(bytes);
+        Utils::writeFile(path, bytes.data(), bytes.size());
+        try {
+            Utils::MeshFile::load(path);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    auto setNode = [&](std::vector<char>& bytes, uint32_t start, uint32_t count) {
+        RayTracer::Mesh::Node root;
+        std::memcpy(&root, bytes.data() + header.nodeOffset, sizeof(root));
+        root.start = start;
+        root.count = count;
+        std::memcpy(bytes.data() + header.nodeOffset, &root, sizeof(root));
+    };
+
+    cr_assert_not(rejects([](std::vector<char>&) {}), "The intact file should load");
+    cr_assert(rejects([&](std::vector<char>& bytes) {
+        const uint32_t index = 0x7fffffff;
+        std::memcpy(bytes.data() + header.indexOffset, &index, sizeof(index));
+    }), "An index past the vertices should be rejected");
+    cr_assert(rejects([&](std::vector<char>& bytes) { setNode(bytes, 1, 5); }),
+              "A leaf past the triangles should be rejected");
+    cr_assert(rejects([&](std::vector<char>& bytes) { setNode(bytes, 0, 0); }),
+              "A child before its parent should be rejected");
+    std::remove(path.c_str());
+}
+
+Test(obj_loader, mesh_cache_loads_on_demand_and_evicts_coldest)
+{
+    auto makeQuad = [](float z) {
+        return std::make_shared<RayTracer::Mesh>(
+            std::vector<float>{-1, -1, z, 1, -1, z, 1, 1, z, -1, 1, z},
+            std::vector<uint32_t>{0, 1, 2, 0, 2, 3});
+    };
+    const std::size_t quadBytes = makeQuad(0)->geometryBytes();
+
+    auto cache = std::make_shared<RayTracer::MeshCache>(2 * quadBytes);
+    int loaded[3] = {0, 0, 0};
+    std::size_t slots[3];
+    for (int i = 0; i < 3; ++i)
+        slots[i] = cache->add([&, i]() { ++loaded[i]; return makeQuad(-i); });
+
+    const double min[3] = {-1, -1, 0}, max[3] = {1, 1, 0};
+    RayTracer::MeshProxy proxy(cache, slots[0], min, max, Color(7, 8, 9));
+    HitInfo hit;
+    cr_assert_not(proxy.hits(RayTracer::Ray(Math::Point3D(5, 0, 5), Math::Vector3D(0, 0, -1)), hit));
+    cr_assert_eq(loaded[0], 0, "A ray missing the bounds should not load the mesh");
+    cr_assert(proxy.hits(RayTracer::Ray(Math::Point3D(0, 0, 5), Math::Vector3D(0, 0, -1)), hit));
+    cr_assert_eq(loaded[0], 1);
+    cr_assert_eq(hit.color->getR(), 7);
+
+    cache->acquire(slots[1]);
+    cache->acquire(slots[0]);
+    cache->acquire(slots[2]);       // over budget: slot 1 is the coldest
+    cr_assert_eq(cache->residentCount(), 2u);
+    cr_assert_eq(cache->evictions(), 1u);
+    cache->acquire(slots[0]);
+    cr_assert_eq(loaded[0], 1, "A warm mesh should stay resident");
+    cache->acquire(slots[1]);
+    cr_assert_eq(loaded[1], 2, "An evicted mesh should be reloaded on demand");
+    cr_assert_leq(cache->residentBytes(), 2 * quadBytes);
+
+    // A mesh dropped while a pass may still trace it is freed after the pass
+    std::weak_ptr<RayTracer::Mesh> watched;
+    std::size_t extra = cache->add([&]() { auto mesh = makeQuad(-3); watched = mesh; return mesh; });
+    {
+        RayTracer::MeshCache::Pass pass = cache->beginPass();
+        const RayTracer::Mesh* held = cache->acquire(extra);
+        cache->setBudget(1);
+        cr_assert_eq(cache->residentCount(), 0u);
+        cr_assert_not(watched.expired(), "The pass may still hold the dropped mesh");
+        cr_assert(held->hits(RayTracer::Ray(Math::Point3D(0, 0, 5), Math::Vector3D(0, 0, -1)), hit));
+    }
+    cr_assert(watched.expired(), "The dropped mesh should be freed with the last pass that saw it");
+}
+
+Test(obj_loader, welds_normals_and_uvs_per_vertex)
+{
+    // Two triangles share the 1-3 edge; vertex 1 has one normal per face
+    const std::string obj =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vn 0 0 1\nvn 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\n"
+        "f 1/1/1 2/2/1 3/3/1\n"
+        "f 1/1/2 3/3/1 4/3/1\n";
+    Utils::ObjMeshData data;
+    Utils::ObjLoader::parse(obj.data(), obj.data() + obj.size(), data, 1.0, Math::Point3D(0, 0, 0));
+
+    cr_assert_eq(data.positions.size(), 15u, "Vertex 1 should be split for its second normal");
+    cr_assert_eq(data.normals.size(), 15u);
+    cr_assert_eq(data.uvs.size(), 10u);
+    cr_assert_eq(data.triangles[0], 0u);
+    cr_assert_eq(data.triangles[3], 4u);
+    cr_assert_eq(data.triangles[4], 2u, "Matching pairs should keep sharing the vertex");
+    cr_assert_float_eq(data.normals[3 * 4 + 1], 1.0, 1e-9);
+    cr_assert_float_eq(data.uvs[2 * 2], 1.0, 1e-9);
+}
+
+Test(obj_loader, mesh_interpolates_smooth_normals)
+{
+    // A roof: two faces meeting at a ridge along x = 0
+    std::vector<float> vertices = {-1, 0, -1,  0, 1, -1,  0, 1, 1,  -1, 0, 1,  1, 0, -1,  1, 0, 1};
+    std::vector<uint32_t> indices = {0, 2, 1, 0, 3, 2, 1, 2, 5, 1, 5, 4};
+    RayTracer::Mesh mesh(vertices, indices);
+
+    HitInfo flat, smooth;
+    RayTracer::Ray ray(Math::Point3D(-0.1, 5, 0.2), Math::Vector3D(0, -1, 0));
+    cr_assert(mesh.hits(ray, flat));
+    mesh.applyShading(RayTracer::Mesh::Shading::Smooth);
+    cr_assert(mesh.hits(ray, smooth));
+
+    cr_assert_float_eq(flat.t, smooth.t, 1e-12, "Shading should not move the hit");
+    cr_assert_float_eq(flat.n._x, -std::sqrt(0.5), 1e-9, "Flat shading uses the face normal");
+    cr_assert_gt(smooth.n._y, flat.n._y, "Near the ridge the normal should bend towards it");
+    cr_assert_float_eq(smooth.n.length2(), 1.0, 1e-9);
+    cr_assert_float_eq(smooth.u, 0.6, 1e-9, "Barycentrics should be reported");
+    cr_assert_float_eq(smooth.v, 0.3, 1e-9);
+}
@@ -1,5 +1,7 @@
 #include <criterion/criterion.h>
 #include <criterion/redirect.h>
+#include <cstdio>
+#include <fstream>
 #include "Parser/Parser.hpp"
 
 Test(parser, valid_scene_file)
@@ -82,3 +84,48 @@ Test(parser, missing_fields)
     cr_assert_eq(spheres[0].color.b, 255, "Default color B");
 }
 
+
+Test(parser, mistyped_and_unknown_settings_keep_defaults)
+{
+    const char* path = "/tmp/parser_tests_schema.cfg";
+    std::ofstream(path) << R"(
+        cameras = ( { name = "a"; position = { x = 1; y = "bad"; z = 3.5; }; junk = 1; }, { resolution = 5; }, 3 );
+        primitives = {
+            spheres = ( { x = 1; r = 2.5; color = { r = 10.9; g = true; }; } );
+            cones = ( { apex = { y = 2; }; } );
+            obj_files = ( { path = 3; scale = 2; } );
+        };
+        lights = { point = ( { x = 1; }, 4 ); };
+    )";
+    Parser::Parser parser;
+    cr_assert(parser.loadFromFile(path), "Mistyped settings should not fail the file");
+
+    const auto& cameras = parser.getCameras();
+    cr_assert_eq(cameras.size(), 3);
+    cr_assert_float_eq(cameras[0].position.x, 1.0, 1e-9);
+    cr_assert_float_eq(cameras[0].position.y, 0.0, 1e-9, "A string where a number belongs keeps the default");
+    cr_assert_float_eq(cameras[0].position.z, 3.5, 1e-9);
+    cr_assert_eq(cameras[1].resolution.width, 800, "A scalar where a group belongs keeps the defaults");
+    cr_assert_eq(cameras[2].name, "camera_2", "Unnamed cameras are named after their index");
+
+    const auto& sphere = parser.getSpheres().at(0);
+    cr_assert_float_eq(sphere.position.x, 1.0, 1e-9, "Flat x, y, z settings fill the position");
+    cr_assert_float_eq(sphere.radius, 2.5, 1e-9);
+    cr_assert_eq(sphere.color.r, 10, "Floats are truncated into integer fields");
+    cr_assert_eq(sphere.color.g, 255);
+
+    const auto& cone = parser.getCones().at(0);
+    cr_assert_float_eq(cone.apex.y, 2.0, 1e-9);
+    cr_assert_float_eq(cone.axis.y, 1.0, 1e-9, "Nested groups start from their owner's defaults");
+
+    const auto& obj = parser.getObjFiles().at(0);
+    cr_assert_eq(obj.path, "");
+    cr_assert_float_eq(obj.scale, 2.0, 1e-9);
+    cr_assert_eq(obj.shading, "auto");
+
+    const auto& lights = parser.getLights();
+    cr_assert_float_eq(lights.ambient, 0.0, 1e-9);
+    cr_assert_eq(lights.point.size(), 2);
+    cr_assert_float_eq(lights.point[0].x, 1.0, 1e-9);
+    std::remove(path);
+}
@@ -10,7 +10,18 @@
 #include "RayTracer/AmbientLight.hpp"
 #include "RayTracer/DirectionalLight.hpp"
 #include "Core/PrimitiveFactory.hpp"
+#include "Renderer/RendererExceptions.hpp"
+#include "Renderer/StratifiedSampler.hpp"
+#include "Renderer/HaltonSampler.hpp"
+#include "Renderer/SobolSampler.hpp"
+#include "Renderer/BlueNoiseSampler.hpp"
+#include "Renderer/PPMStreamSink.hpp"
+#include "Renderer/PNGStreamSink.hpp"
+#include "Utils/Deflate.hpp"
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <thread>
 
 static Scene createTestScene()
 {
@@ -24,10 +35,10 @@ static Scene createTestScene()
     scene.cameraMap["main_camera"] = camera;
     auto sphere = std::make_shared<RayTracer::Sphere>(
         Math::Point3D(0, 0, -5), 2.0, Color(255, 0, 0));
-    scene.primitives.push_back(sphere);
+    scene.addPrimitive(sphere);
     auto plane = std::make_shared<RayTracer::Plane>(
         Math::Point3D(0, -3, 0), Math::Vector3D(0, 1, 0), Color(0, 255, 0));
-    scene.primitives.push_back(plane);
+    scene.addPrimitive(plane);
     auto ambient = std::make_shared<RayTracer::AmbientLight>(0.3, Color(255, 255, 255));
     scene.lights.push_back(ambient);
     auto directional = std::make_shared<RayTracer::DirectionalLight>(
@@ -75,3 +86,276 @@ Test(renderer, progress_output, .init = redirect_all_stdout) {
     fflush(stdout);
     cr_assert(true, "ouaiiiiiii");
 }
+
+Test(renderer, async_render_reports_every_tile)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    Renderer renderer(camera->_width, camera->_height);
+    std::atomic<int> tiles(0);
+    auto job = renderer.renderAsync(scene, camera, [&tiles](const TileProgress&) {
+        ++tiles;
+    });
+    Image image = job->get();
+    cr_assert_eq(image.width(), camera->_width, "Async frame width should match camera width");
+    cr_assert_eq(tiles.load(), job->totalTiles(), "Every tile should be reported once");
+    cr_assert_eq(job->completedTiles(), job->totalTiles(), "Job should be complete");
+}
+
+Test(renderer, async_render_cancel)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    Renderer renderer(camera->_width, camera->_height, 16);
+    auto job = renderer.renderAsync(scene, camera);
+    job->cancel();
+    bool cancelled = false;
+    try {
+        job->get();
+    } catch (const RenderCancelledException&) {
+        cancelled = true;
+    }
+    cr_assert(cancelled || job->completedTiles() == job->totalTiles(),
+        "A cancelled job should report cancellation unless it already finished");
+    cr_assert(job->isDone(), "Job should be done after get()");
+}
+
+Test(renderer, progressive_render_matches_single_pass)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    camera->_width = 120;
+    camera->_height = 90;
+    Renderer renderer(camera->_width, camera->_height, 4);
+    std::vector<int> passSamples;
+    auto job = renderer.renderProgressive(scene, camera,
+        [&passSamples](const RenderPass& pass, const Image&) {
+            passSamples.push_back(pass.scale > 1 ? 0 : pass.endSample);
+        });
+    Image progressive = job->get();
+    Image reference = renderer.renderAsync(scene, camera)->get();
+
+    cr_assert_eq(passSamples.size(), job->passes().size(), "Every pass should be published");
+    cr_assert_eq(passSamples.front(), 0, "First pass should be the low resolution preview");
+    cr_assert_eq(passSamples.back(), 4, "Last pass should reach the target spp");
+    for (int y = 0; y < reference.height(); ++y) {
+        for (int x = 0; x < reference.width(); ++x) {
+            Color a = progressive.getPixel(x, y);
+            Color b = reference.getPixel(x, y);
+            cr_assert(a.getR() == b.getR() && a.getG() == b.getG() && a.getB() == b.getB(),
+                "Accumulated passes should match a single full pass");
+        }
+    }
+}
+
+Test(renderer, adaptive_sampling_stops_on_flat_background)
+{
+    Core::PrimitiveFactory factory;
+    Scene scene(factory);
+    auto camera = std::make_shared<RayTracer::Camera>();
+    camera->_width = 64;
+    camera->_height = 48;
+    scene.cameras.push_back(camera);
+
+    Renderer renderer(camera->_width, camera->_height, 16);
+    renderer.setAdaptiveSampling(4);
+    auto job = renderer.renderAsync(scene, camera);
+    Image image = job->get();
+    cr_assert_float_eq(job->averageSamplesPerPixel(), 4.0, 1e-9,
+        "An empty scene should converge after the minimum sample count");
+    Color pixel = image.getPixel(10, 10);
+    cr_assert(pixel.getR() == 40 && pixel.getG() == 40 && pixel.getB() == 80,
+        "Background should be unaffected by adaptive sampling");
+}
+
+Test(renderer, adaptive_sampling_keeps_sampling_edges)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    camera->_width = 120;
+    camera->_height = 90;
+    Renderer renderer(camera->_width, camera->_height, 16);
+    renderer.setAdaptiveSampling(4);
+    auto job = renderer.renderAsync(scene, camera);
+    job->get();
+    double spp = job->averageSamplesPerPixel();
+    cr_assert_gt(spp, 4.0, "Edges should receive more than the minimum samples");
+    cr_assert_lt(spp, 16.0, "Flat areas should stop before the maximum");
+}
+
+static void checkSamplerSpread(ISampler& sampler, int count)
+{
+    sampler.prepare(count);
+    std::vector<bool> columns(count, false);
+    for (int s = 0; s < count; ++s) {
+        SamplePoint p = sampler.sample(7, 3, s);
+        cr_assert(p.u >= 0.0 && p.u < 1.0 && p.v >= 0.0 && p.v < 1.0,
+            "Samples should stay inside the pixel");
+        columns[static_cast<int>(p.u * count)] = true;
+    }
+    for (int c = 0; c < count; ++c)
+        cr_assert(columns[c], "Every column stratum should receive one sample");
+}
+
+Test(renderer, samplers_cover_non_square_counts)
+{
+    StratifiedSampler stratified;
+    checkSamplerSpread(stratified, 6);
+    checkSamplerSpread(stratified, 16);
+    SobolSampler sobol;
+    checkSamplerSpread(sobol, 8);
+    checkSamplerSpread(sobol, 16);
+
+    HaltonSampler halton;
+    BlueNoiseSampler blueNoise;
+    for (ISampler* sampler : {static_cast<ISampler*>(&halton), static_cast<ISampler*>(&blueNoise)}) {
+        sampler->prepare(5);
+        for (int s = 0; s < 5; ++s) {
+            SamplePoint p = sampler->sample(12, 40, s);
+            cr_assert(p.u >= 0.0 && p.u < 1.0 && p.v >= 0.0 && p.v < 1.0,
+                "Samples should stay inside the pixel");
+        }
+    }
+}
+
+Test(renderer, hdr_frame_keeps_values_above_one)
+{
+    Image image(2, 1);
+    image.setPixel(0, 0, Color::Float(3.f, 0.5f, 0.f));
+    image.at(1, 0) = AccumPixel{Color::Float(4.f, 2.f, 0.f), 2.f};
+
+    cr_assert_float_eq(image.getPixelHDR(0, 0).r, 3.f, 1e-6);
+    cr_assert_float_eq(image.getPixelHDR(1, 0).r, 2.f, 1e-6);
+    cr_assert_eq(image.getPixel(0, 0).getR(), 255, "Clamp should clip on output");
+    cr_assert_eq(image.getPixel(0, 0).getG(), 128);
+
+    image.setToneMap(ToneMap::Reinhard);
+    cr_assert_eq(image.getPixel(0, 0).getR(), 191, "Reinhard maps 3 to 0.75");
+    std::vector<uint8_t> rgb = image.toRGB8();
+    cr_assert_eq(rgb.size(), 6u);
+    cr_assert_eq(rgb[3], 170, "Reinhard maps the resolved 2 to 2/3");
+}
+
+Test(renderer, image_writers_produce_valid_headers)
+{
+    Image image(3, 2);
+    for (int y = 0; y < 2; ++y)
+        for (int x = 0; x < 3; ++x)
+            image.setPixel(x, y, Color::Float(x * 0.5f, y * 2.f, 0.25f));
+
+    size_t ppm = image.save("/tmp/rt_writer_test.ppm");
+    cr_assert_eq(ppm, std::string("P6\n3 2\n255\n").size() + 3 * 2 * 3);
+    std::ifstream in("/tmp/rt_writer_test.ppm", std::ios::binary);
+    std::string magic;
+    in >> magic;
+    cr_assert_eq(magic, "P6");
+
+    image.save("/tmp/rt_writer_test.png");
+    std::ifstream png("/tmp/rt_writer_test.png", std::ios::binary);
+    char sig[8];
+    png.read(sig, 8);
+    cr_assert_eq(std::string(sig + 1, 3), "PNG");
+
+    size_t exr = image.save("/tmp/rt_writer_test.EXR");
+    cr_assert_gt(exr, 3u * 2 * 3 * sizeof(float));
+    cr_assert(!Image::isSupportedFormat("out.bmp"));
+}
+
+Test(renderer, streaming_render_matches_full_frame)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    camera->_width = 70;
+    camera->_height = 75;       // last band is shorter than a tile
+    Renderer renderer(camera->_width, camera->_height, 2);
+
+    PPMStreamSink sink("/tmp/rt_stream_test.ppm");
+    int tiles = 0;
+    std::vector<TileProgress> reported;
+    renderer.renderStreaming(scene, camera, sink, [&](const TileProgress& tile) {
+        tiles = tile.completed;
+        cr_assert_leq(tile.completed, tile.total);
+        reported.push_back(tile);
+    });
+    Image image = renderer.renderAsync(scene, camera)->get();
+    image.save("/tmp/rt_full_test.ppm");
+    for (const TileProgress& tile : reported)
+        cr_assert(tile.rgba == image.toRGBA(tile.x, tile.y, tile.width, tile.height),
+                  "Tile (%d, %d) should carry its finished pixels", tile.x, tile.y);
+
+    std::ifstream streamed("/tmp/rt_stream_test.ppm", std::ios::binary);
+    std::ifstream full("/tmp/rt_full_test.ppm", std::ios::binary);
+    std::string a((std::istreambuf_iterator<char>(streamed)), std::istreambuf_iterator<char>());
+    std::string b((std::istreambuf_iterator<char>(full)), std::istreambuf_iterator<char>());
+    cr_assert_eq(tiles, 3 * 3, "Every tile of every band should be reported");
+    cr_assert_eq(a.size(), sink.size());
+    cr_assert(a == b, "Bands should reassemble into the full frame");
+}
+
+Test(renderer, resumable_render_skips_checkpointed_tiles)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    camera->_width = 120;
+    camera->_height = 90;
+    Renderer renderer(camera->_width, camera->_height, 2);
+    const std::string path = "/tmp/rt_resume_test.ckpt";
+    std::remove(path.c_str());
+
+    // Interrupt a first run after a few tiles
+    std::atomic<RenderJob*> handle{nullptr};
+    auto first = renderer.renderResumable(scene, camera, path,
+        [&handle](const TileProgress& tile) {
+            if (tile.completed != 5)
+                return;
+            while (!handle)
+                std::this_thread::yield();
+            handle.load()->cancel();
+        });
+    handle = first.get();
+    bool cancelled = false;
+    try {
+        first->get();
+    } catch (const RenderCancelledException&) {
+        cancelled = true;
+    }
+    first->wait();
+    cr_assert(cancelled, "First run should have been interrupted");
+
+    auto second = renderer.renderResumable(scene, camera, path);
+    Image resumed = second->get();
+    Image reference = renderer.renderAsync(scene, camera)->get();
+    std::remove(path.c_str());
+
+    cr_assert_lt(second->averageSamplesPerPixel(), 2.0, "Checkpointed tiles should not be traced again");
+    for (int y = 0; y < reference.height(); ++y) {
+        for (int x = 0; x < reference.width(); ++x) {
+            Color a = resumed.getPixel(x, y);
+            Color b = reference.getPixel(x, y);
+            cr_assert(a.getR() == b.getR() && a.getG() == b.getG() && a.getB() == b.getB(),
+                "A resumed render should match an uninterrupted one");
+        }
+    }
+}
+
+Test(renderer, streamed_png_matches_in_memory_png)
+{
+    Scene scene = createTestScene();
+    auto camera = scene.getCameraByName("main_camera");
+    camera->_width = 50;
+    camera->_height = 70;
+    Renderer renderer(camera->_width, camera->_height, 1);
+
+    PNGStreamSink sink("/tmp/rt_stream_test.png");
+    renderer.renderStreaming(scene, camera, sink);
+    size_t whole = renderer.renderAsync(scene, camera)->get().save("/tmp/rt_whole_test.png");
+
+    // Same strips, split into one IDAT per band instead of a single one
+    cr_assert_gt(sink.size(), whole);
+    cr_assert_lt(sink.size(), whole + 12 * 3);
+
+    const uint8_t a[] = "strip one", b[] = "and strip two";
+    uint32_t joined = Utils::adler32Combine(Utils::adler32(a, 9), Utils::adler32(b, 13), 13);
+    std::string both = "strip oneand strip two";
+    cr_assert_eq(joined, Utils::adler32(reinterpret_cast<const uint8_t*>(both.data()), both.size()));
+}
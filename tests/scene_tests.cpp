@@ -0,0 +1,429 @@
+#include <criterion/criterion.h>
+#include <cstdint>
+#include <cstdio>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <new>
+#include <variant>
+#include <string>
+#include "Core/Scene.hpp"
+#include "Core/PrimitiveFactory.hpp"
+#include "Core/PluginABI.hpp"
+#include "RayTracer/Camera.hpp"
+#include "RayTracer/Plane.hpp"
+#include "RayTracer/PrimitiveBVH.hpp"
+#include "RayTracer/Sphere.hpp"
+#include "Utils/Arena.hpp"
+#include "Utils/FileIO.hpp"
+
+static void writeSceneFiles(const std::string& cfg, const std::string& obj)
+{
+    const std::string model = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n";
+    Utils::writeFile(obj, model.data(), model.size());
+    const std::string scene =
+        "cameras = ({ name = \"main_camera\"; resolution = { width = 64; height = 48; };\n"
+        "  position = { x = 0; y = 0; z = 5; }; rotation = { x = 0; y = 0; z = 0; };\n"
+        "  fieldOfView = 60.0; });\n"
+        "primitives = { obj_files = ({ path = \"" + obj + "\";\n"
+        "  position = { x = -0.5; y = -0.5; z = 0; }; scale = 1.0;\n"
+        "  color = { r = 10; g = 20; b = 30; }; }); };\n"
+        "lights = { ambient = 0.3; diffuse = 0.6; point = ({ x = 1; y = 2; z = 3; });\n"
+        "  directional = ({ x = -1; y = -1; z = -1; }); };\n";
+    Utils::writeFile(cfg, scene.data(), scene.size());
+}
+
+Test(scene, snapshot_round_trip_and_invalidation)
+{
+    const std::string cfg = "/tmp/scene_tests.cfg";
+    const std::string obj = "/tmp/scene_tests.obj";
+    const std::string snapshot = "/tmp/scene_tests.rtscene";
+    writeSceneFiles(cfg, obj);
+
+    Core::PrimitiveFactory factory;
+    Scene source(factory);
+    source.loadFromFile(cfg);
+    source.saveSnapshot(snapshot);
+
+    Scene restored(factory);
+    cr_assert(restored.loadSnapshot(snapshot), "An up to date snapshot should be used");
+    cr_assert_eq(restored.getPrimitives().size(), source.getPrimitives().size());
+    cr_assert_eq(restored.lights.size(), source.lights.size());
+    auto camera = restored.getCameraByName("main_camera");
+    cr_assert(camera != nullptr);
+    cr_assert_float_eq(camera->_screen._origin._z, source.getCameraByName("main_camera")->_screen._origin._z, 1e-12);
+
+    HitInfo expected, hit;
+    RayTracer::Ray ray(Math::Point3D(0.2, 0.1, 5), Math::Vector3D(0, 0, -1));
+    cr_assert(source.getPrimitives()[0]->hits(ray, expected));
+    cr_assert(restored.getPrimitives()[0]->hits(ray, hit), "Snapshot meshes should be hit like the originals");
+    cr_assert_float_eq(hit.t, expected.t, 1e-12);
+    cr_assert_eq(hit.color->getB(), 30);
+
+    // Changing a mesh makes the snapshot stale: the source scene is loaded instead
+    const std::string moved = "# moved\nv 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\nf 1 2 3 4\n";
+    Utils::writeFile(obj, moved.data(), moved.size());
+    Scene stale(factory);
+    cr_assert_not(stale.loadSnapshot(snapshot));
+    cr_assert_eq(stale.getPrimitives().size(), 1u);
+    cr_assert(stale.getPrimitives()[0]->hits(ray, hit));
+    cr_assert_float_eq(hit.t, 4.0, 1e-9, "The fallback should see the new mesh");
+
+    std::remove(cfg.c_str());
+    std::remove(obj.c_str());
+    std::remove(snapshot.c_str());
+}
+
+Test(scene, content_signature_covers_mesh_files)
+{
+    const std::string cfg = "/tmp/scene_tests_signature.cfg";
+    const std::string obj = "/tmp/scene_tests_signature.obj";
+    writeSceneFiles(cfg, obj);
+
+    Core::PrimitiveFactory factory;
+    Scene before(factory);
+    cr_assert_eq(before.contentSignature(), 0u);
+    before.loadFromFile(cfg);
+
+    const std::string moved = "# moved\nv 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\nf 1 2 3 4\n";
+    Utils::writeFile(obj, moved.data(), moved.size());
+    Scene after(factory);
+    after.loadFromFile(cfg);
+    cr_assert_eq(after.sourceHash(), before.sourceHash(), "The scene file itself did not change");
+    cr_assert_neq(after.contentSignature(), before.contentSignature(), "An edited mesh should change the signature");
+
+    std::remove(cfg.c_str());
+    std::remove(obj.c_str());
+}
+
+Test(scene, added_primitives_are_hit_before_the_bvh_is_rebuilt)
+{
+    const std::string cfg = "/tmp/scene_tests_add.cfg";
+    const std::string obj = "/tmp/scene_tests_add.obj";
+    writeSceneFiles(cfg, obj);
+
+    Core::PrimitiveFactory factory;
+    Scene scene(factory);
+    scene.loadFromFile(cfg);
+
+    // Nearer than the mesh, which the BVH built on load does not know of
+    scene.addPrimitive(std::make_shared<RayTracer::Sphere>(Math::Point3D(0.2, 0.1, 2), 0.5, Color(1, 2, 3)));
+    HitInfo hit;
+    RayTracer::Ray ray(Math::Point3D(0.2, 0.1, 5), Math::Vector3D(0, 0, -1));
+    cr_assert(scene.intersect(ray, hit));
+    cr_assert_float_eq(hit.t, 2.5, 1e-9, "The added sphere should be hit first");
+    cr_assert(scene.occluded(ray, 2.6));
+
+    const std::size_t bounded = scene.accel().boundedCount();
+    cr_assert_eq(bounded, 1u, "The mesh proxy should be bounded");
+    scene.buildAccel();
+    cr_assert(scene.intersect(ray, hit));
+    cr_assert_float_eq(hit.t, 2.5, 1e-9, "The rebuilt BVH should index the added sphere");
+    cr_assert_eq(scene.accel().size(), 2u);
+    cr_assert_eq(scene.accel().boundedCount(), bounded, "Loaded primitives should stay bounded");
+
+    std::remove(cfg.c_str());
+    std::remove(obj.c_str());
+}
+
+Test(scene, reload_rebuilds_only_what_changed)
+{
+    const std::string cfg = "/tmp/scene_reload_tests.cfg";
+    const std::string obj = "/tmp/scene_reload_tests.obj";
+    writeSceneFiles(cfg, obj);
+    auto withSphere = [&](int red, const std::string& fov) {
+        std::string scene =
+            "cameras = ({ name = \"main_camera\"; resolution = { width = 64; height = 48; };\n"
+            "  position = { x = 0; y = 0; z = 5; }; fieldOfView = " + fov + "; });\n"
+            "primitives = {\n"
+            "  spheres = ({ x = 0; y = 0; z = -5; r = 1; color = { r = " + std::to_string(red) + "; g = 0; b = 0; }; },\n"
+            "             { x = 3; y = 0; z = -5; r = 1; color = { r = 0; g = 9; b = 0; }; });\n"
+            "  obj_files = ({ path = \"" + obj + "\"; position = { x = -0.5; y = -0.5; z = 0; }; }); };\n"
+            "lights = { ambient = 0.3; };\n";
+        Utils::writeFile(cfg, scene.data(), scene.size());
+    };
+
+    Core::PrimitiveFactory factory;
+    factory.registerType("sphere", [](const PrimitiveConfig& c) {
+        const auto& d = std::get<SphereData_t>(c.data);
+        return std::make_shared<RayTracer::Sphere>(d.c, d.r, c.color);
+    });
+    withSphere(255, "60.0");
+    Scene scene(factory);
+    scene.loadFromFile(cfg);
+    auto camera = scene.getCameraByName("main_camera");
+    auto keptSphere = scene.getPrimitives()[1];
+    auto mesh = scene.getPrimitives()[2];
+    HitInfo hit;
+    RayTracer::Ray ray(Math::Point3D(0.2, 0.1, 5), Math::Vector3D(0, 0, -1));
+    cr_assert(mesh->hits(ray, hit));
+    cr_assert_eq(scene.meshCache().loads(), 1u);
+
+    withSphere(128, "45.0");
+    Scene::ReloadStats stats = scene.reload();
+    cr_assert_eq(stats.changed, 1u, "The camera should be updated in place");
+    cr_assert_eq(stats.added, 1u, "Only the recoloured sphere should be rebuilt");
+    cr_assert_eq(stats.removed, 1u);
+    cr_assert_eq(stats.meshesReused, 1u);
+    cr_assert_eq(stats.kept, 3u, "A sphere, the mesh and the light");
+    cr_assert(scene.getCameraByName("main_camera") == camera);
+    cr_assert(scene.getPrimitives()[1] == keptSphere);
+    cr_assert(scene.getPrimitives()[2] == mesh);
+    cr_assert(scene.getPrimitives()[2]->hits(ray, hit));
+    cr_assert_eq(scene.meshCache().loads(), 1u, "An unchanged mesh should not be loaded again");
+
+    // A scene that fails to build leaves the live one untouched
+    const std::string broken = "primitives = { cones = ({ apex = { x = 0; y = 0; z = 0; }; }); };\n";
+    Utils::writeFile(cfg, broken.data(), broken.size());
+    bool threw = false;
+    try {
+        scene.reload();
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    cr_assert(threw, "No cone plugin is registered");
+    cr_assert_eq(scene.getPrimitives().size(), 3u);
+    cr_assert_eq(scene.cameras.size(), 1u);
+
+    std::remove(cfg.c_str());
+    std::remove(obj.c_str());
+}
+
+Test(scene, arena_aligns_and_releases_at_once)
+{
+    struct Counted {
+        explicit Counted(int& live) : _live(live) { ++_live; }
+        ~Counted() { --_live; }
+        int& _live;
+    };
+    struct alignas(64) Wide { char bytes[100]; };
+
+    int live = 0;
+    auto arena = std::make_shared<Utils::Arena>(256);
+    std::shared_ptr<Counted> handle;
+    for (int i = 0; i < 1000; ++i) {
+        Counted* counted = arena->create<Counted>(live);
+        if (i == 0)
+            handle = Utils::Arena::handle(arena, counted);
+        Wide* wide = arena->create<Wide>();
+        cr_assert_eq(reinterpret_cast<std::uintptr_t>(wide) % 64, 0u, "Alignment should be honoured");
+    }
+    arena->adopt(new Counted(live));
+    void* big = arena->allocate(1 << 20, 16);
+    cr_assert_not_null(big, "Oversized requests should get a block of their own");
+
+    cr_assert_eq(live, 1001);
+    cr_assert_eq(arena->objectCount(), 1001u, "Trivially destructible objects need no cleanup");
+    cr_assert_geq(arena->bytesReserved(), arena->bytesUsed());
+    arena.reset();
+    cr_assert_eq(live, 1001, "A handle should keep the whole arena alive");
+    handle.reset();
+    cr_assert_eq(live, 0, "Dropping the last handle should release everything");
+}
+
+Test(scene, plugin_batch_constructs_in_place_and_rolls_back)
+{
+    using RayTracer::Sphere;
+    auto make = [](void* at, const PrimitiveConfig& conf) {
+        const SphereData_t& sphere = std::get<SphereData_t>(conf.data);
+        return new (at) Sphere(sphere.c, sphere.r, conf.color);
+    };
+    PrimitiveConfig a{"sphere", Color(1, 2, 3), SphereData_t(Math::Point3D(0, 0, -5), 1)};
+    PrimitiveConfig b{"sphere", Color(4, 5, 6), SphereData_t(Math::Point3D(0, 0, -9), 2)};
+    const PrimitiveConfig* configs[] = {&a, &b};
+
+    constexpr auto layout = Core::PluginABI::layoutOf<Sphere>();
+    alignas(Sphere) unsigned char storage[2 * layout.size];
+    RayTracer::IPrimitive* out[2] = {nullptr, nullptr};
+    cr_assert_eq(Core::PluginABI::constructBatch<Sphere>(configs, 2, storage, out, make), 2u);
+    cr_assert_eq(static_cast<void*>(out[1]), static_cast<void*>(static_cast<Sphere*>(out[0]) + 1),
+                 "Primitives should be contiguous in the caller's storage");
+    HitInfo hit;
+    cr_assert(out[1]->hits(RayTracer::Ray(Math::Point3D(0, 0, 0), Math::Vector3D(0, 0, -1)), hit));
+    cr_assert_float_eq(hit.t, 7.0, 1e-9, "Each primitive should keep its own configuration");
+    cr_assert_eq(hit.color->getR(), 4);
+    for (auto* primitive : out)
+        primitive->~IPrimitive();
+
+    PrimitiveConfig wrong{"sphere", Color(0, 0, 0), TriangleData_t{}};
+    configs[1] = &wrong;
+    bool threw = false;
+    try {
+        Core::PluginABI::constructBatch<Sphere>(configs, 2, storage, out, make);
+    } catch (const std::bad_variant_access&) {
+        threw = true;
+    }
+    cr_assert(threw, "A rejected configuration should fail the batch");
+}
+
+Test(scene, primitive_bvh_matches_a_linear_scan)
+{
+    // A grid of spheres, half with a batch kernel, and an unbounded floor
+    std::vector<std::unique_ptr<RayTracer::IPrimitive>> owned;
+    std::vector<RayTracer::PrimitiveBVH::Entry> entries;
+    for (int i = 0; i < 200; ++i) {
+        Math::Point3D center(i % 20 - 10.0, i / 20 - 5.0, -10.0 - (i % 7));
+        owned.push_back(std::make_unique<RayTracer::Sphere>(center, 0.3 + 0.05 * (i % 5), Color(i, 0, 0)));
+        RayTracer::PrimitiveBVH::Entry entry;
+        entry.primitive = owned.back().get();
+        entry.kernel = i % 2 ? &Core::PluginABI::intersectEach<RayTracer::Sphere> : nullptr;
+        entry.bounded = true;
+        const double c[3] = {center._x, center._y, center._z};
+        for (int axis = 0; axis < 3; ++axis) {
+            entry.min[axis] = c[axis] - (0.3 + 0.05 * (i % 5));
+            entry.max[axis] = c[axis] + (0.3 + 0.05 * (i % 5));
+        }
+        entries.push_back(entry);
+    }
+    owned.push_back(std::make_unique<RayTracer::Plane>(Math::Point3D(0, -6, 0), Math::Vector3D(0, 1, 0)));
+    entries.push_back({owned.back().get(), nullptr, false});
+    RayTracer::PrimitiveBVH bvh(entries);
+    cr_assert_eq(bvh.size(), 201u);
+    cr_assert_eq(bvh.boundedCount(), 200u);
+
+    std::vector<RayTracer::Ray> rays;
+    for (int i = 0; i < 40; ++i)
+        rays.emplace_back(Math::Point3D(0, 0, 5), Math::Vector3D((i % 8 - 4) * 0.09, (i / 8 - 2.5) * 0.1, -1));
+    HitInfo hits[40];
+    uint64_t found = bvh.intersect(rays.data(), rays.size(), hits);
+    for (std::size_t r = 0; r < rays.size(); ++r) {
+        HitInfo expected;
+        expected.t = std::numeric_limits<double>::max();
+        for (const auto& primitive : owned) {
+            HitInfo tmp;
+            if (primitive->hits(rays[r], tmp) && tmp.t < expected.t)
+                expected = tmp;
+        }
+        const bool hit = expected.t < std::numeric_limits<double>::max();
+        cr_assert_eq((found >> r & 1) != 0, hit, "Ray %zu should agree on hitting", r);
+        if (hit) {
+            cr_assert_float_eq(hits[r].t, expected.t, 1e-12);
+            cr_assert_eq(hits[r].color, expected.color, "Ray %zu should hit the same primitive", r);
+        }
+        HitInfo single;
+        cr_assert_eq(bvh.intersect(rays[r], single), hit);
+        cr_assert_eq(bvh.occluded(rays[r], 1e9), hit);
+        if (hit)
+            cr_assert_not(bvh.occluded(rays[r], expected.t * 0.5), "Nothing lies before the closest hit");
+    }
+}
+
+Test(scene, plugin_index_skips_broken_files_and_opens_lazily)
+{
+    const std::string dir = "/tmp/scene_tests_plugins";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const char junk[] = "not a shared object";
+    Utils::writeFile(dir + "/Broken_plugin.so", junk, sizeof(junk));
+
+    for (int run = 0; run < 2; ++run) {
+        Core::PrimitiveFactory factory;
+        factory.loadPlugins(dir);
+        factory.registerType("sphere", [](const PrimitiveConfig& conf) {
+            const SphereData_t& sphere = std::get<SphereData_t>(conf.data);
+            return std::make_shared<RayTracer::Sphere>(sphere.c, sphere.r, conf.color);
+        });
+        PrimitiveConfig conf{"sphere", Color(1, 2, 3), SphereData_t(Math::Point3D(0, 0, -5), 1)};
+        cr_assert(factory.create("sphere", conf) != nullptr, "A broken plugin should not block other types");
+        cr_assert_eq(factory.loadedPluginCount(), 0u, "Plugins should only open on first use");
+
+        bool threw = false;
+        try {
+            factory.create("broken", conf);
+        } catch (const Core::UnknownPrimitiveTypeException&) {
+            threw = true;
+        }
+        cr_assert(threw, "A file that is not a plugin should provide no type");
+        cr_assert(factory.reloadPlugins().types.empty(), "Only opened plugins are reopened");
+    }
+
+    std::ifstream manifest(dir + "/" + Core::PrimitiveFactory::ManifestName);
+    std::string header;
+    std::string line;
+    std::getline(manifest, header);
+    std::getline(manifest, line);
+    cr_assert_eq(header, std::string("rtplugins 1"));
+    cr_assert_neq(line.find("\tBroken_plugin.so\t\t"), std::string::npos, "The broken file should be cached without a type");
+    std::filesystem::remove_all(dir);
+}
+
+// Image a function belongs to
+static const void* imageOf(const void* address)
+{
+    Dl_info info{};
+    return dladdr(address, &info) ? info.dli_fbase : nullptr;
+}
+
+Test(scene, plugin_reload_recreates_primitives_with_the_new_image)
+{
+    // Keeping the built plugin open also keeps the core library it needs
+    // loaded for the copies
+    const std::string built = "plugins/Sphere_plugin.so";
+    void* probe = dlopen(built.c_str(), RTLD_LAZY | RTLD_LOCAL);
+    if (!probe)
+        cr_skip_test("Sphere_plugin.so not built or cannot be loaded: %s", dlerror());
+    const std::string dir = "/tmp/scene_tests_reload_plugins";
+    const std::string cfg = dir + "/scene.cfg";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    // A new file renamed over the plugin, as a rebuild does: the loaded image stays intact
+    auto rewrite = [&](int generation) {
+        const std::string next = dir + "/next.tmp";
+        std::filesystem::copy_file(built, next, std::filesystem::copy_options::overwrite_existing);
+        std::ofstream(next, std::ios::binary | std::ios::app) << std::string(generation, '\0');
+        std::filesystem::rename(next, dir + "/Sphere_plugin.so");
+    };
+    rewrite(0);
+    const std::string scene =
+        "cameras = ({ name = \"main_camera\"; resolution = { width = 64; height = 48; };\n"
+        "  position = { x = 0; y = 0; z = 5; }; fieldOfView = 60.0; });\n"
+        "primitives = { spheres = ({ x = 0; y = 0; z = -5; r = 1; color = { r = 255; g = 0; b = 0; }; },\n"
+        "                          { x = 3; y = 0; z = -5; r = 1; color = { r = 0; g = 9; b = 0; }; }); };\n"
+        "lights = { ambient = 0.3; };\n";
+    Utils::writeFile(cfg, scene.data(), scene.size());
+
+    Core::PrimitiveFactory factory;
+    factory.loadPlugins(dir);
+    Scene loaded(factory);
+    loaded.loadFromFile(cfg);
+    const RayTracer::IPrimitive* first = loaded.getPrimitives()[0].get();
+    const void* before = imageOf(reinterpret_cast<const void*>(factory.kernels("sphere")->intersectBatch));
+    cr_assert(before != nullptr);
+
+    // A failed re-creation puts the previous plugin back
+    rewrite(1);
+    bool threw = false;
+    try {
+        factory.reloadPlugins([](const Core::PrimitiveFactory::PluginReload&) {
+            throw std::runtime_error("re-creation failed");
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    cr_assert(threw, "The failure should reach the caller");
+    cr_assert_eq(loaded.getPrimitives()[0].get(), first);
+    cr_assert_eq(imageOf(reinterpret_cast<const void*>(factory.kernels("sphere")->intersectBatch)), before,
+                 "Kernels should come from the image the primitives were made by");
+
+    rewrite(2);
+    Scene::PluginReloadStats stats = loaded.reloadPlugins();
+    cr_assert_eq(stats.plugins.types.size(), 1u);
+    cr_assert_eq(stats.plugins.types[0], std::string("sphere"));
+    cr_assert(stats.plugins.failures.empty());
+    cr_assert_eq(stats.recreated, 2u);
+    cr_assert_neq(loaded.getPrimitives()[0].get(), first, "Primitives should be created again");
+    const void* after = imageOf(reinterpret_cast<const void*>(factory.kernels("sphere")->intersectBatch));
+    cr_assert(after != nullptr);
+    cr_assert_neq(after, before, "The BVH should get the kernels of the new image");
+
+    HitInfo hit;
+    cr_assert(loaded.intersect(RayTracer::Ray(Math::Point3D(3, 0, 5), Math::Vector3D(0, 0, -1)), hit));
+    cr_assert_float_eq(hit.t, 9.0, 1e-9);
+    cr_assert_eq(hit.color->getG(), 9);
+    cr_assert(loaded.reloadPlugins().plugins.types.empty(), "Nothing changed since");
+    std::filesystem::remove_all(dir);
+    dlclose(probe);
+}
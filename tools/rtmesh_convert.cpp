@@ -0,0 +1,64 @@
+/*
+** rtmesh-convert - Converts OBJ models to the binary .rtmesh format
+*/
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "RayTracer/Mesh.hpp"
+#include "Utils/MeshFile.hpp"
+#include "Utils/ObjLoader.hpp"
+
+int main(int ac, char** av)
+{
+    bool withBVH = true;
+    bool smooth = false;
+    int arg = 1;
+    for (; arg < ac && av[arg][0] == '-'; ++arg) {
+        if (std::strcmp(av[arg], "--no-bvh") == 0)
+            withBVH = false;
+        else if (std::strcmp(av[arg], "--smooth") == 0)
+            smooth = true;
+        else
+            break;
+    }
+    if (ac - arg < 1 || ac - arg > 2) {
+        std::cerr << "Usage: ./rtmesh-convert [--no-bvh] [--smooth] <model.obj> [model.rtmesh]\n"
+                  << "  --smooth  store angle-weighted vertex normals when the OBJ has no vn\n";
+        return 84;
+    }
+
+    std::string input = av[arg];
+    std::string output;
+    if (ac - arg == 2) {
+        output = av[arg + 1];
+    } else {
+        auto dot = input.find_last_of('.');
+        output = input.substr(0, dot == std::string::npos ? input.size() : dot) + Utils::MeshFile::Extension;
+    }
+
+    Utils::ObjMeshData data;
+    if (!Utils::ObjLoader::parse(input, data)) {
+        std::cerr << "Error: Could not open OBJ file: " << input << "\n";
+        return 84;
+    }
+
+    try {
+        RayTracer::Mesh mesh(std::move(data.positions), std::move(data.triangles));
+        mesh.setNormals(std::move(data.normals));
+        mesh.setUVs(std::move(data.uvs));
+        if (smooth)
+            mesh.applyShading(RayTracer::Mesh::Shading::Smooth);
+        std::size_t bytes = Utils::MeshFile::write(output, mesh, withBVH);
+        std::cout << output << ": " << mesh.vertexCount() << " vertices, "
+                  << mesh.triangleCount() << " triangles, "
+                  << (withBVH ? mesh.nodeCount() : 0) << " BVH nodes, "
+                  << (mesh.normals() ? "normals, " : "")
+                  << (mesh.uvs() ? "uvs, " : "")
+                  << bytes << " bytes\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 84;
+    }
+    return 0;
+}